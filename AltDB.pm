@@ -0,0 +1,92 @@
+package AltDB;
+
+# Oct. 2026
+
+# Database of judgments of alternative mapping sites, in the
+#   format of checkAltMapping.pl's output (one line per site:
+#   amplicon, one|both, strand, chrom, position[-position],
+#   and 1 if a match, else 0).  Sites are indexed by windows
+#   of positions; judgments are appended under an exclusive
+#   lock, so samples run in parallel may share one file.
+#   Disagreements favor a match (as combAltMapping.pl).
+#
+#   my $db = AltDB->new($file);
+#   my $res = $db->lookup($amp, "one", '+', $chr, $pos);
+#   $db->add($amp, "one", '+', $chr, $min, $max, $res);
+#   $db->save();
+
+use strict;
+use warnings;
+use Fcntl qw(:flock SEEK_END);
+
+my $WIN = 64;  # positions per window of the index
+my $HEAD = "#Amplicon\tPrimersRemoved\tStrand\tChrom\tPosition(s)\tMatch?\n";
+
+# open a database (a missing file is an empty database)
+sub new {
+  my ($class, $file) = @_;
+  my $self = bless { file => $file, idx => {}, new => [] }, $class;
+  return $self if (! -e $file);
+  open(my $in, '<', $file) || die "Cannot open $file\n";
+  flock($in, LOCK_SH);
+  while (my $line = <$in>) {
+    next if (substr($line, 0, 1) eq '#');
+    chomp $line;
+    my @spl = split("\t", $line);
+    my $res = pop @spl;
+    die "Error! $file is improperly formatted\n"
+      if (scalar @spl < 5 || (($res ne "0") && ($res ne "1")));
+    my @div = split('-', $spl[4]);
+    $self->index(@spl[0 .. 3], $div[0], $div[$#div], $res);
+  }
+  close $in;
+  return $self;
+}
+
+# add a range of positions to the index
+sub index {
+  my ($self, $amp, $bo, $st, $chr, $min, $max, $res) = @_;
+  my $key = "$amp\t$bo\t$st\t$chr";
+  for (my $w = int($min / $WIN); $w <= int($max / $WIN); $w++) {
+    push @{$self->{idx}{"$key\t$w"}}, [$min, $max, $res];
+  }
+}
+
+# judgment of a site: 1 if a match, 0 if not, undef if unknown
+sub lookup {
+  my ($self, $amp, $bo, $st, $chr, $pos) = @_;
+  my $list = $self->{idx}{"$amp\t$bo\t$st\t$chr\t" . int($pos / $WIN)};
+  return undef if (! $list);
+  my $res;
+  foreach my $r (@$list) {
+    if ($pos >= $r->[0] && $pos <= $r->[1]) {
+      return 1 if ($r->[2]);
+      $res = 0;
+    }
+  }
+  return $res;
+}
+
+# add a judgment (written to the file by save())
+sub add {
+  my ($self, $amp, $bo, $st, $chr, $min, $max, $res) = @_;
+  $self->index($amp, $bo, $st, $chr, $min, $max, $res);
+  push @{$self->{new}}, join("\t", $amp, $bo, $st, $chr,
+    ($min != $max ? "$min-$max" : $min), $res) . "\n";
+}
+
+# append new judgments to the file
+sub save {
+  my $self = shift;
+  return if (! @{$self->{new}});
+  open(my $out, '>>', $self->{file})
+    || die "Cannot open $self->{file} for writing\n";
+  flock($out, LOCK_EX);
+  seek($out, 0, SEEK_END);
+  print $out $HEAD if (! tell $out);
+  print $out @{$self->{new}};
+  close $out;
+  $self->{new} = [];
+}
+
+1;
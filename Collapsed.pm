@@ -0,0 +1,30 @@
+package Collapsed;
+
+# Oct. 2026
+
+# Names of collapsed reads (qualTrim and removePrimer '-cl'):
+#   "<read>;size=<N>", for N reads with identical sequences
+#   (the format of CLSIZE in collapse.h).
+#
+#   use Collapsed qw(mult isCollapsed);
+#   my $n = mult($name);  # reads represented (1 if not collapsed)
+
+use strict;
+use warnings;
+use Exporter qw(import);
+
+our @EXPORT_OK = qw(mult isCollapsed);
+
+my $SIZE = qr/;size=(\d+)$/;
+
+# number of reads represented by a read name
+sub mult {
+  return $_[0] =~ $SIZE ? $1 : 1;
+}
+
+# 1 if a read name is of collapsed reads
+sub isCollapsed {
+  return $_[0] =~ $SIZE ? 1 : 0;
+}
+
+1;
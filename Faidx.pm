@@ -0,0 +1,336 @@
+package Faidx;
+
+# Oct. 2026
+
+# Random access to a fasta reference genome, through an
+#   index compatible with 'samtools faidx' (<genome>.fai,
+#   built on first use).  The genome may be compressed
+#   with bgzip (blocks located with <genome>.gzi, also
+#   built if needed); other gzip files are loaded into
+#   memory.  Recently fetched windows are cached.
+#
+#   my $fa = Faidx->new($file);
+#   my $seg = $fa->fetch($chr, $start, $len);  # 0-based
+
+use strict;
+use warnings;
+use Compress::Raw::Zlib;
+
+my $WIN = 65536;    # length of cached windows
+my $MAXWIN = 64;    # max. number of cached windows
+my $CHUNK = 1 << 20;
+
+# open a fasta file, loading (or building) its index
+sub new {
+  my ($class, $file) = @_;
+  my $self = bless { file => $file, idx => {}, ord => [],
+    cache => {}, lru => [], gzi => undef, mem => undef }, $class;
+  open(my $fh, '<:raw', $file) || die "Cannot open $file\n";
+  $self->{fh} = $fh;
+
+  # check compression
+  my $head = "";
+  read($fh, $head, 18);
+  if (length $head >= 2 && substr($head, 0, 2) eq "\x1f\x8b") {
+    if (length $head == 18 && substr($head, 3, 1) eq "\x04"
+        && substr($head, 12, 2) eq "BC") {
+      $self->{gzi} = [ [0, 0] ];
+    } else {
+      warn "Warning! $file is not compressed with bgzip --\n",
+        "  loading the genome into memory\n";
+      $self->loadMem();
+      return $self;
+    }
+  }
+
+  # load index (rebuild if older than the genome)
+  my $fai = "$file.fai";
+  if (-f $fai && -M $fai <= -M $file &&
+      (! $self->{gzi} || (-f "$file.gzi" && -M "$file.gzi" <= -M $file))) {
+    $self->loadIdx($fai);
+    $self->loadGzi("$file.gzi") if ($self->{gzi});
+  } else {
+    $self->buildIdx();
+  }
+  return $self;
+}
+
+# reopen the file (in a forked process, which would otherwise
+#   share the file offset with its parent)
+sub reopen {
+  my $self = shift;
+  return if ($self->{mem});
+  close $self->{fh};
+  open(my $fh, '<:raw', $self->{file}) || die "Cannot open $self->{file}\n";
+  $self->{fh} = $fh;
+}
+
+# chromosome names, in order of the genome
+sub names {
+  my $self = shift;
+  return @{$self->{ord}};
+}
+
+# length of a chromosome (undef if not in the genome)
+sub chrLen {
+  my ($self, $chr) = @_;
+  return undef if (! exists $self->{idx}{$chr});
+  return $self->{idx}{$chr}[0];
+}
+
+# retrieve a segment of a chromosome (0-based start; clipped
+#   to the ends of the chromosome), or undef if not found
+sub fetch {
+  my ($self, $chr, $st, $len) = @_;
+  my $ent = $self->{idx}{$chr};
+  return undef if (! $ent);
+  my $end = $st + $len;
+  $end = $ent->[0] if ($end > $ent->[0]);
+  $st = 0 if ($st < 0);
+  return "" if ($end <= $st);
+  return substr($self->{mem}{$chr}, $st, $end - $st) if ($self->{mem});
+
+  my $seq = "";
+  for (my $w = int($st / $WIN); $w * $WIN < $end; $w++) {
+    my $win = $self->window($chr, $w);
+    my $s = ($st > $w * $WIN ? $st - $w * $WIN : 0);
+    my $e = ($end < ($w + 1) * $WIN ? $end - $w * $WIN : $WIN);
+    $seq .= substr($win, $s, $e - $s);
+  }
+  return $seq;
+}
+
+# retrieve a window of a chromosome (from the cache if present)
+sub window {
+  my ($self, $chr, $w) = @_;
+  my $key = "$chr\t$w";
+  my $lru = $self->{lru};
+  if (exists $self->{cache}{$key}) {
+    @$lru = ($key, grep($_ ne $key, @$lru));
+    return $self->{cache}{$key};
+  }
+
+  # read bases from the file
+  my ($len, $off, $lb, $lw) = @{$self->{idx}{$chr}};
+  my $st = $w * $WIN;
+  my $end = ($st + $WIN < $len ? $st + $WIN : $len);
+  my $bst = $off + int($st / $lb) * $lw + $st % $lb;
+  my $bend = $off + int(($end - 1) / $lb) * $lw + ($end - 1) % $lb + 1;
+  my $win = $self->readAt($bst, $bend - $bst);
+  $win =~ tr/\r\n//d;
+  die "Error! Cannot read $chr from $self->{file} (index out of date?)\n"
+    if (length $win != $end - $st);
+
+  $self->{cache}{$key} = $win;
+  unshift @$lru, $key;
+  delete $self->{cache}{pop @$lru} if (scalar @$lru > $MAXWIN);
+  return $win;
+}
+
+# read bytes of the (uncompressed) genome
+sub readAt {
+  my ($self, $pos, $n) = @_;
+  my $fh = $self->{fh};
+  my $buf = "";
+  if (! $self->{gzi}) {
+    seek($fh, $pos, 0);
+    read($fh, $buf, $n);
+    return $buf;
+  }
+
+  # find block containing $pos
+  my $gzi = $self->{gzi};
+  my ($lo, $hi) = (0, $#$gzi);
+  while ($lo < $hi) {
+    my $mid = ($lo + $hi + 1) >> 1;
+    if ($gzi->[$mid][1] <= $pos) {
+      $lo = $mid;
+    } else {
+      $hi = $mid - 1;
+    }
+  }
+  my ($coff, $uoff) = @{$gzi->[$lo]};
+  seek($fh, $coff, 0);
+  while (length $buf < $pos - $uoff + $n) {
+    my $data = readBlock($fh, $self->{file});
+    last if (! defined $data);
+    $buf .= $data;
+  }
+  return substr($buf, $pos - $uoff, $n);
+}
+
+# read and inflate one BGZF block (undef at end of file)
+sub readBlock {
+  my ($fh, $file) = @_;
+  my $head = "";
+  return undef if (read($fh, $head, 18) != 18);
+  die "Error! $file is not properly compressed with bgzip\n"
+    if (substr($head, 0, 2) ne "\x1f\x8b" || substr($head, 12, 2) ne "BC");
+  my $bsize = unpack("v", substr($head, 16, 2));
+  my $comp = "";
+  die "Error! $file is truncated\n"
+    if (read($fh, $comp, $bsize - 17) != $bsize - 17);
+  my ($inf, $st) = Compress::Raw::Zlib::Inflate->new(
+    -WindowBits => -MAX_WBITS, -ConsumeInput => 0);
+  my $data = "";
+  $st = $inf->inflate(substr($comp, 0, -8), $data);
+  die "Error! Cannot decompress $file\n"
+    if ($st != Z_OK && $st != Z_STREAM_END);
+  return $data;
+}
+
+# load index files
+sub loadIdx {
+  my ($self, $fai) = @_;
+  open(my $in, '<', $fai) || die "Cannot open $fai\n";
+  while (my $line = <$in>) {
+    chomp $line;
+    my @spl = split("\t", $line);
+    die "Error! $fai is improperly formatted\n" if (scalar @spl < 5);
+    $self->{idx}{$spl[0]} = [ @spl[1 .. 4] ];
+    push @{$self->{ord}}, $spl[0];
+  }
+  close $in;
+}
+sub loadGzi {
+  my ($self, $file) = @_;
+  open(my $in, '<:raw', $file) || die "Cannot open $file\n";
+  my $buf = "";
+  read($in, $buf, 8);
+  my $n = unpack("Q<", $buf);
+  read($in, $buf, 16 * $n);
+  my @val = unpack("Q<*", $buf);
+  for (my $x = 0; $x < 2 * $n; $x += 2) {
+    push @{$self->{gzi}}, [ $val[$x], $val[$x+1] ];
+  }
+  close $in;
+}
+
+# build index from the genome (and write it, if possible)
+sub buildIdx {
+  my $self = shift;
+  my $fh = $self->{fh};
+  seek($fh, 0, 0);
+  my $ent;       # current entry: name, length, offset, bases/line,
+                 #   bytes/line, and if its last line was short
+  my $pos = 0;   # offset of $buf
+  my $buf = "";
+  my $coff = 0;  # offset of the next compressed block
+  while (1) {
+    my $data;
+    if ($self->{gzi}) {
+      $data = readBlock($fh, $self->{file});
+      if (defined $data) {
+        push @{$self->{gzi}}, [ $coff, $pos + length $buf ]
+          if ($coff);
+        $coff = tell $fh;
+      }
+    } else {
+      $data = "";
+      $data = undef if (! read($fh, $data, $CHUNK));
+    }
+    $buf .= $data if (defined $data);
+
+    # parse complete lines (and the last one at end of file)
+    my $i = 0;
+    while (1) {
+      my $j = index($buf, "\n", $i);
+      if ($j == -1) {
+        last if (defined $data || $i == length $buf);
+        $j = length($buf) - 1;
+      }
+      $ent = $self->addLine($ent, substr($buf, $i, $j - $i + 1),
+        $pos + $i);
+      $i = $j + 1;
+    }
+    $pos += $i;
+    $buf = substr($buf, $i);
+    last if (! defined $data);
+  }
+  $self->addLine($ent, undef, $pos);
+  die "Error! No sequences in $self->{file}\n" if (! @{$self->{ord}});
+
+  # save index files (skipped if directory is not writable)
+  if (open(my $out, '>', "$self->{file}.fai")) {
+    foreach my $chr (@{$self->{ord}}) {
+      print $out join("\t", $chr, @{$self->{idx}{$chr}}), "\n";
+    }
+    close $out;
+  }
+  if ($self->{gzi} && open(my $out, '>:raw', "$self->{file}.gzi")) {
+    my $gzi = $self->{gzi};
+    print $out pack("Q<", $#$gzi);
+    for (my $x = 1; $x < scalar @$gzi; $x++) {
+      print $out pack("Q<Q<", @{$gzi->[$x]});
+    }
+    close $out;
+  }
+}
+
+# add a line of the genome to the index
+sub addLine {
+  my ($self, $ent, $line, $off) = @_;
+  if (! defined $line || substr($line, 0, 1) eq '>') {
+    # save previous entry
+    if ($ent) {
+      $self->{idx}{$ent->[0]} = [ @$ent[1 .. 4] ];
+      push @{$self->{ord}}, $ent->[0];
+    }
+    return undef if (! defined $line);
+    my @head = split(" ", substr($line, 1));
+    my $chr = (@head ? $head[0] : "");
+    die "Error! In reference genome $self->{file}:\n",
+      "  Chromosome name $chr repeated\n"
+      if (exists $self->{idx}{$chr});
+    return [ $chr, 0, $off + length $line, 0, 0, 0 ];
+  }
+  die "Error! $self->{file} is improperly formatted:\n",
+    "  sequence before first header\n" if (! $ent);
+
+  (my $seq = $line) =~ tr/\r\n//d;
+  my $n = length $seq;
+  if (! $ent->[3]) {
+    # first line of sequence (skipping blank lines)
+    if ($n) {
+      $ent->[3] = $n;
+      $ent->[4] = length $line;
+    } else {
+      $ent->[2] += length $line;
+    }
+  } elsif ($ent->[5] && $n) {
+    die "Error! In reference genome $self->{file}:\n",
+      "  Different line lengths in $ent->[0]\n";
+  } elsif ($n != $ent->[3] || length $line != $ent->[4]) {
+    die "Error! In reference genome $self->{file}:\n",
+      "  Different line lengths in $ent->[0]\n"
+      if ($n > $ent->[3]);
+    $ent->[5] = 1;  # last line (shorter)
+  }
+  $ent->[1] += $n;
+  return $ent;
+}
+
+# load a (non-bgzip) compressed genome into memory
+sub loadMem {
+  my $self = shift;
+  close $self->{fh};
+  open(my $in, "zcat $self->{file} |") || die "Cannot open $self->{file}\n";
+  local $/ = '>';
+  my $waste = <$in>;
+  while (my $chunk = <$in>) {
+    chomp $chunk;
+    my @spl = split("\n", $chunk);
+    my @head = split(" ", shift @spl);
+    my $chr = $head[0];
+    die "Error! In reference genome $self->{file}:\n",
+      "  Chromosome name $chr repeated\n"
+      if (exists $self->{idx}{$chr});
+    $self->{mem}{$chr} = join("", @spl);
+    $self->{mem}{$chr} =~ tr/\r//d;
+    $self->{idx}{$chr} = [ length $self->{mem}{$chr} ];
+    push @{$self->{ord}}, $chr;
+  }
+  close $in;
+}
+
+1;
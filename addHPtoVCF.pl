@@ -11,6 +11,9 @@
 
 use strict;
 use warnings;
+use FindBin;
+use lib $FindBin::RealBin;
+use Faidx;
 
 sub usage {
   print q(Usage: perl addHPtoVCF.pl  <infile>  <genome>  <outfile>  [<logfile>]
@@ -18,7 +21,8 @@ sub usage {
     <infile>   Input VCF file -- should list one variant per
                  line, with INFO field "CIGAR"
     <genome>   Fasta file of reference genome (single file; may be
-                 gzip compressed, with ".gz" extension)
+                 gzip compressed, with ".gz" extension [bgzip for
+                 random access]; indexed as by 'samtools faidx')
     <outfile>  Output VCF file
   Optional:
     <logfile>  Verbose log file (if selected, input VCF
@@ -31,15 +35,7 @@ usage() if (scalar @ARGV < 3 || $ARGV[0] eq "-h");
 
 # open files
 open(VCF, $ARGV[0]) || die "Cannot open $ARGV[0]\n";
-if (substr($ARGV[1], -3) eq ".gz") {
-  die "Cannot open $ARGV[1]\n" if (! -f $ARGV[1]);
-  open(GEN, "zcat $ARGV[1] |");
-} else {
-  open(GEN, $ARGV[1]) || die "Cannot open $ARGV[1]\n";
-}
-$/ = '>';
-my $waste = <GEN>;
-$/ = "\n";
+my $gen = Faidx->new($ARGV[1]);
 open(OUT, ">$ARGV[2]") || die "Cannot open $ARGV[2] for writing\n";
 if (scalar @ARGV > 3) {
   open(LOG, ">$ARGV[3]") || die "Cannot open $ARGV[3] for writing\n";
@@ -47,8 +43,6 @@ if (scalar @ARGV > 3) {
 }
 
 # analyze VCF file
-my $chr = "";
-my $seq = "";
 my $pr = 1;  # flag for header printing
 while (my $line = <VCF>) {
   if (substr($line, 0, 1) eq '#') {
@@ -161,43 +155,12 @@ while (my $line = <VCF>) {
     $hit = 0;
   } else {
 
-    # if not already loaded, get chromosome from genome
-    if ($spl[0] ne $chr) {
-      $chr = $spl[0];
-      $seq = "";
-      for (my $x = 0; $x < 2; $x++) {
-        local $/ = '>';
-        while (my $chunk = <GEN>) {
-          chomp $chunk;
-          my @div = split("\n", $chunk);
-          my @head = split(" ", shift @div);
-          my $ch = $head[0];
-          if ($spl[0] eq $ch) {
-            $seq = join("", @div);
-            last;
-          }
-        }
-        if (! $seq) {
-          # if not found, try again
-          close GEN;
-          if (substr($ARGV[1], -3) eq ".gz") {
-            open(GEN, "zcat $ARGV[1] |");
-          } else {
-            open(GEN, $ARGV[1]);
-          }
-          my $waste = <GEN>;
-        } else {
-          last;
-        }
-      }
-    }
-    if (! $seq) {
-      die "Error! Cannot find chromosome $chr in $ARGV[1]\n";
-    }
-
     # judge chrom segments (10bp on either side of variant)
-    my $seg1 = substr($seq, $loc[0]-11, 10);
-    my $seg2 = substr($seq, $loc[$#loc], 10);
+    if (! defined $gen->chrLen($spl[0])) {
+      die "Error! Cannot find chromosome $spl[0] in $ARGV[1]\n";
+    }
+    my $seg1 = $gen->fetch($spl[0], $loc[0]-11, 10);
+    my $seg2 = $gen->fetch($spl[0], $loc[$#loc], 10);
     $seg1 =~ tr/a-z/A-Z/;
     $seg2 =~ tr/a-z/A-Z/;
 
@@ -232,7 +195,6 @@ while (my $line = <VCF>) {
   print OUT join("\t", @spl), "\n";
 
 }
-close GEN;
 close VCF;
 close OUT;
 close LOG if (scalar @ARGV > 3);
@@ -0,0 +1,722 @@
+/*
+  October 2026
+
+  Aligning primer-trimmed reads to the target sequences
+    of their amplicons (as identified by removePrimer),
+    without a genome-wide search.
+  Each read is aligned end-to-end, within a band around
+    the expected diagonal, to the target sequence from
+    the primers file (getPrimers.pl), and is scored as
+    by bowtie2 in its default end-to-end mode. Reads that
+    meet the min. score are printed as SAM records at the
+    genome positions given by the BED file; others are
+    printed to a fastq file (to be mapped with bowtie2).
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <zlib.h>
+#include "panel.h"
+#include "alignAmp.h"
+
+// global variables
+static Amplicon* amp;
+static int nAmp;
+
+/* void usage()
+ * Prints usage information.
+ */
+void usage(void) {
+  fprintf(stderr, "Usage: ./alignAmp {%s <file> %s <file> ", INFILE, PRIMFILE);
+  fprintf(stderr, "%s <file> %s <file>} [optional parameters]\n", BEDFILE, OUTFILE);
+  fprintf(stderr, "Required parameters:\n");
+  fprintf(stderr, "  %s <file>   Input FASTQ file of reads with primers removed and\n", INFILE);
+  fprintf(stderr, "                amplicons identified (by removePrimer); can be gzip\n");
+  fprintf(stderr, "                compressed, with \"%s\" extension\n", GZEXT);
+  fprintf(stderr, "  %s <file>   File listing primer and target sequences (produced\n", PRIMFILE);
+  fprintf(stderr, "                by getPrimers.pl), or a panel bundle (made by\n");
+  fprintf(stderr, "                buildPanel), which gives the locations as well\n");
+  fprintf(stderr, "  %s <file>   BED file listing locations of primers (optional\n", BEDFILE);
+  fprintf(stderr, "                with a bundle: checked to be its source)\n");
+  fprintf(stderr, "  %s <file>   Output SAM file of aligned reads (no header;\n", OUTFILE);
+  fprintf(stderr, "                to be appended to a bowtie2 SAM file)\n");
+  fprintf(stderr, "Optional parameters:\n");
+  fprintf(stderr, "  %s <file>   Output FASTQ file for reads not aligned (will be\n", UNFILE);
+  fprintf(stderr, "                gzip compressed if input is)\n");
+  fprintf(stderr, "  %s <int>    Band width, to either side of the expected\n", BAND);
+  fprintf(stderr, "                diagonal (def. %d)\n", DEFBAND);
+  fprintf(stderr, "  %s <float>,<float>  Min. alignment score, as a linear function\n", SCOREMIN);
+  fprintf(stderr, "                of read length (def. %.1f,%.1f [as bowtie2])\n", DEFMINA, DEFMINB);
+  fprintf(stderr, "  %s         Option to print counts of results to stdout\n", VERBOSE);
+  exit(-1);
+}
+
+/* int error()
+ * Prints an error message.
+ */
+int error(char* msg, int err) {
+  char* msg2;
+  if (err == ERROPEN) msg2 = MERROPEN;
+  else if (err == ERRCLOSE) msg2 = MERRCLOSE;
+  else if (err == ERROPENW) msg2 = MERROPENW;
+  else if (err == ERRMEM) msg2 = MERRMEM;
+  else if (err == ERRPARAM) msg2 = MERRPARAM;
+  else if (err == ERRSEQ) msg2 = MERRSEQ;
+  else if (err == ERRFLOAT) msg2 = MERRFLOAT;
+  else if (err == ERRINT) msg2 = MERRINT;
+  else if (err == ERRPRIM) msg2 = MERRPRIM;
+  else if (err == ERRBED) msg2 = MERRBED;
+  else if (err == ERRAMP) msg2 = MERRAMP;
+  else if (err == ERRSCORE) msg2 = MERRSCORE;
+  else if (err == ERRFASTQ) msg2 = MERRFASTQ;
+  else msg2 = DEFERR;
+
+  fprintf(stderr, "Error! %s%s\n", msg, msg2);
+  return -1;
+}
+
+/* void* memalloc()
+ * Allocates a heap block.
+ */
+void* memalloc(int size) {
+  void* ans = malloc(size);
+  if (ans == NULL)
+    exit(error("", ERRMEM));
+  return ans;
+}
+
+/* float getFloat(char*)
+ * Converts the given char* to a float.
+ */
+float getFloat(char* in) {
+  char* endptr;
+  float ans = strtof(in, &endptr);
+  if (*endptr != '\0')
+    exit(error(in, ERRFLOAT));
+  return ans;
+}
+
+/* int getInt(char*)
+ * Converts the given char* to an int.
+ */
+int getInt(char* in) {
+  char* endptr;
+  int ans = (int) strtol(in, &endptr, 10);
+  if (*endptr != '\0')
+    exit(error(in, ERRINT));
+  return ans;
+}
+
+/* void getScoreMin()
+ * Parses the min. score function ("<float>,<float>").
+ */
+void getScoreMin(char* in, float* a, float* b) {
+  char* endptr;
+  *a = strtof(in, &endptr);
+  if (endptr == in || *endptr != ',')
+    exit(error(in, ERRSCORE));
+  char* st = endptr + 1;
+  *b = strtof(st, &endptr);
+  if (endptr == st || *endptr != '\0')
+    exit(error(in, ERRSCORE));
+}
+
+/* char* getLine()
+ * Reads the next line from a file.
+ */
+char* getLine(char* line, int size, File in, int gz) {
+  if (gz)
+    return gzgets(in.gzf, line, size);
+  else
+    return fgets(line, size, in.f);
+}
+
+/* int ampCmp()
+ * Compares amplicons by name (for qsort/bsearch).
+ */
+int ampCmp(const void* a, const void* b) {
+  return strcmp(((Amplicon*) a)->name, ((Amplicon*) b)->name);
+}
+
+/* Amplicon* findAmp()
+ * Finds an amplicon by name (NULL if not found).
+ */
+Amplicon* findAmp(char* name) {
+  Amplicon key;
+  key.name = name;
+  return (Amplicon*) bsearch(&key, amp, nAmp, sizeof(Amplicon), ampCmp);
+}
+
+/* char* saveStr()
+ * Returns a heap copy of a string.
+ */
+char* saveStr(char* str) {
+  char* ans = (char*) memalloc(strlen(str) + 1);
+  strcpy(ans, str);
+  return ans;
+}
+
+/* void loadAmps()
+ * Loads the target sequences from the primers file,
+ *   and their positions from the BED file.
+ */
+void loadAmps(FILE* prim, FILE* bed) {
+  char* line = (char*) memalloc(MAX_SIZE);
+  int max = 0;
+  nAmp = 0;
+  amp = NULL;
+  while (fgets(line, MAX_SIZE, prim) != NULL) {
+    if (line[0] == '#' || line[0] == '\n' || line[0] == '\r')
+      continue;
+    char* name = strtok(line, CSV);
+    strtok(NULL, CSV);      // fwd primer
+    strtok(NULL, CSV);      // rev primer
+    char* seq = strtok(NULL, DEL);
+    if (name == NULL || seq == NULL)
+      exit(error(name == NULL ? "" : name, ERRPRIM));
+    if (nAmp == max) {
+      max = max ? 2 * max : 64;
+      amp = (Amplicon*) realloc(amp, max * sizeof(Amplicon));
+      if (amp == NULL)
+        exit(error("", ERRMEM));
+    }
+    Amplicon* a = amp + nAmp++;
+    a->name = saveStr(name);
+    a->seq = saveStr(seq);
+    a->len = strlen(seq);
+    for (int i = 0; i < a->len; i++)
+      if (a->seq[i] >= 'a' && a->seq[i] <= 'z')
+        a->seq[i] -= 32;
+    a->chr = NULL;
+    a->pos = a->st = -1;
+  }
+  qsort(amp, nAmp, sizeof(Amplicon), ampCmp);
+
+  // target position: end of the first primer (by coordinate)
+  while (fgets(line, MAX_SIZE, bed) != NULL) {
+    if (line[0] == '#' || line[0] == '\n' || line[0] == '\r' ||
+        !strncmp(line, "track", 5) || !strncmp(line, "browser", 7))
+      continue;
+    char* chr = strtok(line, "\t");
+    char* st = strtok(NULL, "\t");
+    char* end = strtok(NULL, "\t");
+    char* name = strtok(NULL, "\t\n\r");
+    if (name == NULL)
+      exit(error(chr, ERRBED));
+    Amplicon* a = findAmp(name);
+    if (a == NULL)
+      continue;
+    int s = getInt(st), e = getInt(end);
+    if (a->st == -1) {
+      a->st = s;
+      a->end = e;
+      a->chr = saveStr(chr);
+    } else
+      a->pos = (s < a->st ? e : a->end);
+  }
+  free(line);
+}
+
+/* void loadPanel()
+ * Loads the target sequences and their positions from a
+ *   panel bundle (buildPanel), checking the BED file (if
+ *   given) to be its source.
+ */
+void loadPanel(char* file, char* bedFile) {
+  Panel pn;
+  openPanel(file, &pn);
+  if (bedFile != NULL)
+    checkPanelSrc(&pn, PNLBED, bedFile);
+  nAmp = pn.head->nAmp;
+  amp = (Amplicon*) memalloc(nAmp * sizeof(Amplicon));
+  for (int i = 0; i < nAmp; i++) {
+    PnlAmp* p = pn.amp + pn.byName[i];
+    Amplicon* a = amp + i;
+    if (! p->tgt)
+      exit(error(pn.str + p->name, ERRPRIM));
+    a->name = saveStr(pn.str + p->name);
+    a->seq = saveStr(pn.str + p->tgt);
+    a->len = strlen(a->seq);
+    for (int j = 0; j < a->len; j++)
+      if (a->seq[j] >= 'a' && a->seq[j] <= 'z')
+        a->seq[j] -= 32;
+    a->chr = NULL;
+    a->pos = a->st = -1;
+    if (! p->nBed)
+      continue;
+    a->chr = saveStr(pn.str + p->chr);
+    a->st = p->st[0];
+    a->end = p->end[0];
+    if (p->nBed == 2)
+      a->pos = (p->st[1] < a->st ? p->end[1] : a->end);
+  }
+  closePanel(&pn);
+}
+
+/* void checkAmps()
+ * Checks that the amplicons have positions.
+ */
+void checkAmps(void) {
+  int count = 0;
+  for (int i = 0; i < nAmp; i++)
+    if (amp[i].pos != -1)
+      count++;
+    else
+      fprintf(stderr, "Warning! Amplicon %s does not have two primers in BED file\n",
+        amp[i].name);
+  if (!count)
+    exit(error("", ERRAMP));
+}
+
+/* Amplicon* getAmp()
+ * Finds the amplicon of a read from its header ("<amplicon>
+ *   fwd|rev [both]", or "XP:Z:<amplicon>,fwd|rev,one|both",
+ *   added by removePrimer). Sets 'rc' if the read is
+ *   reverse-complemented.
+ */
+Amplicon* getAmp(char* head, int* rc) {
+  char* prev = NULL, *cur = NULL;
+  int i = 0;
+  while (head[i] != '\0' && head[i] != '\n' && head[i] != '\r') {
+    if (head[i] == ' ' || head[i] == '\t') {
+      i++;
+      continue;
+    }
+    // token begins
+    prev = cur;
+    cur = head + i;
+    int len = strcspn(cur, " \t\r\n");
+    if (!strncmp(cur, XPTAG, strlen(XPTAG))) {
+      char* name = cur + strlen(XPTAG);
+      int nLen = strcspn(name, ",");
+      if (nLen >= len || nLen >= MAX_SIZE)
+        return NULL;
+      char amp[MAX_SIZE];
+      strncpy(amp, name, nLen);
+      amp[nLen] = '\0';
+      *rc = !strncmp(name + nLen + 1, REV, 3);
+      Amplicon* a = findAmp(amp);
+      return (a == NULL || a->pos == -1 ? NULL : a);
+    }
+    if (prev != NULL && len == 3 &&
+        (!strncmp(cur, FWD, 3) || !strncmp(cur, REV, 3))) {
+      *rc = (cur[0] == 'r');
+      int pLen = strcspn(prev, " \t\r\n");
+      char name[MAX_SIZE];
+      strncpy(name, prev, pLen);
+      name[pLen] = '\0';
+      Amplicon* a = findAmp(name);
+      return (a == NULL || a->pos == -1 ? NULL : a);
+    }
+    i += len;
+  }
+  return NULL;
+}
+
+/* int alignRead()
+ * Aligns a read to a target sequence, end-to-end within
+ *   a band of +/- 'w' around diagonal 'd0' (the target
+ *   position of the read's first base), with free gaps in
+ *   the target at either end. Returns the score, and sets
+ *   the operations ('M' = match, 'X' = mismatch, 'I', 'D';
+ *   in reverse order), their number, and the target
+ *   position of the first aligned base.
+ */
+int alignRead(char* seq, char* qual, int n, char* tgt, int m,
+    int d0, int w, char* tb, int* h, int* e, int* f, int* h2,
+    int* f2, char* op, int* nOp, int* pos) {
+  int W = 2 * w + 1;
+
+  // first row: free start in target
+  for (int k = 0; k < W; k++) {
+    int j = d0 + k - w;
+    h[k] = (j >= 0 && j <= m ? 0 : NEGINF);
+    e[k] = f[k] = NEGINF;
+    tb[k] = TBSTART;
+  }
+
+  for (int i = 1; i <= n; i++) {
+    char r = seq[i - 1];
+    int q = qual[i - 1] - OFFSET;
+    if (q > QMAX)
+      q = QMAX;
+    else if (q < 0)
+      q = 0;
+    int mm = MMIN + (MMAX - MMIN) * q / QMAX;
+    int insOK = (i - 1 >= GAPBAR && i - 1 < n - GAPBAR);
+    int delOK = (i >= GAPBAR && i <= n - GAPBAR);
+    char* t = tb + i * W;
+    for (int k = 0; k < W; k++) {
+      int j = i + d0 + k - w;
+      t[k] = TBDIAG;
+      if (j < 0 || j > m) {
+        h2[k] = e[k] = f2[k] = NEGINF;
+        continue;
+      }
+
+      // match/mismatch
+      int best = NEGINF;
+      if (j > 0 && h[k] > NEGINF) {
+        char c = tgt[j - 1];
+        best = h[k] + (r == 'N' || c == 'N' ? -NPEN : r == c ? 0 : -mm);
+      }
+
+      // insertion (from row above)
+      int fv = NEGINF;
+      if (insOK && k + 1 < W) {
+        int o = h[k + 1] - GAPOPEN - GAPEXT;
+        int x = f[k + 1] - GAPEXT;
+        if (x > o && f[k + 1] > NEGINF) {
+          fv = x;
+          t[k] |= TBINSEXT;
+        } else if (h[k + 1] > NEGINF)
+          fv = o;
+      }
+
+      // deletion (from left, same row)
+      int ev = NEGINF;
+      if (delOK && k > 0) {
+        int o = h2[k - 1] - GAPOPEN - GAPEXT;
+        int x = e[k - 1] - GAPEXT;
+        if (x > o && e[k - 1] > NEGINF) {
+          ev = x;
+          t[k] |= TBDELEXT;
+        } else if (h2[k - 1] > NEGINF)
+          ev = o;
+      }
+
+      if (ev > best) {
+        best = ev;
+        t[k] = (t[k] & ~3) | TBDEL;
+      }
+      if (fv > best) {
+        best = fv;
+        t[k] = (t[k] & ~3) | TBINS;
+      }
+      h2[k] = best;
+      e[k] = ev;
+      f2[k] = fv;
+    }
+    memcpy(h, h2, W * sizeof(int));
+    memcpy(f, f2, W * sizeof(int));
+  }
+
+  // best end (free end in target), closest to diagonal
+  int kBest = -1;
+  for (int d = 0; d <= w; d++)
+    for (int s = -1; s <= 1; s += 2) {
+      int k = w + s * d;
+      if (h[k] > NEGINF && (kBest == -1 || h[k] > h[kBest]))
+        kBest = k;
+      if (!d)
+        break;
+    }
+  if (kBest == -1)
+    return NEGINF;
+  int score = h[kBest];
+
+  // traceback
+  int i = n, k = kBest, state = 0;
+  *nOp = 0;
+  while (i > 0) {
+    char t = tb[i * W + k];
+    if (!state)
+      state = (t & 3) == TBDIAG ? 0 : (t & 3);
+    if (state == TBDEL) {
+      op[(*nOp)++] = 'D';
+      state = (t & TBDELEXT ? TBDEL : 0);
+      k--;
+    } else if (state == TBINS) {
+      op[(*nOp)++] = 'I';
+      state = (t & TBINSEXT ? TBINS : 0);
+      i--;
+      k++;
+    } else {
+      int j = i + d0 + k - w;
+      op[(*nOp)++] = (seq[i - 1] == tgt[j - 1] && seq[i - 1] != 'N'
+        ? 'M' : 'X');
+      i--;
+    }
+  }
+  *pos = d0 + k - w;
+  return score;
+}
+
+/* void printSam()
+ * Prints the SAM record of an aligned read (with the
+ *   read's SAM tag label, as bowtie2 --sam-append-comment).
+ */
+void printSam(FILE* out, char* head, char* seq, char* qual,
+    int n, int rc, Amplicon* a, int pos, char* op, int nOp,
+    int score, char* buf) {
+  // read name
+  int nLen = strcspn(head + 1, " \t\r\n");
+  fprintf(out, "%.*s\t%d\t%s\t%d\t%d\t", nLen, head + 1,
+    rc ? 16 : 0, a->chr, a->pos + pos + 1, MAPQ);
+
+  // CIGAR
+  for (int i = nOp - 1; i >= 0; ) {
+    char c = (op[i] == 'X' ? 'M' : op[i]);
+    int len = 0;
+    for ( ; i >= 0 && (op[i] == 'X' ? 'M' : op[i]) == c; i--)
+      len++;
+    fprintf(out, "%d%c", len, c);
+  }
+  fprintf(out, "\t*\t0\t0\t%.*s\t%.*s", n, seq, n, qual);
+
+  // counts and MD string
+  int xm = 0, xo = 0, xg = 0, run = 0, j = pos;
+  char* md = buf;
+  for (int i = nOp - 1; i >= 0; i--) {
+    if (op[i] == 'I') {
+      if (i == nOp - 1 || op[i + 1] != 'I')
+        xo++;
+      xg++;
+    } else if (op[i] == 'D') {
+      if (i == nOp - 1 || op[i + 1] != 'D') {
+        xo++;
+        md += sprintf(md, "%d^", run);
+        run = 0;
+      }
+      *md++ = a->seq[j++];
+      xg++;
+    } else if (op[i] == 'X') {
+      md += sprintf(md, "%d%c", run, a->seq[j++]);
+      run = 0;
+      xm++;
+    } else {
+      run++;
+      j++;
+    }
+  }
+  sprintf(md, "%d", run);
+  fprintf(out, "\tAS:i:%d\tXN:i:0\tXM:i:%d\tXO:i:%d\tXG:i:%d"
+    "\tNM:i:%d\tMD:Z:%s\tYT:Z:UU", score, xm, xo, xg,
+    xm + xg, buf);
+  char* com = head + 1 + nLen;
+  com += strspn(com, " \t");
+  if (!strncmp(com, XPTAG, strlen(XPTAG)))
+    fprintf(out, "\t%.*s", (int) strcspn(com, "\r\n"), com);
+  fputc('\n', out);
+}
+
+/* void revComp()
+ * Reverse-complements a sequence (and reverses the
+ *   quality scores) in place.
+ */
+void revComp(char* seq, char* qual, int n) {
+  for (int i = 0, j = n - 1; i <= j; i++, j--) {
+    char a = seq[i], b = seq[j];
+    seq[i] = (b == 'A' ? 'T' : b == 'T' ? 'A' : b == 'C' ? 'G' :
+      b == 'G' ? 'C' : 'N');
+    seq[j] = (a == 'A' ? 'T' : a == 'T' ? 'A' : a == 'C' ? 'G' :
+      a == 'G' ? 'C' : 'N');
+    char c = qual[i];
+    qual[i] = qual[j];
+    qual[j] = c;
+  }
+}
+
+/* void readFile()
+ * Controls the I/O.
+ */
+void readFile(File in, FILE* out, File un, int unOpt, int gz,
+    int w, float minA, float minB, int verbose) {
+  char* head = (char*) memalloc(MAX_SIZE);
+  char* seq = (char*) memalloc(MAX_SIZE);
+  char* plus = (char*) memalloc(MAX_SIZE);
+  char* qual = (char*) memalloc(MAX_SIZE);
+  char* buf = (char*) memalloc(2 * MAX_SIZE);
+  char* op = (char*) memalloc(2 * MAX_SIZE);
+  int W = 2 * w + 1;
+  char* tb = (char*) memalloc((MAX_SIZE + 1) * W);
+  int* h = (int*) memalloc(5 * W * sizeof(int));
+
+  int aligned = 0, failed = 0;
+  while (getLine(head, MAX_SIZE, in, gz) != NULL) {
+    if (head[0] != '@') {
+      if (head[0] == '>')
+        exit(error("", ERRFASTQ));
+      continue;
+    }
+    if (getLine(seq, MAX_SIZE, in, gz) == NULL ||
+        getLine(plus, MAX_SIZE, in, gz) == NULL ||
+        getLine(qual, MAX_SIZE, in, gz) == NULL)
+      exit(error("", ERRSEQ));
+    int n = strcspn(seq, "\r\n");
+
+    // align to target of amplicon
+    int rc = 0, pos = 0, nOp = 0, score = NEGINF;
+    Amplicon* a = getAmp(head, &rc);
+    if (a != NULL && n) {
+      if (rc)
+        revComp(seq, qual, n);
+      score = alignRead(seq, qual, n, a->seq, a->len,
+        rc ? a->len - n : 0, w, tb, h, h + W, h + 2 * W,
+        h + 3 * W, h + 4 * W, op, &nOp, &pos);
+    }
+
+    if (score > NEGINF && score >= (int) (minA + minB * n)) {
+      printSam(out, head, seq, qual, n, rc, a, pos, op, nOp,
+        score, buf);
+      aligned++;
+    } else {
+      if (rc)
+        revComp(seq, qual, n);
+      if (unOpt)
+        gz ? gzprintf(un.gzf, "%s%s%s%s", head, seq, plus, qual)
+          : fprintf(un.f, "%s%s%s%s", head, seq, plus, qual);
+      failed++;
+    }
+  }
+
+  if (verbose)
+    printf("Reads aligned: %d\nReads not aligned: %d\n",
+      aligned, failed);
+
+  free(h);
+  free(tb);
+  free(op);
+  free(buf);
+  free(qual);
+  free(plus);
+  free(seq);
+  free(head);
+}
+
+/* void openWrite()
+ * Opens a file for writing.
+ */
+void openWrite(char* outFile, File* out, int gz) {
+  if (gz) {
+    if (!strcmp(outFile + strlen(outFile) - strlen(GZEXT), GZEXT))
+      out->gzf = gzopen(outFile, "w");
+    else {
+      // add ".gz" to outFile
+      char* outFile2 = memalloc(strlen(outFile) +
+        strlen(GZEXT) + 1);
+      strcpy(outFile2, outFile);
+      strcat(outFile2, GZEXT);
+      out->gzf = gzopen(outFile2, "w");
+      free(outFile2);
+    }
+    if (out->gzf == NULL)
+      exit(error(outFile, ERROPENW));
+  } else {
+    out->f = fopen(outFile, "w");
+    if (out->f == NULL)
+      exit(error(outFile, ERROPENW));
+  }
+}
+
+/* FILE* openRead()
+ * Opens a file for reading.
+ */
+FILE* openRead(char* inFile) {
+  FILE* in = fopen(inFile, "r");
+  if (in == NULL)
+    exit(error(inFile, ERROPEN));
+  return in;
+}
+
+/* void freeMemory()
+ * Frees the amplicons.
+ */
+void freeMemory(void) {
+  for (int i = 0; i < nAmp; i++) {
+    free(amp[i].name);
+    free(amp[i].seq);
+    free(amp[i].chr);
+  }
+  free(amp);
+}
+
+/* void getParams()
+ * Gets command-line parameters.
+ */
+void getParams(int argc, char** argv) {
+
+  char* inFile = NULL, *primFile = NULL, *bedFile = NULL,
+    *outFile = NULL, *unFile = NULL;
+  int w = DEFBAND, verbose = 0;
+  float minA = DEFMINA, minB = DEFMINB;
+
+  // parse argv
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], HELP))
+      usage();
+    else if (!strcmp(argv[i], VERBOSE))
+      verbose = 1;
+    else if (i < argc - 1) {
+      if (!strcmp(argv[i], INFILE))
+        inFile = argv[++i];
+      else if (!strcmp(argv[i], PRIMFILE))
+        primFile = argv[++i];
+      else if (!strcmp(argv[i], BEDFILE))
+        bedFile = argv[++i];
+      else if (!strcmp(argv[i], OUTFILE))
+        outFile = argv[++i];
+      else if (!strcmp(argv[i], UNFILE))
+        unFile = argv[++i];
+      else if (!strcmp(argv[i], BAND))
+        w = getInt(argv[++i]);
+      else if (!strcmp(argv[i], SCOREMIN))
+        getScoreMin(argv[++i], &minA, &minB);
+      else
+        exit(error(argv[i], ERRPARAM));
+    } else
+      exit(error(argv[i], ERRPARAM));
+  }
+
+  if (inFile == NULL || primFile == NULL || outFile == NULL || w < 0)
+    usage();
+
+  // load amplicons (from a panel bundle, or primers and BED files)
+  if (isPanel(primFile))
+    loadPanel(primFile, bedFile);
+  else {
+    if (bedFile == NULL)
+      usage();
+    FILE* prim = openRead(primFile);
+    FILE* bed = openRead(bedFile);
+    loadAmps(prim, bed);
+    if (fclose(prim) || fclose(bed))
+      exit(error("", ERRCLOSE));
+  }
+  checkAmps();
+
+  // open files
+  File in, un;
+  int gz = 0;
+  if (!strcmp(inFile + strlen(inFile) - strlen(GZEXT), GZEXT)) {
+    gz = 1;
+    in.gzf = gzopen(inFile, "r");
+    if (in.gzf == NULL)
+      exit(error(inFile, ERROPEN));
+  } else
+    in.f = openRead(inFile);
+  FILE* out = fopen(outFile, "w");
+  if (out == NULL)
+    exit(error(outFile, ERROPENW));
+  if (unFile != NULL)
+    openWrite(unFile, &un, gz);
+
+  readFile(in, out, un, unFile != NULL, gz, w, minA, minB, verbose);
+
+  if ( (gz && (gzclose(in.gzf) != Z_OK ||
+      (unFile != NULL && gzclose(un.gzf) != Z_OK))) ||
+      (! gz && (fclose(in.f) || (unFile != NULL && fclose(un.f)))) ||
+      fclose(out) )
+    exit(error("", ERRCLOSE));
+  freeMemory();
+}
+
+/* int main()
+ * Main.
+ */
+int main(int argc, char* argv[]) {
+  getParams(argc, argv);
+  return 0;
+}
@@ -0,0 +1,93 @@
+/*
+  October 2026
+
+  Header file for alignAmp.c.
+*/
+
+#define MAX_SIZE    1024   // maximum length for input line
+#define OFFSET      33     // ASCII-based offset of quality scores
+#define GZEXT       ".gz"  // file extension for gzip compression
+#define CSV         ",\t"  // delimiters of primers file
+#define DEL         ",\t\n\r"
+#define FWD         "fwd"  // labels of removePrimer
+#define REV         "rev"
+#define XPTAG       "XP:Z:" // label as SAM tag (removePrimer -xp)
+
+// command-line parameters
+#define HELP        "-h"
+#define INFILE      "-i"
+#define PRIMFILE    "-p"
+#define BEDFILE     "-b"
+#define OUTFILE     "-o"
+#define UNFILE      "-u"   // reads not aligned (for bowtie2)
+#define BAND        "-w"   // band width (to either side of diagonal)
+#define SCOREMIN    "-s"   // min. score (linear function of read length)
+#define VERBOSE     "-ve"  // option to print counts to stdout
+
+// default parameter values
+#define DEFBAND     10
+#define DEFMINA     -0.6f  // min. score = a + b * length
+#define DEFMINB     -0.6f  //   (bowtie2's default --score-min L,-0.6,-0.6)
+
+// scoring (bowtie2's end-to-end defaults)
+#define MMAX        6      // max. mismatch penalty (at quality >= QMAX)
+#define MMIN        2      // min. mismatch penalty (at quality 0)
+#define QMAX        40
+#define NPEN        1      // penalty for N in read or reference
+#define GAPOPEN     5
+#define GAPEXT      3
+#define GAPBAR      4      // no gaps within this many bases of read ends
+#define MAPQ        255    // mapping quality ("unavailable")
+#define NEGINF      -1000000
+
+// traceback
+#define TBDIAG      0
+#define TBDEL       1
+#define TBINS       2
+#define TBSTART     3
+#define TBDELEXT    4      // deletion extended (else opened)
+#define TBINSEXT    8      // insertion extended
+
+// error messages
+#define ERROPEN     0
+#define MERROPEN    ": cannot open file for reading"
+#define ERRCLOSE    1
+#define MERRCLOSE   "Cannot close file"
+#define ERROPENW    2
+#define MERROPENW   ": cannot open file for writing"
+#define ERRMEM      3
+#define MERRMEM     "Cannot allocate memory"
+#define ERRPARAM    4
+#define MERRPARAM   ": unknown command-line parameter"
+#define ERRSEQ      5
+#define MERRSEQ     "Cannot load sequence"
+#define ERRFLOAT    6
+#define MERRFLOAT   ": cannot convert to float"
+#define ERRINT      7
+#define MERRINT     ": cannot convert to int"
+#define ERRPRIM     8
+#define MERRPRIM    ": cannot load target sequence from primers file"
+#define ERRBED      9
+#define MERRBED     ": improperly formatted line in BED file"
+#define ERRAMP      10
+#define MERRAMP     "No amplicons with target sequences and BED positions"
+#define ERRSCORE    11
+#define MERRSCORE   ": min. score should be <float>,<float>"
+#define ERRFASTQ    12
+#define MERRFASTQ   ": input must be in fastq format"
+#define DEFERR      "Unknown error"
+
+typedef union file {
+  FILE* f;
+  gzFile gzf;
+} File;
+
+typedef struct amplicon {
+  char* name;
+  char* seq;     // target sequence (between the primers)
+  int len;
+  char* chr;     // chromosome (NULL = not in BED file)
+  int pos;       // 0-based position of target sequence
+  int st;        // start of first primer in BED (-1 = none)
+  int end;       // end of first primer in BED
+} Amplicon;
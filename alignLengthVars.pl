@@ -7,41 +7,61 @@
 
 use strict;
 use warnings;
+use FindBin;
+use lib $FindBin::RealBin;
+use Faidx;
+use IO::Handle;
 
 sub usage {
   print q(Usage: perl alignLengthVars.pl  <infile1>  <infile2>  <infile3>  <outfile> \
-                        <logfile>  <genome>
+                        <logfile>  <genome>  [-n <int>]
   Required:
     <infile1>  File containing length-variant reads without primers attached
-                 (produced by getLengthVars.pl)
+                 (produced by getLengthVars.pl or removePrimer -lr; may be
+                 gzip compressed, with ".gz" extension)
     <infile2>  File listing primer and target sequences (produced by getPrimers.pl)
     <infile3>  BED file listing locations of primers
     <outfile>  Output file containing alignment information for a SAM file
   Optional:
     <logfile>  Verbose output file listing possible CIGARs and scores for each read
     <genome>   Fasta file of reference genome (to evaluate external insertions)
-                 (single file; may be gzip compressed, with ".gz" extension)
+                 (single file; may be gzip compressed, with ".gz" extension
+                 [bgzip for random access]; indexed as by 'samtools faidx')
+    -n <int>   Number of processes to align amplicons in parallel (def. 1)
 );
   exit;
 }
 
+# number of processes (option may be anywhere)
+my $proc = 1;
+for (my $x = 0; $x < $#ARGV; $x++) {
+  if ($ARGV[$x] eq "-n") {
+    $proc = $ARGV[$x+1];
+    die "Error! Number of processes must be a positive integer\n"
+      if ($proc !~ m/^\d+$/ || !$proc);
+    splice(@ARGV, $x, 2);
+    last;
+  }
+}
+
 usage() if (scalar @ARGV < 4 || $ARGV[0] eq "-h");
 
 # open files
-open(FQ, $ARGV[0]) || die "Cannot open $ARGV[0]\n";
+if (substr($ARGV[0], -3) eq ".gz") {
+  die "Cannot open $ARGV[0]\n" if (! -f $ARGV[0]);
+  open(FQ, "zcat $ARGV[0] |");
+} else {
+  open(FQ, $ARGV[0]) || die "Cannot open $ARGV[0]\n";
+}
 open(PR, $ARGV[1]) || die "Cannot open $ARGV[1]\n";
 open(BED, $ARGV[2]) || die "Cannot open $ARGV[2]\n";
 open(OUT, ">$ARGV[3]") || die "Cannot open $ARGV[3] for writing\n";
 if (scalar @ARGV > 4) {
   open(LOG, ">$ARGV[4]") || die "Cannot open $ARGV[4] for writing\n"
 }
+my $fa;  # reference genome
 if (scalar @ARGV > 5) {
-  if (substr($ARGV[5], -3) eq ".gz") {
-    die "Cannot open $ARGV[5]\n" if (! -f $ARGV[5]);
-    open(GEN, "zcat $ARGV[5] |");
-  } else {
-    open(GEN, $ARGV[5]) || die "Cannot open $ARGV[5]\n";
-  }
+  $fa = Faidx->new($ARGV[5]);
 }
 
 # load primer and target sequences
@@ -83,6 +103,7 @@ my $count = 0; my $uniq = 0;
 my %seq;  # amplicons are keys, lengths are keys to %{$seq{$amp}},
           #   seqs are keys to %{$seq{$amp}{$len}},
           # values are lists of reads that share the seq (comma-separated)
+my %num;  # numbers of reads that share each seq (as %seq)
 my %qual; # for quality scores
 while (my $line = <FQ>) {
   next if (substr($line, 0, 1) ne '@');
@@ -92,6 +113,10 @@ while (my $line = <FQ>) {
   # determine amplicon ID
   my $id = "";
   for (my $x = 1; $x < scalar @spl; $x++) {
+    if ($spl[$x] =~ m/^XP:Z:(.+),(fwd|rev),(one|both)$/) {
+      $id = $1;
+      last;
+    }
     if ($spl[$x] eq "fwd" || $spl[$x] eq "rev") {
       $id = $spl[$x-1];
       last;
@@ -112,6 +137,7 @@ while (my $line = <FQ>) {
     $seq{$id}{$len}{$line} = "$spl[$#spl] $read";
     $uniq++;
   }
+  $num{$id}{$len}{$line}++;
   $count++;
   $line = <FQ>;
   # save quality scores
@@ -128,7 +154,76 @@ print LOG "Amplicon\tReads\tScore\tCIGAR(s)\tSequence\tReads"
   if (scalar @ARGV > 4);
 print OUT "#Read\tAmplicon\tSubs\tIn/del\tChrom\tPos\tCIGAR",
   "\tSeq\tQual\tMD\tExternal\tScore\n";
-foreach my $am (sort keys %seq) {
+my @amp = sort keys %seq;
+if ($proc < 2 || scalar @amp < 2) {
+  alignAmp($_) foreach @amp;
+} else {
+  # divide amplicons into contiguous blocks (of similar numbers of
+  #   unique reads), each aligned by a child process
+  my $tot = 0;
+  my %wt;
+  foreach my $am (@amp) {
+    $wt{$am} += scalar keys %{$seq{$am}{$_}} foreach keys %{$seq{$am}};
+    $tot += $wt{$am};
+  }
+  my @blk = ([]);
+  my $sum = 0;
+  foreach my $am (@amp) {
+    push @blk, [] if (@{$blk[$#blk]} && scalar @blk < $proc
+      && $sum >= $tot * (scalar @blk) / $proc);
+    push @{$blk[$#blk]}, $am;
+    $sum += $wt{$am};
+  }
+
+  # flush headers (children must not repeat them)
+  OUT->flush();
+  LOG->flush() if (scalar @ARGV > 4);
+  my @pid;
+  for (my $x = 0; $x < scalar @blk; $x++) {
+    my $pid = fork();
+    die "Error! Cannot fork: $!\n" if (! defined $pid);
+    if (! $pid) {
+      open(OUT, ">$ARGV[3].$x") || die "Cannot open $ARGV[3].$x for writing\n";
+      if (scalar @ARGV > 4) {
+        open(LOG, ">$ARGV[4].$x") || die "Cannot open $ARGV[4].$x for writing\n";
+      }
+      $fa->reopen() if (defined $fa);
+      alignAmp($_) foreach @{$blk[$x]};
+      close OUT;
+      close LOG if (scalar @ARGV > 4);
+      exit 0;
+    }
+    push @pid, $pid;
+  }
+  my $fail = 0;
+  foreach my $pid (@pid) {
+    waitpid($pid, 0);
+    $fail = 1 if ($?);
+  }
+  die "Error! Alignment of length variants failed\n" if ($fail);
+
+  # concatenate outputs, in order of amplicons
+  for (my $x = 0; $x < scalar @blk; $x++) {
+    appendFile(\*OUT, "$ARGV[3].$x");
+    appendFile(\*LOG, "$ARGV[4].$x") if (scalar @ARGV > 4);
+  }
+}
+close OUT;
+close LOG if (scalar @ARGV > 4);
+
+# copy a file (from a child process) to an output, and remove it
+sub appendFile {
+  my ($fh, $file) = @_;
+  open(my $in, '<', $file) || die "Cannot open $file\n";
+  my $buf;
+  print $fh $buf while (read($in, $buf, 1 << 20));
+  close $in;
+  unlink $file;
+}
+
+# align the length variants of an amplicon
+sub alignAmp {
+  my $am = shift;
 
   # loop through length variants
   foreach my $len (sort keys %{$seq{$am}}) {
@@ -142,39 +237,40 @@ foreach my $am (sort keys %seq) {
     }
 
     print LOG "\n$am len=$len\n" if (scalar @ARGV > 4);
-    my %rep = ();  # for I/D and list of reads
+    my $seqs = $seq{$am}{$len};
+    my $cnt = $num{$am}{$len};
+    my @rep = ();  # unique reads aligned (most reads first)
     my %cig = ();  # saves counts of reads that match each cigar
     my $tot = 0;   # total number of reads
 
-    # loop through unique reads
-    while (my $max = findMax(%{$seq{$am}{$len}})) {
-      my @que = split(" ", $max); # $que[0] is sequence, $que[1] is read count
-      $tot += $que[1];
-      my @spl = split(" ", $seq{$am}{$len}{$que[0]}); # $spl[0] is I/D, $spl[1] lists reads
+    # loop through unique reads, most reads first (ties by sequence)
+    foreach my $que (sort { $cnt->{$b} <=> $cnt->{$a} || $a cmp $b }
+        keys %$seqs) {
+      $tot += $cnt->{$que};
+      my @spl = split(" ", $seqs->{$que}); # $spl[0] is I/D, $spl[1] lists reads
       $spl[0] =~ m/(\d+)([ID])/;
-      if (length $que[0] != ($2 eq 'I' ? $1 : -$1) + length $targ{$am}) {
+      if (length $que != ($2 eq 'I' ? $1 : -$1) + length $targ{$am}) {
         warn "Error! $am, $spl[0] does not match sequences:\n",
-          "seq  $que[0]\nref  $targ{$am}\n";
-        delete $seq{$am}{$len}{$que[0]};
+          "seq  $que\nref  $targ{$am}\n";
         next;
       }
 
       # get possible CIGARs
-      my $aln = alignSeq($que[0], $targ{$am}, $1, ($2 eq 'I' ? 1 : 0));
+      my $aln = alignSeq($que, $targ{$am}, $1, ($2 eq 'I' ? 1 : 0));
       my @cut = split(" ", $aln);
       my $score = shift @cut;
       for (my $x = 0; $x < scalar @cut; $x++) {
-        $cig{$cut[$x]} += $que[1];
+        $cig{$cut[$x]} += $cnt->{$que};
       }
 
       # log info
-      print LOG "\t$que[1]\t$score\t", join(",", @cut),
-        "\t$que[0]\t$spl[1]\n" if (scalar @ARGV > 4);
+      print LOG "\t$cnt->{$que}\t$score\t", join(",", @cut),
+        "\t$que\t$spl[1]\n" if (scalar @ARGV > 4);
 
-      $rep{$que[0]} = "$spl[0] $spl[1]"; # save I/D and list of reads
-      delete $seq{$am}{$len}{$que[0]};
+      push @rep, $que;
     }
 
+
     # find consensus CIGAR
     my $max = 0;
     my $firstM = 1000;  # first M of cigar -- 0 indicates external in/del
@@ -229,33 +325,14 @@ foreach my $am (sort keys %seq) {
           $gen = substr($fwd{$am}.$targ{$am}, - $len - length $prim, length $prim);
         }
       } elsif (scalar @ARGV > 5) {
-        # external insertion: must query whole genome for segment
+        # external insertion: query genome for segment
         my @div = split("\t", $loc{$am});
-        my $chr = "";
-        local $/ = '>';
-        my $waste = <GEN>;
-        while (my $chunk = <GEN>) {
-          chomp $chunk;
-          my @spl = split("\n", $chunk);
-          my @head = split(" ", shift @spl);
-          my $ch = $head[0];
-          if ($ch eq $div[0]) {
-            $chr = join("", @spl);
-            last;
-          }
-        }
-        close GEN;
-        if (substr($ARGV[5], -3) eq ".gz") {
-          open(GEN, "zcat $ARGV[5] |");
-        } else {
-          open(GEN, $ARGV[5]);
-        }
-        if ($chr) {
+        if (defined $fa->chrLen($div[0])) {
           if ($three) {
-            $gen = reverse(substr($chr, $div[1] - 1 + $len, length $prim));
+            $gen = reverse($fa->fetch($div[0], $div[1] - 1 + $len, length $prim));
           } else {
             $best =~ m/^0M(\d+)I/;
-            $gen = substr($chr, $div[1] - 1 - $1 - length $prim, length $prim);
+            $gen = $fa->fetch($div[0], $div[1] - 1 - $1 - length $prim, length $prim);
           }
           $gen =~ tr/a-z/A-Z/;
         }
@@ -277,11 +354,10 @@ foreach my $am (sort keys %seq) {
       }
 
       # produce output -- info for a SAM record
-      while (my $max = findMax(%rep)) {
-        my @que = split(" ", $max); # $que[0] is sequence, $que[1] is read count
-        my @cut = split(" ", $rep{$que[0]}); # $cut[0] has in/del length
+      foreach my $que (@rep) {
+        my @cut = split(" ", $seqs->{$que}); # $cut[0] has in/del length
         my @spl = split(",", $cut[1]); # list of reads
-        my $seq1 = ($three ? $que[0].$base : $base.$que[0]);
+        my $seq1 = ($three ? $que.$base : $base.$que);
         my $seq2 = ($three ? $targ{$am}.$base : $base.$targ{$am});
         my ($md0, $md1) = getMD($seq1, $seq2, $best);
         my @lc = split("\t", $loc{$am});
@@ -294,31 +370,26 @@ foreach my $am (sort keys %seq) {
           printf OUT "\texternal\t%.3f", $score if ($score != -1);
           print OUT "\n";
         }
-        delete $rep{$que[0]};
       }
 
       next;
     }
 
     # produce output -- info for a SAM record
-    while (my $max = findMax(%rep)) {
-      my @que = split(" ", $max); # $que[0] is sequence, $que[1] is read count
-      my @cut = split(" ", $rep{$que[0]}); # $cut[0] has in/del length
+    foreach my $que (@rep) {
+      my @cut = split(" ", $seqs->{$que}); # $cut[0] has in/del length
       my @spl = split(",", $cut[1]); # list of reads
-      my ($md0, $md1) = getMD($que[0], $targ{$am}, $best);
+      my ($md0, $md1) = getMD($que, $targ{$am}, $best);
       for (my $x = 0; $x < scalar @spl; $x++) {
-        print OUT "$spl[$x]\t$am\t$md1\t$cut[0]\t$loc{$am}\t$best\t$que[0]",
+        print OUT "$spl[$x]\t$am\t$md1\t$cut[0]\t$loc{$am}\t$best\t$que",
           "\t$qual{$spl[$x]}\t$md0";
         printf OUT "\texternal\t%.3f", $score if ($score != -1);
         print OUT "\n";
       }
-      delete $rep{$que[0]};
     }
   }
+  delete $seq{$am};
 }
-close OUT;
-close LOG if (scalar @ARGV > 4);
-close GEN if (scalar @ARGV > 5);
 
 # produce MD flag
 sub getMD {
@@ -362,7 +433,9 @@ sub getMD {
   return $md, $sub;
 }
 
-# align sequences -- return cigar(s)
+# align sequences -- return cigar(s); the mismatches with the
+#   gap at a position are those before it (sequences aligned at
+#   their 5' ends) plus those after it (aligned at 3' ends)
 sub alignSeq {
   my $que = $_[0];
   my $ref = $_[1];
@@ -375,54 +448,33 @@ sub alignSeq {
     $que = $ref;
     $ref = $temp;
   }
+  my $len = length $que;
+  my $five = $que ^ substr($ref, 0, $len);      # mismatches are non-null
+  my $three = $que ^ substr($ref, $gap, $len);
+  my $mis = ($three =~ tr/\0//c);  # mismatches with gap at 5' end
 
   my $maxscore = -1000;  # best alignment score (actual max. is 0)
   my $cig = "";   # best alignment cigar
 
   # check each position -- $x is 5' end of gap
-  for (my $x = 0; $x < 1 + length $que; $x++) {
-    my $score = 0;
-    my $rpos = 0;
-    my $flag = 0;
-    for (my $y = 0; $y < length $que; $y++) {
-      $rpos += $gap if ($y == $x);
-      if (substr($que, $y, 1) ne substr($ref, $rpos + $y, 1)) {
-        if (--$score < $maxscore) {
-          $flag = 1;
-          last;
-        }
-      }
+  for (my $x = 0; $x < 1 + $len; $x++) {
+    if ($x) {
+      $mis++ if (vec($five, $x - 1, 8));
+      $mis-- if (vec($three, $x - 1, 8));
     }
 
     # save cigar
-    if ($flag) {
-      next;
-    } elsif ($score == $maxscore) {
-      $cig .= " ${x}M$gap" . ($ins ? "I" : "D") . ((length $que) - $x) . "M";
-    } else {
-      $maxscore = $score;
-      $cig = "${x}M$gap" . ($ins ? "I" : "D") . ((length $que) - $x) . "M";
+    if (-$mis == $maxscore) {
+      $cig .= " ${x}M$gap" . ($ins ? "I" : "D") . ($len - $x) . "M";
+    } elsif (-$mis > $maxscore) {
+      $maxscore = -$mis;
+      $cig = "${x}M$gap" . ($ins ? "I" : "D") . ($len - $x) . "M";
     }
   }
 
   return "$maxscore $cig";
 }
 
-# find sequence in hash with the most reads
-sub findMax {
-  my %hash = @_;
-  my $max = 0;
-  my $seq = "";
-  foreach my $key (sort keys %hash) {
-    my @spl = split(",", $hash{$key});
-    if (scalar @spl > $max) {
-      $max = scalar @spl;
-      $seq = $key;
-    }
-  }
-  return $max ? "$seq $max" : "";
-}
-
 # score alignment -- no in/dels allowed
 # weighting function (from 5' end):
 #   bases before last 20: 1
@@ -0,0 +1,770 @@
+/*
+  October 2026
+
+  Counting the pileup of filtered alignments over the
+    amplicons, without sorting: the reference positions of
+    the amplicons (from the primers file of getPrimers.pl
+    and the BED file) are held in dense arrays, and each
+    SAM record is added as it is read.
+  Counts match those of 'samtools mpileup -B -Q 0' (no
+    depth limit): records that are unmapped, secondary,
+    QC failures, or duplicates are skipped, deletions are
+    counted in the depth (with the quality score of the
+    following base), and an in/del is attached to the
+    preceding base.
+  The pileup file (for VarScan) lists the bases of each
+    column grouped by allele and strand, with the average
+    quality score of each group (split at the min. quality,
+    so counts at that threshold are unchanged). The table
+    of counts gives the depth, the depth at the min.
+    quality, and the allele and in/del counts at the min.
+    quality (for makeVCF.pl).
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <stdint.h>
+#include "panel.h"
+#include "ampPileup.h"
+
+// global variables
+static Amplicon* amp;
+static int nAmp;
+static Region* reg;
+static int nReg;
+static Chrom* chrom;
+static int nChrom;
+
+/* void usage()
+ * Prints usage information.
+ */
+void usage(void) {
+  fprintf(stderr, "Usage: ./ampPileup {%s <file> %s <file> ", INFILE, PRIMFILE);
+  fprintf(stderr, "%s <file> %s <file>} [optional parameters]\n", BEDFILE, OUTFILE);
+  fprintf(stderr, "Required parameters:\n");
+  fprintf(stderr, "  %s <file>   Input SAM file (need not be sorted; can use '-'\n", INFILE);
+  fprintf(stderr, "                for stdin)\n");
+  fprintf(stderr, "  %s <file>   File listing primer and target sequences (produced\n", PRIMFILE);
+  fprintf(stderr, "                by getPrimers.pl), or a panel bundle (made by\n");
+  fprintf(stderr, "                buildPanel), which gives the locations as well\n");
+  fprintf(stderr, "  %s <file>   BED file listing locations of primers (optional\n", BEDFILE);
+  fprintf(stderr, "                with a bundle: checked to be its source)\n");
+  fprintf(stderr, "  %s <file>   Output pileup file (as samtools mpileup, for VarScan)\n", OUTFILE);
+  fprintf(stderr, "Optional parameters:\n");
+  fprintf(stderr, "  %s <file>   Output table of counts (for makeVCF.pl)\n", TABFILE);
+  fprintf(stderr, "  %s <file>   Output SAM file for records outside the amplicons\n", UNFILE);
+  fprintf(stderr, "  %s <int>    Min. quality score to count a base (as VarScan's\n", MINQUAL);
+  fprintf(stderr, "                '--min-avg-qual'; def. %d)\n", DEFQUAL);
+  fprintf(stderr, "  %s         Option to print counts of records to stdout\n", VERBOSE);
+  exit(-1);
+}
+
+/* int error()
+ * Prints an error message.
+ */
+int error(char* msg, int err) {
+  char* msg2;
+  if (err == ERROPEN) msg2 = MERROPEN;
+  else if (err == ERRCLOSE) msg2 = MERRCLOSE;
+  else if (err == ERROPENW) msg2 = MERROPENW;
+  else if (err == ERRMEM) msg2 = MERRMEM;
+  else if (err == ERRPARAM) msg2 = MERRPARAM;
+  else if (err == ERRINT) msg2 = MERRINT;
+  else if (err == ERRPRIM) msg2 = MERRPRIM;
+  else if (err == ERRBED) msg2 = MERRBED;
+  else if (err == ERRAMP) msg2 = MERRAMP;
+  else if (err == ERRSAM) msg2 = MERRSAM;
+  else msg2 = DEFERR;
+
+  fprintf(stderr, "Error! %s%s\n", msg, msg2);
+  return -1;
+}
+
+/* void* memalloc()
+ * Allocates a heap block.
+ */
+void* memalloc(size_t size) {
+  void* ans = malloc(size);
+  if (ans == NULL)
+    exit(error("", ERRMEM));
+  return ans;
+}
+
+/* int getInt(char*)
+ * Converts the given char* to an int.
+ */
+int getInt(char* in) {
+  char* endptr;
+  int ans = (int) strtol(in, &endptr, 10);
+  if (*endptr != '\0')
+    exit(error(in, ERRINT));
+  return ans;
+}
+
+/* char* saveStr()
+ * Returns a heap copy of the first 'len' chars of a string.
+ */
+char* saveStr(char* str, int len) {
+  char* ans = (char*) memalloc(len + 1);
+  memcpy(ans, str, len);
+  ans[len] = '\0';
+  return ans;
+}
+
+/* int getChrom()
+ * Returns the index of a chromosome (-1 if not found;
+ *   added if 'add' is set).
+ */
+int getChrom(char* name, int len, int add) {
+  static int last = 0;
+  if (last < nChrom && !strncmp(chrom[last].name, name, len) &&
+      chrom[last].name[len] == '\0')
+    return last;
+  for (int i = 0; i < nChrom; i++)
+    if (!strncmp(chrom[i].name, name, len) && chrom[i].name[len] == '\0')
+      return last = i;
+  if (!add)
+    return -1;
+  chrom = (Chrom*) realloc(chrom, (nChrom + 1) * sizeof(Chrom));
+  if (chrom == NULL)
+    exit(error("", ERRMEM));
+  chrom[nChrom].name = saveStr(name, len);
+  chrom[nChrom].rank = -1;
+  return last = nChrom++;
+}
+
+/* int ampCmp()
+ * Compares amplicons by name (for qsort/bsearch).
+ */
+int ampCmp(const void* a, const void* b) {
+  return strcmp(((Amplicon*) a)->name, ((Amplicon*) b)->name);
+}
+
+/* int posCmp()
+ * Compares amplicons by position (for qsort).
+ */
+int posCmp(const void* a, const void* b) {
+  Amplicon* x = (Amplicon*) a, *y = (Amplicon*) b;
+  if (x->chr != y->chr)
+    return x->chr - y->chr;
+  return x->st - y->st;
+}
+
+/* void setPos()
+ * Sets the position of an amplicon from a line of the
+ *   BED file (for one of its primers).
+ */
+void setPos(Amplicon* a, char* chr, int s, int e) {
+  if (a->chr == -1) {
+    a->chr = getChrom(chr, strlen(chr), 1);
+    a->st = s;
+    a->end = e;
+  } else {
+    if (s < a->st)
+      a->st = s;
+    else
+      a->end = e;
+    if (a->end - a->st != a->len) {
+      fprintf(stderr, "Warning! Skipping amplicon %s -- length in BED file "
+        "does not match sequences\n", a->name);
+      a->chr = -1;
+    }
+    a->end = -2;   // both primers loaded
+  }
+}
+
+/* void loadAmps()
+ * Loads the amplicon sequences from the primers file
+ *   and their positions from the BED file.
+ */
+void loadAmps(FILE* prim, FILE* bed) {
+  char* line = (char*) memalloc(MAX_SIZE);
+  int max = 0;
+  while (fgets(line, MAX_SIZE, prim) != NULL) {
+    if (line[0] == '#' || line[0] == '\n' || line[0] == '\r')
+      continue;
+    char* name = strtok(line, CSV);
+    char* fwd = strtok(NULL, CSV);
+    char* rev = strtok(NULL, CSV);
+    char* seq = strtok(NULL, DEL);
+    if (name == NULL || fwd == NULL || rev == NULL || seq == NULL)
+      exit(error(name == NULL ? "" : name, ERRPRIM));
+    if (nAmp == max) {
+      max = max ? 2 * max : 64;
+      amp = (Amplicon*) realloc(amp, max * sizeof(Amplicon));
+      if (amp == NULL)
+        exit(error("", ERRMEM));
+    }
+    Amplicon* a = amp + nAmp++;
+    a->name = saveStr(name, strlen(name));
+    a->len = strlen(fwd) + strlen(seq) + strlen(rev);
+    a->seq = (char*) memalloc(a->len + 1);
+    strcpy(a->seq, fwd);
+    strcat(a->seq, seq);
+    strcat(a->seq, rev);
+    for (int i = 0; i < a->len; i++)
+      a->seq[i] = toupper(a->seq[i]);
+    a->chr = a->st = -1;
+  }
+  qsort(amp, nAmp, sizeof(Amplicon), ampCmp);
+
+  // positions: from start of first primer to end of second
+  while (fgets(line, MAX_SIZE, bed) != NULL) {
+    if (line[0] == '#' || line[0] == '\n' || line[0] == '\r' ||
+        !strncmp(line, "track", 5) || !strncmp(line, "browser", 7))
+      continue;
+    char* chr = strtok(line, "\t");
+    char* st = strtok(NULL, "\t");
+    char* end = strtok(NULL, "\t");
+    char* name = strtok(NULL, "\t\n\r");
+    if (name == NULL)
+      exit(error(chr, ERRBED));
+    Amplicon key;
+    key.name = name;
+    Amplicon* a = (Amplicon*) bsearch(&key, amp, nAmp,
+      sizeof(Amplicon), ampCmp);
+    if (a == NULL)
+      continue;
+    setPos(a, chr, getInt(st), getInt(end));
+  }
+  free(line);
+}
+
+/* void loadPanel()
+ * Loads the amplicon sequences and their positions from
+ *   a panel bundle (buildPanel), checking the BED file
+ *   (if given) to be its source.
+ */
+void loadPanel(char* file, char* bedFile) {
+  Panel pn;
+  openPanel(file, &pn);
+  if (bedFile != NULL)
+    checkPanelSrc(&pn, PNLBED, bedFile);
+  nAmp = pn.head->nAmp;
+  amp = (Amplicon*) memalloc(nAmp * sizeof(Amplicon));
+  for (int i = 0; i < nAmp; i++) {
+    PnlAmp* p = pn.amp + pn.byName[i];
+    Amplicon* a = amp + i;
+    char* fwd = pn.str + p->fwd, *rev = pn.str + p->rev,
+      *seq = pn.str + p->tgt;
+    if (! p->tgt)
+      exit(error(pn.str + p->name, ERRPRIM));
+    a->name = saveStr(pn.str + p->name, strlen(pn.str + p->name));
+    a->len = strlen(fwd) + strlen(seq) + strlen(rev);
+    a->seq = (char*) memalloc(a->len + 1);
+    strcpy(a->seq, fwd);
+    strcat(a->seq, seq);
+    strcat(a->seq, rev);
+    for (int j = 0; j < a->len; j++)
+      a->seq[j] = toupper(a->seq[j]);
+    a->chr = a->st = -1;
+    for (int j = 0; j < p->nBed; j++)
+      setPos(a, pn.str + p->chr, p->st[j], p->end[j]);
+  }
+  closePanel(&pn);
+}
+
+/* void makeRegions()
+ * Merges overlapping amplicons into regions.
+ */
+void makeRegions(void) {
+  qsort(amp, nAmp, sizeof(Amplicon), posCmp);
+  reg = (Region*) memalloc((nAmp ? nAmp : 1) * sizeof(Region));
+  nReg = 0;
+  for (int i = 0; i < nAmp; i++) {
+    Amplicon* a = amp + i;
+    if (a->chr == -1 || a->end != -2)
+      continue;
+    Region* r = reg + nReg - 1;
+    if (nReg && r->chr == a->chr && a->st <= r->st + r->len) {
+      if (a->st + a->len > r->st + r->len)
+        r->len = a->st + a->len - r->st;
+    } else {
+      r = reg + nReg++;
+      r->chr = a->chr;
+      r->st = a->st;
+      r->len = a->len;
+    }
+  }
+  if (!nReg)
+    exit(error("", ERRAMP));
+  int j = 0;
+  for (int i = 0; i < nReg; i++) {
+    Region* r = reg + i;
+    r->seq = (char*) memalloc(r->len + 1);
+    r->seq[r->len] = '\0';
+    r->col = (Col*) calloc(r->len, sizeof(Col));
+    if (r->col == NULL)
+      exit(error("", ERRMEM));
+    for ( ; j < nAmp && (amp[j].chr == -1 || amp[j].end != -2 ||
+        (amp[j].chr == r->chr && amp[j].st < r->st + r->len)); j++)
+      if (amp[j].chr != -1 && amp[j].end == -2)
+        memcpy(r->seq + amp[j].st - r->st, amp[j].seq, amp[j].len);
+  }
+}
+
+/* Region* findReg()
+ * Finds the region containing a position (NULL if none).
+ */
+Region* findReg(int chr, int pos) {
+  int lo = 0, hi = nReg - 1;
+  while (lo <= hi) {
+    int mid = (lo + hi) / 2;
+    Region* r = reg + mid;
+    if (r->chr < chr || (r->chr == chr && r->st + r->len <= pos))
+      lo = mid + 1;
+    else if (r->chr > chr || r->st > pos)
+      hi = mid - 1;
+    else
+      return r;
+  }
+  return NULL;
+}
+
+/* int allele()
+ * Returns the allele index of a base.
+ */
+int allele(char c) {
+  switch (toupper(c)) {
+    case 'A': return 0;
+    case 'C': return 1;
+    case 'G': return 2;
+    case 'T': return 3;
+  }
+  return 4;
+}
+
+/* void addIndel()
+ * Adds an in/del to a column.
+ */
+void addIndel(Col* c, char* seq, int all, int strand, int pass, int q) {
+  Indel* d;
+  for (d = c->ind; d != NULL; d = d->next)
+    if (d->all == all && d->strand == strand && d->pass == pass &&
+        !strcmp(d->seq, seq))
+      break;
+  if (d == NULL) {
+    d = (Indel*) memalloc(sizeof(Indel));
+    d->seq = saveStr(seq, strlen(seq));
+    d->all = all;
+    d->strand = strand;
+    d->pass = pass;
+    d->cnt = 0;
+    d->qual = 0;
+    d->next = c->ind;
+    c->ind = d;
+  }
+  d->cnt++;
+  d->qual += q;
+}
+
+/* int addRecord()
+ * Adds the bases of a SAM record to the pileup. Returns
+ *   the number of bases in the regions.
+ */
+int addRecord(int chr, int pos, char* cigar, char* seq, char* qual,
+    int strand, int minQual, char* buf) {
+  int len = strlen(seq);
+  int noQual = !strcmp(qual, "*");
+  Region* r = NULL;
+  int count = 0;
+  int i = 0;  // position in read
+  for (char* c = cigar; *c != '\0'; ) {
+    char* end;
+    int n = (int) strtol(c, &end, 10);
+    char op = *end;
+    if (end == c || op == '\0')
+      return -1;
+    c = end + 1;
+
+    if (op == 'M' || op == '=' || op == 'X' || op == 'D') {
+      // in/del following this block
+      int nLen = 0;
+      char nOp = '\0';
+      if (op != 'D') {
+        nLen = (int) strtol(c, &end, 10);
+        nOp = *end;
+      }
+      for (int k = 0; k < n; k++, pos++) {
+        if (r == NULL || pos < r->st || pos >= r->st + r->len)
+          r = findReg(chr, pos);
+        int qi = (op == 'D' ? i : i++);
+        if (op == 'D' && qi == len && len)
+          qi--;  // deletion at end of read
+        if (qi >= len)
+          return -1;
+        if (r == NULL)
+          continue;
+        int q = noQual ? 0 : qual[qi] - OFFSET;
+        if (q > MAXQUAL)
+          q = MAXQUAL;
+        int pass = (q >= minQual);
+        int all = (op == 'D' ? ALLDEL : allele(seq[qi]));
+        Col* col = r->col + pos - r->st;
+        col->cnt[all][strand][pass]++;
+        col->qual[all][strand][pass] += q;
+        count++;
+
+        if (op != 'D' && k == n - 1 && (nOp == 'I' || nOp == 'D')) {
+          int m = sprintf(buf, "%c%d", nOp == 'I' ? '+' : '-', nLen);
+          for (int j = 0; j < nLen; j++) {
+            char b;
+            if (nOp == 'I')
+              b = (i + j < len ? seq[i + j] : 'N');
+            else {
+              int p = pos + 1 + j - r->st;
+              b = (p < r->len ? r->seq[p] : 'N');
+            }
+            buf[m++] = strand ? tolower(b) : toupper(b);
+          }
+          buf[m] = '\0';
+          addIndel(col, buf, all, strand, pass, q);
+        }
+      }
+    } else if (op == 'I' || op == 'S')
+      i += n;
+    else if (op == 'N')
+      pos += n;
+  }
+  return count;
+}
+
+/* void printCol()
+ * Prints a pileup line (if the column has coverage) and a
+ *   line of the table of counts.
+ */
+void printCol(FILE* out, FILE* tab, char* chr, int pos, char ref,
+    Col* c, char* bases, char* quals) {
+  int depth = 0, qdepth = 0;
+  int b = 0, q = 0;
+  for (int all = 0; all < NALL; all++)
+    for (int s = 0; s < 2; s++)
+      for (int p = 0; p < 2; p++) {
+        int n = c->cnt[all][s][p];
+        if (!n)
+          continue;
+        depth += n;
+        if (p)
+          qdepth += n;
+        long long qsum = c->qual[all][s][p];
+
+        // bases with in/dels
+        for (Indel* d = c->ind; d != NULL; d = d->next)
+          if (d->all == all && d->strand == s && d->pass == p) {
+            char ch = (all == ALLDEL ? '*' : ALLELES[all] == ref ?
+              (s ? ',' : '.') : (s ? tolower(ALLELES[all]) : ALLELES[all]));
+            int dq = (int) (d->qual / d->cnt) + OFFSET;
+            for (int k = 0; k < d->cnt; k++) {
+              bases[b++] = ch;
+              b += sprintf(bases + b, "%s", d->seq);
+              quals[q++] = dq;
+            }
+            n -= d->cnt;
+            qsum -= d->qual;
+          }
+
+        // other bases
+        if (n) {
+          char ch = (all == ALLDEL ? '*' : ALLELES[all] == ref ?
+            (s ? ',' : '.') : (s ? tolower(ALLELES[all]) : ALLELES[all]));
+          int aq = (int) (qsum / n) + OFFSET;
+          memset(bases + b, ch, n);
+          memset(quals + q, aq, n);
+          b += n;
+          q += n;
+        }
+      }
+  if (!depth)
+    return;
+  bases[b] = quals[q] = '\0';
+  fprintf(out, "%s\t%d\t%c\t%d\t%s\t%s\n", chr, pos + 1, ref, depth,
+    bases, quals);
+
+  if (tab == NULL)
+    return;
+  fprintf(tab, "%s\t%d\t%c\t%d\t%d", chr, pos + 1, ref, depth, qdepth);
+  for (int all = 0; all < NALL; all++)
+    fprintf(tab, "\t%d", c->cnt[all][0][1] + c->cnt[all][1][1]);
+
+  // in/dels at min. quality (both strands)
+  int first = 1;
+  for (Indel* d = c->ind; d != NULL; d = d->next) {
+    if (!d->pass || d->cnt < 0)
+      continue;
+    int n = 0;
+    for (Indel* e = d; e != NULL; e = e->next)
+      if (e->pass && e->cnt >= 0 && !strcasecmp(e->seq, d->seq)) {
+        n += e->cnt;
+        if (e != d)
+          e->cnt = -1;  // counted
+      }
+    fprintf(tab, "%c", first ? '\t' : ',');
+    for (char* s = d->seq; *s != '\0'; s++)
+      if (!isdigit(*s))
+        fputc(toupper(*s), tab);
+    fprintf(tab, ":%d", n);
+    first = 0;
+  }
+  fprintf(tab, "%s\n", first ? "\t." : "");
+}
+
+/* int rankCmp()
+ * Compares regions by rank of chromosome in the SAM
+ *   header, then position (for qsort).
+ */
+int rankCmp(const void* a, const void* b) {
+  Region* x = (Region*) a, *y = (Region*) b;
+  int rx = chrom[x->chr].rank, ry = chrom[y->chr].rank;
+  if (rx != ry)
+    return rx == -1 ? 1 : ry == -1 ? -1 : rx - ry;
+  if (x->chr != y->chr)
+    return x->chr - y->chr;
+  return x->st - y->st;
+}
+
+/* void printOutput()
+ * Prints the pileup and the table of counts, in the
+ *   order of the chromosomes in the SAM header.
+ */
+void printOutput(FILE* out, FILE* tab) {
+  if (tab != NULL)
+    fprintf(tab, "%s\n", TABHEAD);
+  Region* sorted = (Region*) memalloc(nReg * sizeof(Region));
+  memcpy(sorted, reg, nReg * sizeof(Region));
+  qsort(sorted, nReg, sizeof(Region), rankCmp);
+
+  // buffers for the longest column
+  int max = 0;
+  for (int i = 0; i < nReg; i++)
+    for (int j = 0; j < sorted[i].len; j++) {
+      Col* c = sorted[i].col + j;
+      int n = 0;
+      for (int all = 0; all < NALL; all++)
+        for (int s = 0; s < 2; s++)
+          n += c->cnt[all][s][0] + c->cnt[all][s][1];
+      for (Indel* d = c->ind; d != NULL; d = d->next)
+        n += d->cnt * strlen(d->seq);
+      if (n > max)
+        max = n;
+    }
+  char* bases = (char*) memalloc(max + 1);
+  char* quals = (char*) memalloc(max + 1);
+
+  for (int i = 0; i < nReg; i++) {
+    Region* r = sorted + i;
+    for (int j = 0; j < r->len; j++)
+      printCol(out, tab, chrom[r->chr].name, r->st + j, r->seq[j],
+        r->col + j, bases, quals);
+  }
+  free(bases);
+  free(quals);
+  free(sorted);
+}
+
+/* void readFile()
+ * Adds the SAM records to the pileup.
+ */
+void readFile(FILE* in, FILE* un, int minQual, int verbose) {
+  char* line = NULL;
+  size_t size = 0;
+  ssize_t len;
+  char* buf = NULL;
+  int bufSize = 0;
+  int rank = 0;
+  long long count = 0, skip = 0, off = 0;
+  while ((len = getline(&line, &size, in)) != -1) {
+    if (line[0] == '@') {
+      // save order of chromosomes
+      if (!strncmp(line, "@SQ\t", 4)) {
+        char* sn = strstr(line, "\tSN:");
+        if (sn != NULL) {
+          int chr = getChrom(sn + 4, strcspn(sn + 4, "\t\r\n"), 0);
+          if (chr != -1 && chrom[chr].rank == -1)
+            chrom[chr].rank = rank;
+          rank++;
+        }
+      }
+      if (un != NULL)
+        fprintf(un, "%s", line);
+      continue;
+    }
+
+    // split fields
+    char* field[11];
+    char term[11];
+    char* p = line;
+    for (int f = 0; f < 11; f++) {
+      field[f] = p;
+      p += strcspn(p, "\t\r\n");
+      term[f] = *p;
+      if (f < 10 && *p != '\t')
+        exit(error(line, ERRSAM));
+      *p++ = '\0';
+    }
+    int flag = getInt(field[1]);
+    if (flag & SKIPFLAG) {
+      skip++;
+      continue;
+    }
+    if (len + 16 > bufSize) {
+      bufSize = len + 16;
+      buf = (char*) realloc(buf, bufSize);
+      if (buf == NULL)
+        exit(error("", ERRMEM));
+    }
+
+    int chr = getChrom(field[2], strlen(field[2]), 0);
+    int n = 0;
+    if (chr != -1) {
+      n = addRecord(chr, getInt(field[3]) - 1, field[5], field[9],
+        field[10], (flag & REVFLAG) != 0, minQual, buf);
+      if (n < 0)
+        exit(error(field[0], ERRSAM));
+    }
+    if (n)
+      count++;
+    else {
+      off++;
+      if (un != NULL) {
+        // restore line
+        for (int i = 0; i < 11; i++)
+          field[i][strlen(field[i])] = term[i];
+        fprintf(un, "%s", line);
+      }
+    }
+  }
+  if (verbose)
+    printf("Records in amplicons: %lld\nRecords outside amplicons: %lld\n"
+      "Records skipped (unmapped, secondary, etc.): %lld\n",
+      count, off, skip);
+  free(buf);
+  free(line);
+}
+
+/* FILE* openRead()
+ * Opens a file for reading.
+ */
+FILE* openRead(char* inFile) {
+  if (!strcmp(inFile, "-"))
+    return stdin;
+  FILE* in = fopen(inFile, "r");
+  if (in == NULL)
+    exit(error(inFile, ERROPEN));
+  return in;
+}
+
+/* FILE* openWrite()
+ * Opens a file for writing.
+ */
+FILE* openWrite(char* outFile) {
+  FILE* out = fopen(outFile, "w");
+  if (out == NULL)
+    exit(error(outFile, ERROPENW));
+  return out;
+}
+
+/* void freeMemory()
+ * Frees the amplicons and regions.
+ */
+void freeMemory(void) {
+  for (int i = 0; i < nAmp; i++) {
+    free(amp[i].name);
+    free(amp[i].seq);
+  }
+  free(amp);
+  for (int i = 0; i < nReg; i++) {
+    for (int j = 0; j < reg[i].len; j++)
+      for (Indel* d = reg[i].col[j].ind; d != NULL; ) {
+        Indel* temp = d;
+        d = d->next;
+        free(temp->seq);
+        free(temp);
+      }
+    free(reg[i].col);
+    free(reg[i].seq);
+  }
+  free(reg);
+  for (int i = 0; i < nChrom; i++)
+    free(chrom[i].name);
+  free(chrom);
+}
+
+/* void getParams()
+ * Gets command-line parameters.
+ */
+void getParams(int argc, char** argv) {
+
+  char* inFile = NULL, *primFile = NULL, *bedFile = NULL,
+    *outFile = NULL, *tabFile = NULL, *unFile = NULL;
+  int minQual = DEFQUAL, verbose = 0;
+
+  // parse argv
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], HELP))
+      usage();
+    else if (!strcmp(argv[i], VERBOSE))
+      verbose = 1;
+    else if (i < argc - 1) {
+      if (!strcmp(argv[i], INFILE))
+        inFile = argv[++i];
+      else if (!strcmp(argv[i], PRIMFILE))
+        primFile = argv[++i];
+      else if (!strcmp(argv[i], BEDFILE))
+        bedFile = argv[++i];
+      else if (!strcmp(argv[i], OUTFILE))
+        outFile = argv[++i];
+      else if (!strcmp(argv[i], TABFILE))
+        tabFile = argv[++i];
+      else if (!strcmp(argv[i], UNFILE))
+        unFile = argv[++i];
+      else if (!strcmp(argv[i], MINQUAL))
+        minQual = getInt(argv[++i]);
+      else
+        exit(error(argv[i], ERRPARAM));
+    } else
+      exit(error(argv[i], ERRPARAM));
+  }
+
+  if (inFile == NULL || primFile == NULL || outFile == NULL)
+    usage();
+
+  // load amplicons (from a panel bundle, or primers and BED files)
+  if (isPanel(primFile))
+    loadPanel(primFile, bedFile);
+  else {
+    if (bedFile == NULL)
+      usage();
+    FILE* prim = openRead(primFile);
+    FILE* bed = openRead(bedFile);
+    loadAmps(prim, bed);
+    if (fclose(prim) || fclose(bed))
+      exit(error("", ERRCLOSE));
+  }
+  makeRegions();
+
+  // count pileup, print output
+  FILE* in = openRead(inFile);
+  FILE* un = (unFile == NULL ? NULL : openWrite(unFile));
+  readFile(in, un, minQual, verbose);
+  FILE* out = openWrite(outFile);
+  FILE* tab = (tabFile == NULL ? NULL : openWrite(tabFile));
+  printOutput(out, tab);
+
+  if ((in != stdin && fclose(in)) || fclose(out) ||
+      (un != NULL && fclose(un)) || (tab != NULL && fclose(tab)))
+    exit(error("", ERRCLOSE));
+  freeMemory();
+}
+
+/* int main()
+ * Main.
+ */
+int main(int argc, char* argv[]) {
+  getParams(argc, argv);
+  return 0;
+}
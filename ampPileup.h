@@ -0,0 +1,98 @@
+/*
+  October 2026
+
+  Header file for ampPileup.c.
+*/
+
+#define MAX_SIZE    1024   // maximum length for input line (primers, BED)
+#define OFFSET      33     // ASCII-based offset of quality scores
+#define MAXQUAL     93     // max. quality score printed (as samtools)
+#define CSV         ",\t"  // delimiters of primers file
+#define DEL         ",\t\n\r"
+#define TABHEAD     "#Chrom\tPos\tRef\tDepth\tQDepth\tA\tC\tG\tT\tN\tDel\tIndels"
+
+// command-line parameters
+#define HELP        "-h"
+#define INFILE      "-i"
+#define PRIMFILE    "-p"
+#define BEDFILE     "-b"
+#define OUTFILE     "-o"   // pileup (for VarScan)
+#define TABFILE     "-c"   // table of counts (for makeVCF.pl)
+#define UNFILE      "-u"   // SAM records outside the amplicons
+#define MINQUAL     "-q"
+#define VERBOSE     "-ve"  // option to print counts to stdout
+
+// default parameter values
+#define DEFQUAL     15
+
+// SAM flags of records skipped (as samtools mpileup):
+//   unmapped, secondary, QC failure, duplicate
+#define SKIPFLAG    0x704
+#define UNMAPPED    0x4
+#define REVFLAG     0x10
+
+// alleles of a pileup column
+#define NALL        6
+#define ALLDEL      5      // index of deletion ('*')
+#define ALLELES     "ACGTN*"
+
+// error messages
+#define ERROPEN     0
+#define MERROPEN    ": cannot open file for reading"
+#define ERRCLOSE    1
+#define MERRCLOSE   "Cannot close file"
+#define ERROPENW    2
+#define MERROPENW   ": cannot open file for writing"
+#define ERRMEM      3
+#define MERRMEM     "Cannot allocate memory"
+#define ERRPARAM    4
+#define MERRPARAM   ": unknown command-line parameter"
+#define ERRINT      5
+#define MERRINT     ": cannot convert to int"
+#define ERRPRIM     6
+#define MERRPRIM    ": cannot load primer and target sequences"
+#define ERRBED      7
+#define MERRBED     ": improperly formatted line in BED file"
+#define ERRAMP      8
+#define MERRAMP     "No amplicons with sequences and BED positions"
+#define ERRSAM      9
+#define MERRSAM     ": improperly formatted SAM record"
+#define DEFERR      "Unknown error"
+
+typedef struct indel {
+  char* seq;         // as in pileup (e.g. "+2AC", "-1g")
+  int all;           // allele of the preceding base
+  int strand;
+  int pass;          // quality of the preceding base >= min.
+  int cnt;
+  long long qual;    // sum of quality scores (of preceding base)
+  struct indel* next;
+} Indel;
+
+typedef struct col {
+  int cnt[NALL][2][2];        // counts by allele, strand, and
+  long long qual[NALL][2][2]; //   quality >= min.; sums of scores
+  Indel* ind;
+} Col;
+
+typedef struct amplicon {
+  char* name;
+  char* seq;         // fwd primer, target, rev primer
+  int len;
+  int chr;           // index of chromosome (-1 = not in BED)
+  int st;            // 0-based position (-1 = not in BED)
+  int end;           // (first primer in BED, until both loaded)
+} Amplicon;
+
+typedef struct region {
+  int chr;           // index of chromosome
+  int st;            // 0-based start
+  int len;
+  char* seq;         // reference sequence
+  Col* col;          // pileup columns
+} Region;
+
+typedef struct chrom {
+  char* name;
+  int rank;          // order in SAM header (-1 = not listed)
+} Chrom;
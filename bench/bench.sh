@@ -0,0 +1,74 @@
+#!/bin/bash
+
+# Oct. 2026
+
+# Benchmark stitch, removePrimer, and qualTrim: microbenchmarks
+#   of the kernels and the FASTQ reader, then end-to-end runs
+#   with 1 or more processes (shards, -sh), on reads generated
+#   by genReads (deterministic, given the seed).
+# Usage: bash bench/bench.sh  [<reads>  <amplicons>  "<threads>"  <seed>]
+#   (run from the repository directory, after "make bench")
+
+reads=${1:-200000}
+amps=${2:-100}
+threads=${3:-"1 2 4"}
+seed=${4:-1}
+
+dir=$(mktemp -d "${TMPDIR:-/tmp}/ampliconBench.XXXXXX")
+trap 'rm -rf "$dir"' EXIT
+
+# generate reads
+bench/genReads -a $amps -r $dir/ref.fa -b $dir/amp.bed \
+  -p $dir/primers.txt -n $reads -s $seed \
+  -1 $dir/r1.fq -2 $dir/r2.fq || exit 1
+./stitch -1 $dir/r1.fq -2 $dir/r2.fq -o $dir/st.fq || exit 1
+echo "Reads: $reads PE, $amps amplicons, seed $seed"
+echo
+
+# microbenchmarks, with each variant of the SIMD kernels
+#   that this CPU supports
+echo "Kernels:"
+echo -e "Program\tSIMD\tKernel\tCalls\tSec\tCalls/sec\tMB/sec"
+for v in scalar sse4.2 avx2 avx512bw; do
+  AMPSIMD=$v ./stitch -h 2>&1 | grep -q "not supported" && continue
+  export AMPSIMD=$v
+  bench/benchStitch $dir/r1.fq $dir/r2.fq || exit 1
+  bench/benchRemovePrimer $dir/st.fq $dir/primers.txt || exit 1
+  bench/benchQualTrim $dir/r1.fq || exit 1
+done
+unset AMPSIMD
+echo
+
+# end-to-end: <threads> shards run in parallel
+#   (MB/sec is of input, read counts are of the whole input)
+run() {
+  local tool=$1 n=$2 bytes=$3
+  shift 3
+  local st=$(date +%s.%N)
+  for ((i = 1; i <= n; i++)); do
+    local cmd=${@//SHARD/$i}
+    if [ $n -gt 1 ]; then
+      $cmd -sh $i/$n &
+    else
+      $cmd &
+    fi
+  done
+  wait
+  local end=$(date +%s.%N)
+  awk -v t=$tool -v n=$n -v r=$reads -v b=$bytes -v s=$st -v e=$end \
+    'BEGIN { sec = e - s; printf "%s\t%d\t%d\t%.3f\t%.0f\t%.1f\n",
+      t, n, r, sec, r / sec, b / sec / 1e6 }'
+}
+
+echo "End-to-end:"
+echo -e "Program\tThreads\tReads\tSec\tReads/sec\tMB/sec"
+in1=$(( $(wc -c < $dir/r1.fq) + $(wc -c < $dir/r2.fq) ))
+in2=$(wc -c < $dir/st.fq)
+in3=$(wc -c < $dir/r1.fq)
+for n in $threads; do
+  run stitch $n $in1 ./stitch -1 $dir/r1.fq -2 $dir/r2.fq -o $dir/out.SHARD.fq
+  run removePrimer $n $in2 ./removePrimer -i $dir/st.fq -p $dir/primers.txt \
+    -o $dir/out.SHARD.fq
+  run qualTrim $n $in3 ./qualTrim -i $dir/r1.fq -o $dir/out.SHARD.fq \
+    -l 5 -q 30
+done
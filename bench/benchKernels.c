@@ -0,0 +1,246 @@
+/*
+  October 2026
+
+  Microbenchmarks of the kernels and the FASTQ reader of
+    stitch, removePrimer, or qualTrim, whichever this is
+    compiled with (-DBENCH_STITCH, -DBENCH_REMOVEPRIMER,
+    or -DBENCH_QUALTRIM; see the Makefile). The program's
+    source is included directly, so the functions timed
+    are the ones the program runs.
+  Prints a tab-delimited line per kernel: program, variant
+    of the SIMD kernels (AMPSIMD), kernel, calls, seconds,
+    calls/sec, and MB/sec (of sequence or quality scores
+    analyzed).
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#define main toolMain
+#if defined(BENCH_STITCH)
+#include "../stitch.c"
+#define TOOL        "stitch"
+#elif defined(BENCH_REMOVEPRIMER)
+#include "../removePrimer.c"
+#define TOOL        "removePrimer"
+#else
+#include "../qualTrim.c"
+#define TOOL        "qualTrim"
+#endif
+#undef main
+
+#include <time.h>
+
+#define BENCHSEC    0.5     // min. seconds to run each kernel
+#define BENCHMAX    4000000 // max. reads to load
+
+typedef struct benchRead {
+  char* seq;
+  char* qual;
+  int len;
+} BenchRead;
+
+static volatile long benchSink;  // keeps results from being optimized away
+
+/* double benchTime()
+ * Returns the current (monotonic) time in seconds.
+ */
+double benchTime(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* void benchReport()
+ * Prints the results for a kernel.
+ */
+void benchReport(char* kernel, long calls, double bytes, double sec) {
+  printf("%s\t%s\t%s\t%ld\t%.3f\t%.0f\t%.1f\n", TOOL, simd.name, kernel,
+    calls, sec, calls / sec, bytes / sec / 1e6);
+}
+
+// runs 'body' over reads [0, n) until BENCHSEC has passed
+#define BENCH_LOOP(kernel, n, bytesPerPass, body) do { \
+    long calls_ = 0; int reps_ = 0; \
+    double st_ = benchTime(), sec_; \
+    do { \
+      for (int i = 0; i < (n); i++) { body; } \
+      calls_ += (n); reps_++; \
+    } while ((sec_ = benchTime() - st_) < BENCHSEC); \
+    benchReport(kernel, calls_, (double) (bytesPerPass) * reps_, sec_); \
+  } while (0)
+
+/* void benchOpen()
+ * Opens a (plain or gzip compressed) FASTQ file.
+ */
+int benchOpen(char* inFile, File* in) {
+  int len = strlen(inFile);
+  int gz = len >= strlen(GZEXT) && !strcmp(inFile + len - strlen(GZEXT), GZEXT);
+  if (gz)
+    in->gzf = gzopen(inFile, "r");
+  else
+    in->f = fopen(inFile, "r");
+  if ( (gz && in->gzf == NULL) || (! gz && in->f == NULL) ) {
+    fprintf(stderr, "Error! %s: cannot open file for reading\n", inFile);
+    exit(-1);
+  }
+  return gz;
+}
+
+/* void benchClose()
+ * Closes a FASTQ file.
+ */
+void benchClose(File in, int gz) {
+  gz ? gzclose(in.gzf) : fclose(in.f);
+}
+
+/* void benchReader()
+ * Times the reading of a FASTQ file with getLine().
+ */
+void benchReader(char* inFile) {
+  char* buf = (char*) memalloc(MAX_SIZE);
+  long calls = 0;
+  double bytes = 0.0;
+  double st = benchTime(), sec;
+  do {
+    File in;
+    int gz = benchOpen(inFile, &in);
+    while (getLine(buf, MAX_SIZE, in, gz) != NULL) {
+      bytes += strlen(buf);
+      calls++;
+    }
+    benchClose(in, gz);
+  } while ((sec = benchTime() - st) < BENCHSEC);
+  benchReport("getLine", calls, bytes, sec);
+  free(buf);
+}
+
+/* int benchLoad()
+ * Loads the reads of a FASTQ file (sequences as given, or
+ *   reverse-complemented with reversed quality scores).
+ */
+int benchLoad(char* inFile, BenchRead* r, int rev) {
+  char* buf = (char*) memalloc(MAX_SIZE);
+  char* seq = (char*) memalloc(MAX_SIZE);
+  File in;
+  int gz = benchOpen(inFile, &in);
+  int n;
+  for (n = 0; n < BENCHMAX; n++) {
+    if (getLine(buf, MAX_SIZE, in, gz) == NULL ||
+        getLine(seq, MAX_SIZE, in, gz) == NULL ||
+        getLine(buf, MAX_SIZE, in, gz) == NULL ||
+        getLine(buf, MAX_SIZE, in, gz) == NULL)
+      break;
+    int len = strcspn(seq, "\r\n");
+    r[n].len = len;
+    r[n].seq = (char*) memalloc(len + 1);
+    r[n].qual = (char*) memalloc(len + 1);
+    for (int i = 0; i < len; i++) {
+      if (rev) {
+        char b = seq[len - 1 - i];
+        r[n].seq[i] = (b == 'A' ? 'T' : b == 'T' ? 'A' :
+          b == 'C' ? 'G' : b == 'G' ? 'C' : 'N');
+        r[n].qual[i] = buf[len - 1 - i];
+      } else {
+        r[n].seq[i] = seq[i];
+        r[n].qual[i] = buf[i];
+      }
+    }
+    r[n].seq[len] = r[n].qual[len] = '\0';
+  }
+  benchClose(in, gz);
+  free(buf);
+  free(seq);
+  return n;
+}
+
+/* int main()
+ * Main.
+ */
+int main(int argc, char* argv[]) {
+  if (argc < 2 || (strcmp(TOOL, "stitch") == 0 && argc < 3) ||
+      (strcmp(TOOL, "removePrimer") == 0 && argc < 3)) {
+    fprintf(stderr, "Usage: %s <reads1.fq> [<reads2.fq> (stitch) |"
+      " <primers> (removePrimer)]\n", argv[0]);
+    return -1;
+  }
+  initSimd();
+  BenchRead* r1 = (BenchRead*) memalloc(BENCHMAX * sizeof(BenchRead));
+  int n = benchLoad(argv[1], r1, 0);
+  double bases = 0.0;
+  for (int i = 0; i < n; i++)
+    bases += r1[i].len;
+  benchReader(argv[1]);
+
+#if defined(BENCH_STITCH)
+  BenchRead* r2 = (BenchRead*) memalloc(BENCHMAX * sizeof(BenchRead));
+  if (benchLoad(argv[2], r2, 1) != n) {
+    fprintf(stderr, "Error! %s: number of reads does not match\n", argv[2]);
+    return -1;
+  }
+
+  // reverse-complement of read 2 (as getSeq loads it)
+  char* buf = (char*) memalloc(MAX_SIZE);
+  BENCH_LOOP("copyStr", n, bases, {
+    benchSink += copyStr(buf, r2[i].seq, RC);
+  });
+
+  // overlaps at a fixed offset (as findPos tests them)
+  BENCH_LOOP("compare", n, bases / 2, {
+    int len = r1[i].len < r2[i].len ? r1[i].len : r2[i].len;
+    benchSink += (long) (10 * compare(r1[i].seq + len / 2, r2[i].seq,
+      len - len / 2, DEFMISM, DEFOVER));
+  });
+  BENCH_LOOP("findPos", n, bases, {
+    float best = 1.0f;
+    benchSink += findPos(r1[i].seq, r2[i].seq, r1[i].qual, r2[i].qual,
+      r1[i].len, r2[i].len, DEFOVER, 0, DEFMISM, 1, &best);
+  });
+  BENCH_LOOP("findPos-d", n, bases, {
+    float best = 1.0f;
+    benchSink += findPos(r1[i].seq, r2[i].seq, r1[i].qual, r2[i].qual,
+      r1[i].len, r2[i].len, DEFOVER, 1, 0.1f, 1, &best);
+  });
+
+#elif defined(BENCH_REMOVEPRIMER)
+  line = (char*) memalloc(MAX_SIZE);
+  hline = (char*) memalloc(MAX_SIZE);
+  primo = NULL;
+  FILE* prim = openRead(argv[2]);
+  loadSeqs(prim);
+  fclose(prim);
+
+  // primer matches of each read (for the reverse primer kernels)
+  Primer** p = (Primer**) memalloc(n * sizeof(Primer*));
+  int* st = (int*) memalloc(n * sizeof(int));
+  int* f = (int*) memalloc(n * sizeof(int));
+  BENCH_LOOP("findPrim", n, bases, {
+    st[i] = f[i] = 0;
+    p[i] = findPrim(r1[i].seq, 0, 0, 1, st + i, f + i);
+    benchSink += st[i];
+  });
+  BENCH_LOOP("checkRevEnd", n, bases, {
+    if (p[i] != NULL)
+      benchSink += checkRevEnd(r1[i].seq, f[i] ? p[i]->frc : p[i]->rev,
+        f[i] ? p[i]->frcM : p[i]->revM, 0, 0, 1);
+  });
+  BENCH_LOOP("checkRevInt", n, bases, {
+    if (p[i] != NULL) {
+      char* rev = f[i] ? p[i]->frc : p[i]->rev;
+      int len = strlen(rev);
+      benchSink += checkRevInt(r1[i].seq, rev,
+        f[i] ? p[i]->frcM : p[i]->revM, st[i], 0, len < 10 ? len : 10);
+    }
+  });
+  freeMemory();
+
+#else
+  BENCH_LOOP("getEnd", n, bases, {
+    benchSink += getEnd(r1[i].qual, 5, 30.0f, r1[i].len);
+  });
+  BENCH_LOOP("getStart", n, bases, {
+    benchSink += getStart(r1[i].qual, 5, 30.0f, r1[i].len);
+  });
+#endif
+
+  return 0;
+}
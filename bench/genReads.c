@@ -0,0 +1,503 @@
+/*
+  October 2026
+
+  Generating paired-end amplicon reads for benchmarking.
+  Reads are simulated from the amplicons of a BED file of
+    primer locations (as for getPrimers.pl) and a reference
+    genome, or from a random panel of a given number of
+    amplicons. Sequencing errors and indels are added at
+    the given rates. The output depends only on the
+    parameters (including the seed).
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+#include "genReads.h"
+
+// global variables
+static unsigned long long state;  // random number generator
+static Chrom* chrom;
+static int nChrom;
+static Amplicon* amp;
+static int nAmp;
+
+/* void usage()
+ * Prints usage information.
+ */
+void usage(void) {
+  fprintf(stderr, "Usage: ./genReads {%s <file> %s <file> %s <file>", REFFILE, BEDFILE, OUTFILE1);
+  fprintf(stderr, " %s <file>} [optional parameters]\n", OUTFILE2);
+  fprintf(stderr, "Required parameters:\n");
+  fprintf(stderr, "  %s <file>   Fasta file of reference genome (can be gzip compressed)\n", REFFILE);
+  fprintf(stderr, "  %s <file>   BED file listing locations of primers, two per amplicon\n", BEDFILE);
+  fprintf(stderr, "                (as for getPrimers.pl)\n");
+  fprintf(stderr, "  %s <file>   Output FASTQ file for PE reads #1\n", OUTFILE1);
+  fprintf(stderr, "  %s <file>   Output FASTQ file for PE reads #2\n", OUTFILE2);
+  fprintf(stderr, "                (gzip compressed if given \"%s\" extensions)\n", GZEXT);
+  fprintf(stderr, "Optional parameters:\n");
+  fprintf(stderr, "  %s <int>    Create a random panel of <int> amplicons, written to the\n", PANEL);
+  fprintf(stderr, "                %s and %s files (instead of reading them)\n", REFFILE, BEDFILE);
+  fprintf(stderr, "  %s <file>   Output file of primer and target sequences (as from\n", PRIMFILE);
+  fprintf(stderr, "                getPrimers.pl; input for removePrimer)\n");
+  fprintf(stderr, "  %s <int>    Number of PE reads (def. %d)\n", NUMREADS, DEFREADS);
+  fprintf(stderr, "  %s <int>    Length of reads (def. %d)\n", READLEN, DEFLEN);
+  fprintf(stderr, "  %s <float>  Rate of sequencing errors, per base (def. %.4f)\n", SUBRATE, DEFSUBRATE);
+  fprintf(stderr, "  %s <float>  Rate of indels, per base of amplicon (def. %.4f)\n", INDELRATE, DEFINDEL);
+  fprintf(stderr, "  %s <int>    Seed for random number generator (def. %d)\n", SEED, DEFSEED);
+  exit(-1);
+}
+
+/* int error()
+ * Prints an error message.
+ */
+int error(char* msg, int err) {
+  char* msg2;
+  if (err == ERROPEN) msg2 = MERROPEN;
+  else if (err == ERROPENW) msg2 = MERROPENW;
+  else if (err == ERRCLOSE) msg2 = MERRCLOSE;
+  else if (err == ERRMEM) msg2 = MERRMEM;
+  else if (err == ERRINT) msg2 = MERRINT;
+  else if (err == ERRFLOAT) msg2 = MERRFLOAT;
+  else if (err == ERRPARAM) msg2 = MERRPARAM;
+  else if (err == ERRBED) msg2 = MERRBED;
+  else if (err == ERRAMP) msg2 = MERRAMP;
+  else if (err == ERRRATE) msg2 = MERRRATE;
+  else msg2 = DEFERR;
+
+  fprintf(stderr, "Error! %s%s\n", msg, msg2);
+  return -1;
+}
+
+/* void* memalloc()
+ * Allocates a heap block.
+ */
+void* memalloc(int size) {
+  void* ans = malloc(size);
+  if (ans == NULL)
+    exit(error("", ERRMEM));
+  return ans;
+}
+
+/* void* memrealloc()
+ * Resizes a heap block.
+ */
+void* memrealloc(void* ptr, int size) {
+  void* ans = realloc(ptr, size);
+  if (ans == NULL)
+    exit(error("", ERRMEM));
+  return ans;
+}
+
+/* char* copyName()
+ * Returns a heap copy of the given string.
+ */
+char* copyName(char* in) {
+  char* out = (char*) memalloc(strlen(in) + 1);
+  strcpy(out, in);
+  return out;
+}
+
+/* float getFloat(char*)
+ * Converts the given char* to a float.
+ */
+float getFloat(char* in) {
+  char* endptr;
+  float ans = strtof(in, &endptr);
+  if (*endptr != '\0')
+    exit(error(in, ERRFLOAT));
+  return ans;
+}
+
+/* int getInt(char*)
+ * Converts the given char* to an int.
+ */
+int getInt(char* in) {
+  char* endptr;
+  int ans = (int) strtol(in, &endptr, 10);
+  if (*endptr != '\0')
+    exit(error(in, ERRINT));
+  return ans;
+}
+
+/* unsigned long long nextRand()
+ * Returns the next random number (xorshift64*).
+ */
+unsigned long long nextRand(void) {
+  state ^= state >> 12;
+  state ^= state << 25;
+  state ^= state >> 27;
+  return state * 2685821657736338717ULL;
+}
+
+/* int randInt()
+ * Returns a random int in [0, n).
+ */
+int randInt(int n) {
+  return (int) ((nextRand() >> 33) % n);
+}
+
+/* double randDouble()
+ * Returns a random double in [0, 1).
+ */
+double randDouble(void) {
+  return (nextRand() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/* char randBase()
+ * Returns a random base, different from the given one.
+ */
+char randBase(char not) {
+  char b;
+  do
+    b = "ACGT"[randInt(4)];
+  while (b == not);
+  return b;
+}
+
+/* char rc(char)
+ * Returns the complement of the given base.
+ */
+char rc(char in) {
+  if (in == 'A') return 'T';
+  if (in == 'T') return 'A';
+  if (in == 'C') return 'G';
+  if (in == 'G') return 'C';
+  return 'N';
+}
+
+/* void loadRef()
+ * Loads the reference genome.
+ */
+void loadRef(char* refFile) {
+  gzFile in = gzopen(refFile, "r");
+  if (in == NULL)
+    exit(error(refFile, ERROPEN));
+  char* line = (char*) memalloc(MAX_SIZE);
+  Chrom* c = NULL;
+  int size = 0;
+  while (gzgets(in, line, MAX_SIZE) != NULL) {
+    if (line[0] == '>') {
+      // new chromosome: name is first token of header
+      chrom = (Chrom*) memrealloc(chrom, (nChrom + 1) * sizeof(Chrom));
+      c = chrom + nChrom++;
+      c->name = copyName(strtok(line + 1, " \t\r\n"));
+      size = MAX_SIZE;
+      c->seq = (char*) memalloc(size);
+      c->len = 0;
+    } else if (c != NULL)
+      for (int i = 0; line[i] != '\0' && line[i] != '\n' &&
+          line[i] != '\r'; i++) {
+        if (c->len == size - 1) {
+          size *= 2;
+          c->seq = (char*) memrealloc(c->seq, size);
+        }
+        char b = line[i];
+        c->seq[c->len++] = (b >= 'a' && b <= 'z' ? b - 32 : b);
+      }
+  }
+  for (int i = 0; i < nChrom; i++)
+    chrom[i].seq[chrom[i].len] = '\0';
+  free(line);
+  if (gzclose(in) != Z_OK)
+    exit(error("", ERRCLOSE));
+}
+
+/* void loadBed()
+ * Loads the primer locations of the amplicons.
+ */
+void loadBed(char* bedFile) {
+  FILE* in = fopen(bedFile, "r");
+  if (in == NULL)
+    exit(error(bedFile, ERROPEN));
+  char* line = (char*) memalloc(MAX_SIZE);
+  while (fgets(line, MAX_SIZE, in) != NULL) {
+    if (line[0] == '#')
+      continue;
+    char* chr = strtok(line, "\t");
+    char* st = strtok(NULL, "\t");
+    char* end = strtok(NULL, "\t");
+    char* name = strtok(NULL, "\t\r\n");
+    if (chr == NULL || st == NULL || end == NULL || name == NULL)
+      continue;
+    int s = getInt(st), e = getInt(end);
+
+    // find amplicon
+    Amplicon* a;
+    int i;
+    for (i = 0; i < nAmp; i++)
+      if (!strcmp(amp[i].name, name))
+        break;
+    if (i == nAmp) {
+      amp = (Amplicon*) memrealloc(amp, (nAmp + 1) * sizeof(Amplicon));
+      a = amp + nAmp++;
+      a->name = copyName(name);
+      a->chrName = copyName(chr);
+      a->chr = -1;
+      a->st = s;
+      a->end = e;
+      a->fLen = e - s;
+      a->rLen = 0;
+    } else {
+      // second primer
+      a = amp + i;
+      if (s < a->st) {
+        a->rLen = a->fLen;
+        a->fLen = e - s;
+        a->st = s;
+      } else {
+        a->rLen = e - s;
+        a->end = e;
+      }
+    }
+  }
+  free(line);
+  if (fclose(in))
+    exit(error("", ERRCLOSE));
+
+  // check amplicons against reference
+  for (int i = 0; i < nAmp; i++) {
+    for (int j = 0; j < nChrom; j++)
+      if (!strcmp(chrom[j].name, amp[i].chrName))
+        amp[i].chr = j;
+    if (amp[i].chr == -1 || ! amp[i].rLen ||
+        amp[i].end > chrom[amp[i].chr].len ||
+        amp[i].st + amp[i].fLen + amp[i].rLen > amp[i].end)
+      exit(error(amp[i].name, ERRBED));
+  }
+  if (! nAmp)
+    exit(error("", ERRAMP));
+}
+
+/* void makePanel()
+ * Creates a random reference and panel of amplicons, and
+ *   writes them to the given files.
+ */
+void makePanel(int num, char* refFile, char* bedFile) {
+  // create amplicons
+  amp = (Amplicon*) memalloc(num * sizeof(Amplicon));
+  nAmp = num;
+  int pos = SPACER;
+  for (int i = 0; i < num; i++) {
+    Amplicon* a = amp + i;
+    char name[32];
+    sprintf(name, "amp%d", i);
+    a->name = copyName(name);
+    a->chrName = SIMCHR;
+    a->chr = 0;
+    a->st = pos;
+    a->end = pos + AMPMIN + randInt(AMPMAX - AMPMIN + 1);
+    a->fLen = a->rLen = PRIMLEN;
+    pos = a->end + SPACER;
+  }
+
+  // create reference
+  chrom = (Chrom*) memalloc(sizeof(Chrom));
+  nChrom = 1;
+  chrom->name = SIMCHR;
+  chrom->len = pos;
+  chrom->seq = (char*) memalloc(pos + 1);
+  for (int i = 0; i < pos; i++)
+    chrom->seq[i] = "ACGT"[randInt(4)];
+  chrom->seq[pos] = '\0';
+
+  // write files
+  FILE* out = fopen(refFile, "w");
+  if (out == NULL)
+    exit(error(refFile, ERROPENW));
+  fprintf(out, ">%s\n", SIMCHR);
+  for (int i = 0; i < pos; i += FALINE)
+    fprintf(out, "%.*s\n", FALINE, chrom->seq + i);
+  if (fclose(out))
+    exit(error("", ERRCLOSE));
+  out = fopen(bedFile, "w");
+  if (out == NULL)
+    exit(error(bedFile, ERROPENW));
+  for (int i = 0; i < num; i++) {
+    Amplicon* a = amp + i;
+    fprintf(out, "%s\t%d\t%d\t%s\n", SIMCHR, a->st, a->st + a->fLen, a->name);
+    fprintf(out, "%s\t%d\t%d\t%s\n", SIMCHR, a->end - a->rLen, a->end, a->name);
+  }
+  if (fclose(out))
+    exit(error("", ERRCLOSE));
+}
+
+/* void writePrimers()
+ * Writes the primer and target sequences (as from
+ *   getPrimers.pl).
+ */
+void writePrimers(char* primFile) {
+  FILE* out = fopen(primFile, "w");
+  if (out == NULL)
+    exit(error(primFile, ERROPENW));
+  for (int i = 0; i < nAmp; i++) {
+    Amplicon* a = amp + i;
+    char* seq = chrom[a->chr].seq;
+    fprintf(out, "%s,%.*s,%.*s,%.*s\n", a->name, a->fLen, seq + a->st,
+      a->rLen, seq + a->end - a->rLen,
+      a->end - a->rLen - a->st - a->fLen, seq + a->st + a->fLen);
+  }
+  if (fclose(out))
+    exit(error("", ERRCLOSE));
+}
+
+/* int makeFrag()
+ * Copies a random amplicon (in a random orientation) into
+ *   frag, adding indels. Returns the length.
+ */
+int makeFrag(char* frag, float indel) {
+  Amplicon* a = amp + randInt(nAmp);
+  char* seq = chrom[a->chr].seq;
+  int len = 0;
+  for (int i = a->st; i < a->end; i++) {
+    if (indel && randDouble() < indel) {
+      if (randInt(2))
+        continue;  // deletion
+      frag[len++] = randBase('\0');  // insertion
+    }
+    frag[len++] = seq[i];
+  }
+  if (randInt(2))
+    for (int i = 0, j = len - 1; i <= j; i++, j--) {
+      char b = frag[i];
+      frag[i] = rc(frag[j]);
+      frag[j] = rc(b);
+    }
+  return len;
+}
+
+/* void printRead()
+ * Prints a read of the fragment (from the 5' end, or the
+ *   3' end reverse-complemented), adding sequencing errors.
+ */
+void printRead(File out, int gz, long num, int dir, char* frag,
+    int fragLen, int readLen, float err, char* seq, char* qual) {
+  int len = fragLen < readLen ? fragLen : readLen;
+  for (int i = 0; i < len; i++) {
+    char b = (dir == 1 ? frag[i] : rc(frag[fragLen - 1 - i]));
+    if (err && randDouble() < err) {
+      seq[i] = randBase(b);
+      qual[i] = ERRQMIN + randInt(ERRQMAX - ERRQMIN + 1);
+    } else {
+      seq[i] = b;
+      qual[i] = QUALMIN + randInt(QUALMAX - QUALMIN + 1);
+    }
+  }
+  seq[len] = qual[len] = '\0';
+  gz ? gzprintf(out.gzf, "@sim.%ld %d:N:0:1\n%s\n+\n%s\n", num, dir, seq, qual)
+    : fprintf(out.f, "@sim.%ld %d:N:0:1\n%s\n+\n%s\n", num, dir, seq, qual);
+}
+
+/* void openWrite()
+ * Opens a file for writing (gzip compressed if named ".gz").
+ */
+int openWrite(char* outFile, File* out) {
+  int len = strlen(outFile);
+  if (len >= strlen(GZEXT) && !strcmp(outFile + len - strlen(GZEXT), GZEXT)) {
+    out->gzf = gzopen(outFile, "w");
+    if (out->gzf == NULL)
+      exit(error(outFile, ERROPENW));
+    return 1;
+  }
+  out->f = fopen(outFile, "w");
+  if (out->f == NULL)
+    exit(error(outFile, ERROPENW));
+  return 0;
+}
+
+/* void getParams()
+ * Parses the command line.
+ */
+void getParams(int argc, char** argv) {
+
+  char* refFile = NULL, *bedFile = NULL, *outFile1 = NULL,
+    *outFile2 = NULL, *primFile = NULL;
+  long num = DEFREADS;
+  int readLen = DEFLEN, panel = 0, seed = DEFSEED;
+  float err = DEFSUBRATE, indel = DEFINDEL;
+
+  // parse argv
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], HELP))
+      usage();
+    else if (i < argc - 1) {
+      if (!strcmp(argv[i], REFFILE))
+        refFile = argv[++i];
+      else if (!strcmp(argv[i], BEDFILE))
+        bedFile = argv[++i];
+      else if (!strcmp(argv[i], OUTFILE1))
+        outFile1 = argv[++i];
+      else if (!strcmp(argv[i], OUTFILE2))
+        outFile2 = argv[++i];
+      else if (!strcmp(argv[i], PRIMFILE))
+        primFile = argv[++i];
+      else if (!strcmp(argv[i], NUMREADS))
+        num = getInt(argv[++i]);
+      else if (!strcmp(argv[i], PANEL))
+        panel = getInt(argv[++i]);
+      else if (!strcmp(argv[i], READLEN))
+        readLen = getInt(argv[++i]);
+      else if (!strcmp(argv[i], SUBRATE))
+        err = getFloat(argv[++i]);
+      else if (!strcmp(argv[i], INDELRATE))
+        indel = getFloat(argv[++i]);
+      else if (!strcmp(argv[i], SEED))
+        seed = getInt(argv[++i]);
+      else
+        exit(error(argv[i], ERRPARAM));
+    } else
+      usage();
+  }
+  if (refFile == NULL || bedFile == NULL || outFile1 == NULL ||
+      outFile2 == NULL || readLen <= 0 || readLen >= MAX_SIZE)
+    usage();
+  if (err < 0.0f || err >= 1.0f || indel < 0.0f || indel >= 1.0f)
+    exit(error("", ERRRATE));
+
+  // load (or create) reference and amplicons
+  state = 0x9E3779B97F4A7C15ULL ^ (unsigned long long) seed;
+  if (! state)
+    state = 1;
+  if (panel > 0)
+    makePanel(panel, refFile, bedFile);
+  else {
+    loadRef(refFile);
+    loadBed(bedFile);
+  }
+  if (primFile != NULL)
+    writePrimers(primFile);
+
+  // simulate reads
+  File out1, out2;
+  int gz = openWrite(outFile1, &out1);
+  if (openWrite(outFile2, &out2) != gz)
+    usage();
+  int maxLen = 0;
+  for (int i = 0; i < nAmp; i++)
+    if (amp[i].end - amp[i].st > maxLen)
+      maxLen = amp[i].end - amp[i].st;
+  char* frag = (char*) memalloc(2 * maxLen + 1);
+  char* seq = (char*) memalloc(MAX_SIZE);
+  char* qual = (char*) memalloc(MAX_SIZE);
+  for (long i = 0; i < num; i++) {
+    int fragLen = makeFrag(frag, indel);
+    printRead(out1, gz, i, 1, frag, fragLen, readLen, err, seq, qual);
+    printRead(out2, gz, i, 2, frag, fragLen, readLen, err, seq, qual);
+  }
+
+  if ( (gz && (gzclose(out1.gzf) != Z_OK || gzclose(out2.gzf) != Z_OK))
+      || (! gz && (fclose(out1.f) || fclose(out2.f))) )
+    exit(error("", ERRCLOSE));
+  free(frag);
+  free(seq);
+  free(qual);
+}
+
+/* int main()
+ * Main.
+ */
+int main(int argc, char* argv[]) {
+  getParams(argc, argv);
+  return 0;
+}
@@ -0,0 +1,87 @@
+/*
+  October 2026
+
+  Header file for genReads.c.
+*/
+
+#define MAX_SIZE    1024    // maximum length for input line
+#define GZEXT       ".gz"   // file extension for gzip compression
+#define FALINE      60      // line length of fasta output
+
+// command-line parameters
+#define HELP        "-h"
+#define REFFILE     "-r"
+#define BEDFILE     "-b"
+#define OUTFILE1    "-1"
+#define OUTFILE2    "-2"
+#define PRIMFILE    "-p"
+#define NUMREADS    "-n"
+#define PANEL       "-a"
+#define READLEN     "-l"
+#define SUBRATE     "-e"
+#define INDELRATE   "-d"
+#define SEED        "-s"
+
+// default parameter values
+#define DEFREADS    100000
+#define DEFLEN      150
+#define DEFSUBRATE  0.001f
+#define DEFINDEL    0.0001f
+#define DEFSEED     1
+
+// random panel (-a)
+#define SIMCHR      "chrSim"
+#define AMPMIN      150     // min. length of amplicon (with primers)
+#define AMPMAX      300     // max. length of amplicon
+#define PRIMLEN     20      // length of primers
+#define SPACER      100     // length of sequence between amplicons
+
+// quality scores (phred + 33)
+#define QUALMIN     '?'     // range for correct bases (Q30-40)
+#define QUALMAX     'I'
+#define ERRQMIN     '#'     // range for sequencing errors (Q2-20)
+#define ERRQMAX     '5'
+
+// error messages
+#define ERROPEN     0
+#define MERROPEN    ": cannot open file for reading"
+#define ERROPENW    1
+#define MERROPENW   ": cannot open file for writing"
+#define ERRCLOSE    2
+#define MERRCLOSE   "Cannot close file"
+#define ERRMEM      3
+#define MERRMEM     "Cannot allocate memory"
+#define ERRINT      4
+#define MERRINT     ": cannot convert to int"
+#define ERRFLOAT    5
+#define MERRFLOAT   ": cannot convert to float"
+#define ERRPARAM    6
+#define MERRPARAM   ": unknown command-line parameter"
+#define ERRBED      7
+#define MERRBED     ": amplicon not found in reference or missing a primer"
+#define ERRAMP      8
+#define MERRAMP     "No amplicons loaded"
+#define ERRRATE     9
+#define MERRRATE    "Error and indel rates must be in [0,1)"
+#define DEFERR      "Unknown error"
+
+typedef union file {
+  FILE* f;
+  gzFile gzf;
+} File;
+
+typedef struct chrom {
+  char* name;
+  char* seq;
+  int len;
+} Chrom;
+
+typedef struct amplicon {
+  char* name;
+  char* chrName;
+  int chr;      // index of chromosome (-1 = not found)
+  int st;       // 0-based start of fwd primer
+  int end;      // end of rev primer (exclusive)
+  int fLen;     // length of fwd primer
+  int rLen;     // length of rev primer (0 = not loaded)
+} Amplicon;
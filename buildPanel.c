@@ -0,0 +1,403 @@
+/*
+  October 2026
+
+  Compiling a panel into a bundle (see panel.c), to be
+    memory-mapped by removePrimer, alignAmp, and ampPileup
+    in place of parsing the primers and BED files.
+  The primers file (getPrimers.pl) gives the amplicons, in
+    order; for each, the primers are saved with their
+    reverse-complements and IUPAC masks, along with the
+    target sequence and the BED coordinates of the primers
+    (the first two lines for the amplicon). The amplicons
+    are also indexed by name. The bundle records checksums
+    of the primers and BED files, and of the genome if
+    given, so that a stale bundle is detected.
+*/
+
+#define _XOPEN_SOURCE 700  // realpath()
+#define _FILE_OFFSET_BITS 64
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include "panel.h"
+#include "buildPanel.h"
+
+// global variables
+static PnlAmp* amp;
+static uint32_t nAmp;
+static uint32_t* byName;
+static char* pool;            // string pool of the bundle
+static uint64_t poolLen, poolMax;
+
+/* void usage()
+ * Prints usage information.
+ */
+void usage(void) {
+  fprintf(stderr, "Usage: ./buildPanel {%s <file> %s <file> ", PRIMFILE, BEDFILE);
+  fprintf(stderr, "%s <file>} [optional parameters]\n", OUTFILE);
+  fprintf(stderr, "Required parameters:\n");
+  fprintf(stderr, "  %s <file>   File listing primer and target sequences (produced\n", PRIMFILE);
+  fprintf(stderr, "                by getPrimers.pl)\n");
+  fprintf(stderr, "  %s <file>   BED file listing locations of primers\n", BEDFILE);
+  fprintf(stderr, "  %s <file>   Output panel bundle (given to removePrimer, alignAmp,\n", OUTFILE);
+  fprintf(stderr, "                and ampPileup with -p)\n");
+  fprintf(stderr, "Optional parameters:\n");
+  fprintf(stderr, "  %s <file>   Reference genome, whose checksum is also recorded\n", GENFILE);
+  fprintf(stderr, "                (so that the bundle is stale if it changes)\n");
+  fprintf(stderr, "  %s         Option to keep the output bundle if it is current\n", UPDATE);
+  fprintf(stderr, "                (made from the same, unchanged files)\n");
+  fprintf(stderr, "  %s         Option to print counts of results to stdout\n", VERBOSE);
+  exit(-1);
+}
+
+/* int error()
+ * Prints an error message.
+ */
+int error(char* msg, int err) {
+  char* msg2;
+  if (err == ERROPEN) msg2 = MERROPEN;
+  else if (err == ERRCLOSE) msg2 = MERRCLOSE;
+  else if (err == ERROPENW) msg2 = MERROPENW;
+  else if (err == ERRMEM) msg2 = MERRMEM;
+  else if (err == ERRPARAM) msg2 = MERRPARAM;
+  else if (err == ERRINT) msg2 = MERRINT;
+  else if (err == ERRPRIM) msg2 = MERRPRIM;
+  else if (err == ERRPREP) msg2 = MERRPREP;
+  else if (err == ERRBASE) msg2 = MERRBASE;
+  else if (err == ERRBED) msg2 = MERRBED;
+  else if (err == ERRNOPRIM) msg2 = MERRNOPRIM;
+  else msg2 = DEFERR;
+
+  fprintf(stderr, "Error! %s%s\n", msg, msg2);
+  return -1;
+}
+
+/* void* memrealloc()
+ * Resizes (or allocates) a heap block.
+ */
+void* memrealloc(void* ptr, size_t size) {
+  void* ans = realloc(ptr, size);
+  if (ans == NULL)
+    exit(error("", ERRMEM));
+  return ans;
+}
+
+/* int getInt(char*)
+ * Converts the given char* to an int.
+ */
+int getInt(char* in) {
+  char* endptr;
+  int ans = (int) strtol(in, &endptr, 10);
+  if (*endptr != '\0')
+    exit(error(in, ERRINT));
+  return ans;
+}
+
+/* FILE* openRead()
+ * Opens a file for reading.
+ */
+FILE* openRead(char* inFile) {
+  FILE* in = fopen(inFile, "r");
+  if (in == NULL)
+    exit(error(inFile, ERROPEN));
+  return in;
+}
+
+/* uint32_t addStr()
+ * Adds a string to the pool. Returns its offset.
+ */
+uint32_t addStr(char* str, size_t len) {
+  if (! len)
+    return 0;  // empty string at start of pool
+  if (poolLen + len + 1 > poolMax) {
+    while (poolLen + len + 1 > poolMax)
+      poolMax *= 2;
+    pool = (char*) memrealloc(pool, poolMax);
+  }
+  uint32_t ans = poolLen;
+  memcpy(pool + poolLen, str, len);
+  pool[poolLen + len] = '\0';
+  poolLen += len + 1;
+  return ans;
+}
+
+/* char rc()
+ * Returns the complement of the given base (as removePrimer).
+ */
+char rc(char in) {
+  char out;
+  if (in == 'A') out = 'T';
+  else if (in == 'T') out = 'A';
+  else if (in == 'C') out = 'G';
+  else if (in == 'G') out = 'C';
+  else if (in == 'Y') out = 'R';
+  else if (in == 'R') out = 'Y';
+  else if (in == 'W') out = 'W';
+  else if (in == 'S') out = 'S';
+  else if (in == 'K') out = 'M';
+  else if (in == 'M') out = 'K';
+  else if (in == 'B') out = 'V';
+  else if (in == 'V') out = 'B';
+  else if (in == 'D') out = 'H';
+  else if (in == 'H') out = 'D';
+  else if (in == 'N') out = 'N';
+  else out = '\0';
+  return out;
+}
+
+/* char mask()
+ * Returns the IUPAC mask of the given base (A=1, C=2,
+ *   G=4, T=8).
+ */
+char mask(char in) {
+  static const char* code = "-ACMGRSVTWYHKDBN";
+  for (int i = 1; i < 16; i++)
+    if (code[i] == in)
+      return i;
+  return 0;
+}
+
+/* void addPrim()
+ * Adds a primer to the pool, with its reverse-complement
+ *   and the masks of both.
+ */
+void addPrim(char* name, char* seq, uint32_t* fwd, uint32_t* frc,
+    uint32_t* fmask, uint32_t* rmask) {
+  size_t len = strlen(seq);
+  char* buf = (char*) memrealloc(NULL, len + 1);
+  *fwd = addStr(seq, len);
+  for (size_t i = 0; i < len; i++)
+    if (! (buf[i] = mask(seq[i])))
+      exit(error(name, ERRBASE));
+  *fmask = addStr(buf, len);
+  for (size_t i = 0; i < len; i++)
+    buf[i] = rc(seq[len - 1 - i]);
+  *frc = addStr(buf, len);
+  for (size_t i = 0; i < len; i++)
+    buf[i] = mask(buf[i]);
+  *rmask = addStr(buf, len);
+  free(buf);
+}
+
+/* int nameCmp()
+ * Compares amplicons (indexes) by name (for qsort/bsearch).
+ */
+int nameCmp(const void* a, const void* b) {
+  return strcmp(pool + amp[*(uint32_t*) a].name,
+    pool + amp[*(uint32_t*) b].name);
+}
+
+/* int keyCmp()
+ * Compares a name to an amplicon (index) (for bsearch).
+ */
+int keyCmp(const void* a, const void* b) {
+  return strcmp((char*) a, pool + amp[*(uint32_t*) b].name);
+}
+
+/* PnlAmp* findAmp()
+ * Finds an amplicon by name (NULL if not found).
+ */
+PnlAmp* findAmp(char* name) {
+  uint32_t* ans = (uint32_t*) bsearch(name, byName, nAmp,
+    sizeof(uint32_t), keyCmp);
+  return ans == NULL ? NULL : amp + *ans;
+}
+
+/* void loadPrims()
+ * Loads the primers and target sequences.
+ */
+void loadPrims(FILE* prim, char* line) {
+  uint32_t max = 0;
+  while (fgets(line, MAX_SIZE, prim) != NULL) {
+    if (line[0] == '#' || line[0] == '\n' || line[0] == '\r')
+      continue;
+    char* name = strtok(line, CSV);
+    char* fwd = strtok(NULL, CSV);
+    char* rev = strtok(NULL, DEL);
+    char* seq = strtok(NULL, DEL);
+    if (name == NULL || fwd == NULL || rev == NULL)
+      exit(error(name == NULL ? "" : name, ERRPRIM));
+    if (nAmp == max) {
+      max = max ? 2 * max : 64;
+      amp = (PnlAmp*) memrealloc(amp, max * sizeof(PnlAmp));
+    }
+    PnlAmp* a = amp + nAmp++;
+    memset(a, 0, sizeof(PnlAmp));
+    a->name = addStr(name, strlen(name));
+    addPrim(name, fwd, &a->fwd, &a->frc, a->mask, a->mask + 2);
+    addPrim(name, rev, &a->rev, &a->rrc, a->mask + 1, a->mask + 3);
+    a->tgt = (seq == NULL ? 0 : addStr(seq, strlen(seq)));
+  }
+  if (! nAmp)
+    exit(error("", ERRNOPRIM));
+
+  // index by name, checking for duplicates
+  byName = (uint32_t*) memrealloc(NULL, nAmp * sizeof(uint32_t));
+  for (uint32_t i = 0; i < nAmp; i++)
+    byName[i] = i;
+  qsort(byName, nAmp, sizeof(uint32_t), nameCmp);
+  for (uint32_t i = 1; i < nAmp; i++)
+    if (! nameCmp(byName + i - 1, byName + i))
+      exit(error(pool + amp[byName[i]].name, ERRPREP));
+}
+
+/* int loadBed()
+ * Loads the positions of the primers (the first two lines
+ *   of each amplicon). Returns the number of amplicons
+ *   with both.
+ */
+int loadBed(FILE* bed, char* line) {
+  int count = 0;
+  while (fgets(line, MAX_SIZE, bed) != NULL) {
+    if (line[0] == '#' || line[0] == '\n' || line[0] == '\r' ||
+        !strncmp(line, "track", 5) || !strncmp(line, "browser", 7))
+      continue;
+    char* chr = strtok(line, "\t");
+    char* st = strtok(NULL, "\t");
+    char* end = strtok(NULL, "\t");
+    char* name = strtok(NULL, "\t\n\r");
+    if (name == NULL)
+      exit(error(chr, ERRBED));
+    PnlAmp* a = findAmp(name);
+    if (a == NULL || a->nBed == 2)
+      continue;
+    if (! a->nBed)
+      a->chr = addStr(chr, strlen(chr));
+    a->st[a->nBed] = getInt(st);
+    a->end[a->nBed] = getInt(end);
+    if (++a->nBed == 2)
+      count++;
+  }
+  return count;
+}
+
+/* char* fullPath()
+ * Returns the absolute path of a file (heap copy).
+ */
+char* fullPath(char* file) {
+  char* ans = realpath(file, NULL);
+  if (ans == NULL)
+    exit(error(file, ERROPEN));
+  return ans;
+}
+
+/* void writePanel()
+ * Writes the bundle (to a temporary file, then renamed).
+ */
+void writePanel(char* outFile, char** src) {
+  PnlHead h;
+  memset(&h, 0, sizeof(h));
+  strncpy(h.magic, PNLMAGIC, sizeof(h.magic));
+  h.version = PNLVERSION;
+  h.nAmp = nAmp;
+  h.strLen = poolLen;
+  PnlSrc s[PNLSRC];
+  memset(s, 0, sizeof(s));
+  for (int i = 0; i < PNLSRC; i++)
+    if (src[i] != NULL) {
+      s[i].path = addStr(src[i], strlen(src[i]));
+      s[i].crc = fileCrc(src[i], &s[i].size, &s[i].mtime);
+    }
+  h.strLen = poolLen;
+
+  char* tmpFile = (char*) memrealloc(NULL, strlen(outFile) + 32);
+  sprintf(tmpFile, "%s.tmp%ld", outFile, (long) getpid());
+  FILE* out = fopen(tmpFile, "wb");
+  if (out == NULL)
+    exit(error(tmpFile, ERROPENW));
+  if (fwrite(&h, sizeof(h), 1, out) != 1
+      || fwrite(s, sizeof(PnlSrc), PNLSRC, out) != PNLSRC
+      || fwrite(amp, sizeof(PnlAmp), nAmp, out) != nAmp
+      || fwrite(byName, sizeof(uint32_t), nAmp, out) != nAmp
+      || fwrite(pool, 1, poolLen, out) != poolLen)
+    exit(error(tmpFile, ERROPENW));
+  if (fclose(out))
+    exit(error("", ERRCLOSE));
+  if (rename(tmpFile, outFile))
+    exit(error(outFile, ERROPENW));
+  free(tmpFile);
+}
+
+/* void getParams()
+ * Gets command-line parameters.
+ */
+void getParams(int argc, char** argv) {
+
+  char* primFile = NULL, *bedFile = NULL, *genFile = NULL,
+    *outFile = NULL;
+  int update = 0, verbose = 0;
+
+  // parse argv
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], HELP))
+      usage();
+    else if (!strcmp(argv[i], UPDATE))
+      update = 1;
+    else if (!strcmp(argv[i], VERBOSE))
+      verbose = 1;
+    else if (i < argc - 1) {
+      if (!strcmp(argv[i], PRIMFILE))
+        primFile = argv[++i];
+      else if (!strcmp(argv[i], BEDFILE))
+        bedFile = argv[++i];
+      else if (!strcmp(argv[i], GENFILE))
+        genFile = argv[++i];
+      else if (!strcmp(argv[i], OUTFILE))
+        outFile = argv[++i];
+      else
+        exit(error(argv[i], ERRPARAM));
+    } else
+      exit(error(argv[i], ERRPARAM));
+  }
+
+  if (primFile == NULL || bedFile == NULL || outFile == NULL)
+    usage();
+
+  // sources (absolute paths, for runs in other directories)
+  char* src[PNLSRC];
+  src[PNLPRIM] = fullPath(primFile);
+  src[PNLBED] = fullPath(bedFile);
+  src[PNLGEN] = (genFile == NULL ? NULL : fullPath(genFile));
+  if (update && panelCurrent(outFile, src)) {
+    if (verbose)
+      printf("Panel bundle %s is current\n", outFile);
+    for (int i = 0; i < PNLSRC; i++)
+      free(src[i]);
+    return;
+  }
+
+  // load primers and positions
+  char* line = (char*) memrealloc(NULL, MAX_SIZE);
+  poolMax = STRINIT;
+  pool = (char*) memrealloc(NULL, poolMax);
+  pool[0] = '\0';
+  poolLen = 1;
+  FILE* prim = openRead(primFile);
+  loadPrims(prim, line);
+  FILE* bed = openRead(bedFile);
+  int count = loadBed(bed, line);
+  if (fclose(prim) || fclose(bed))
+    exit(error("", ERRCLOSE));
+
+  writePanel(outFile, src);
+  if (verbose)
+    printf("Amplicons: %u\nWith both primers in BED file: %d\n",
+      nAmp, count);
+
+  for (int i = 0; i < PNLSRC; i++)
+    free(src[i]);
+  free(line);
+  free(pool);
+  free(amp);
+  free(byName);
+}
+
+/* int main()
+ * Main.
+ */
+int main(int argc, char* argv[]) {
+  getParams(argc, argv);
+  return 0;
+}
@@ -0,0 +1,44 @@
+/*
+  October 2026
+
+  Header file for buildPanel.c.
+*/
+
+#define MAX_SIZE    65536  // maximum length for input line
+#define CSV         ",\t"  // delimiters of primers file
+#define DEL         ",\t\n\r"
+#define STRINIT     65536  // initial size of string pool
+
+// command-line parameters
+#define HELP        "-h"
+#define PRIMFILE    "-p"
+#define BEDFILE     "-b"
+#define GENFILE     "-g"   // reference genome (checksummed only)
+#define OUTFILE     "-o"
+#define UPDATE      "-u"   // option to keep a bundle that is current
+#define VERBOSE     "-ve"  // option to print counts to stdout
+
+// error messages
+#define ERROPEN     0
+#define MERROPEN    ": cannot open file for reading"
+#define ERRCLOSE    1
+#define MERRCLOSE   "Cannot close file"
+#define ERROPENW    2
+#define MERROPENW   ": cannot open file for writing"
+#define ERRMEM      3
+#define MERRMEM     "Cannot allocate memory"
+#define ERRPARAM    4
+#define MERRPARAM   ": unknown command-line parameter"
+#define ERRINT      5
+#define MERRINT     ": cannot convert to int"
+#define ERRPRIM     6
+#define MERRPRIM    ": improperly formatted line in primers file"
+#define ERRPREP     7
+#define MERRPREP    ": cannot repeat primer name"
+#define ERRBASE     8
+#define MERRBASE    ": primer has a base that is not an IUPAC code"
+#define ERRBED      9
+#define MERRBED     ": improperly formatted line in BED file"
+#define ERRNOPRIM   10
+#define MERRNOPRIM  "No primers loaded"
+#define DEFERR      "Unknown error"
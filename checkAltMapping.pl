@@ -7,30 +7,54 @@
 
 use strict;
 use warnings;
+use FindBin;
+use lib $FindBin::RealBin;
+use Faidx;
+use AltDB;
+use Collapsed qw(mult);
 
 sub usage {
   print q(Usage: perl checkAltMapping.pl  <infile1>  <infile2>  <infile3>  <infile4>  \
-                      <genome>  <outfile>  <score>  <logfile>
+                      <genome>  <outfile>  <score>  <logfile>  [-db <file>]
   Required:
     <infile1>  File containing input reads in fastq format, with primers removed
                  and amplicon identification in header (produced by removePrimer;
-                 may be gzip compressed, with ".gz" extension)
+                 may be gzip compressed, with ".gz" extension) -- or '-xp' to
+                 read the identification from the XP:Z tag of each SAM record
+                 (removePrimer -xp, bowtie2 --sam-append-comment) instead
     <infile2>  SAM file (can use '-' for STDIN [e.g. piped in from samtools])
     <infile3>  File listing primer and target sequences (produced by getPrimers.pl)
     <infile4>  BED file listing locations of primers
     <genome>   Fasta file of reference genome (single file; may be
-                 gzip compressed, with ".gz" extension)
+                 gzip compressed, with ".gz" extension [bgzip for
+                 random access]; indexed as by 'samtools faidx')
     <outfile>  Output file listing match judgments
   Optional:
     <score>    Minimum primer matching score (scale 0-1; def. 0.75)
     <logfile>  Output file that lists primer alignments and scores
+    -db <file> Database of match judgments, shared by samples (same format
+                 as <outfile>; created if missing): sites judged before are
+                 not rescored, and new judgments are appended to it
 );
   exit;
 }
 
+# database of judgments (option may be anywhere)
+my $db;
+for (my $x = 0; $x < $#ARGV; $x++) {
+  if ($ARGV[$x] eq "-db") {
+    $db = AltDB->new($ARGV[$x+1]);
+    splice(@ARGV, $x, 2);
+    last;
+  }
+}
+
 usage() if (scalar @ARGV < 6 || $ARGV[0] eq "-h");
 
-if (substr($ARGV[0], -3) eq ".gz") {
+my $xp = ($ARGV[0] eq "-xp" ? 1 : 0);  # amplicon info from SAM tags
+if ($xp) {
+  # no reads to load
+} elsif (substr($ARGV[0], -3) eq ".gz") {
   die "Cannot open $ARGV[0]\n" if (! -f $ARGV[0]);
   open(FQ, "zcat $ARGV[0] |");
 } else {
@@ -39,12 +63,6 @@ if (substr($ARGV[0], -3) eq ".gz") {
 open(SAM, $ARGV[1]) || die "Cannot open $ARGV[1]\n";
 open(PR, $ARGV[2]) || die "Cannot open $ARGV[2]\n";
 open(BED, $ARGV[3]) || die "Cannot open $ARGV[3]\n";
-if (substr($ARGV[4], -3) eq ".gz") {
-  die "Cannot open $ARGV[4]\n" if (! -f $ARGV[4]);
-  open(GEN, "zcat $ARGV[4] |");
-} else {
-  open(GEN, $ARGV[4]) || die "Cannot open $ARGV[4]\n";
-}
 open(OUT, ">$ARGV[5]") || die "Cannot open $ARGV[5] for writing\n";
 my $pct = 0.75;
 if (scalar @ARGV > 6) {
@@ -99,43 +117,43 @@ while (my $line = <BED>) {
 }
 close BED;
 
-# load genome
-my %chr;
-$/ = '>';
-my $waste = <GEN>;
-while (my $chunk = <GEN>) {
-  chomp $chunk;
-  my @spl = split("\n", $chunk);
-  my @head = split(" ", shift @spl);
-  my $ch = $head[0];
-  if (exists $chr{$ch}) {
-    warn "Warning! In reference genome $ARGV[4]\n",
-      "  Chromosome name $ch repeated\n";
-  } else {
-    $chr{$ch} = join("", @spl);
-  }
+# open genome (segments are retrieved as needed)
+my $gen = Faidx->new($ARGV[4]);
+
+# index amplicons (reads are saved with the index)
+my @amps = sort keys %loc;
+my %idx;
+for (my $x = 0; $x < scalar @amps; $x++) {
+  $idx{$amps[$x]} = $x;
 }
-close GEN;
 
 # load amplicon info for reads from fastq
-my %amp;  # saves amplicon
-my %pri;  # saves removed-primer information: (fwd|rev)(\tboth)?
-my %dup;  # saves removed-primer information for reads listed
-          #   multiple times (singletons, unjoined)
+my %amp;  # saves amplicon index and removed-primer information,
+          #   as 4*index+2*rev+both
+my %dup;  # saves removed-primer information (2*rev+both) for reads
+          #   listed multiple times (singletons, unjoined)
 my %seq;  # saves sequences for reads listed multiple times --
           #   used as 2nd key for %dup
 my $count = 0; my $cdup = 0;
 $/ = "\n";
-while (my $line = <FQ>) {
+while (! $xp && defined(my $line = <FQ>)) {
   next if (substr($line, 0, 1) ne '@');
   chomp $line;
 
-  # determine amplicon ID
+  # determine amplicon ID, and removed-primer info
   my @spl = split(" ", $line);
   my $id = "";
+  my $pr = 0;
   for (my $x = 1; $x < scalar @spl; $x++) {
+    if ($spl[$x] =~ m/^XP:Z:(.+),(fwd|rev),(one|both)$/) {
+      $id = $1;
+      $pr = ($2 eq "rev" ? 2 : 0) + ($3 eq "both" ? 1 : 0);
+      last;
+    }
     if ($spl[$x] eq "fwd" || $spl[$x] eq "rev") {
       $id = $spl[$x-1];
+      $pr = ($spl[$x] eq "rev" ? 2 : 0) +
+        ($x < $#spl && $spl[$x+1] eq "both" ? 1 : 0);
       last;
     }
   }
@@ -144,31 +162,22 @@ while (my $line = <FQ>) {
   my $que = substr($spl[0], 1);
 
   # check amplicon, and for duplicates
-  foreach my $am (keys %loc) {
-    if ($id eq $am) {
-      if (exists $amp{$que}) {
-        if ($id ne $amp{$que}) {
-          warn "Warning! Primers do not match for read $que\n";
-          delete $amp{$que};
-          last;
-        }
-        if (exists $pri{$que}) {
-          # save previous to %dup
-          $dup{$que}{$seq{$que}} = $pri{$que};
-          delete $pri{$que};
-        }
-        chomp ($line = <FQ>);
-        $dup{$que}{$line} = ($spl[$#spl] eq "both" ?
-          "$spl[$#spl-1]\t$spl[$#spl]" : $spl[$#spl]);
-        $cdup++;
-      } else {
-        $amp{$que} = $am;
-        $pri{$que} = ($spl[$#spl] eq "both" ?
-          "$spl[$#spl-1]\t$spl[$#spl]" : $spl[$#spl]);
-        chomp ($line = <FQ>);
-        $seq{$que} = $line;  # save sequence in case of duplicate
-      }
-      last;
+  if (exists $idx{$id}) {
+    if (! exists $amp{$que}) {
+      $amp{$que} = 4 * $idx{$id} + $pr;
+      delete $dup{$que};
+      chomp ($line = <FQ>);
+      $seq{$que} = $line;  # save sequence in case of duplicate
+    } elsif ($amp{$que} >> 2 != $idx{$id}) {
+      warn "Warning! Primers do not match for read $que\n";
+      delete $amp{$que};
+    } else {
+      # save previous to %dup
+      $dup{$que}{$seq{$que}} = $amp{$que} & 3
+        if (! exists $dup{$que});
+      chomp ($line = <FQ>);
+      $dup{$que}{$line} = $pr;
+      $cdup++;
     }
   }
 
@@ -182,7 +191,7 @@ while (my $line = <FQ>) {
     $line = <FQ>;
   }
 }
-close FQ;
+close FQ if (! $xp);
 #print "Reads: $count\n";
 #print "Unique: ", scalar keys %amp,
 #  "\nDuplicates: $cdup\n";
@@ -194,6 +203,7 @@ my $ct = 0; my $un = 0;
 my %alt;  # 1 if a match, else 0
 my %tot;  # number of reads at an alt. location
 my %ln;   # lengths of reads analyzed at an alt. location
+my %new;  # positions analyzed (not taken from the database)
 my $line = <SAM>;
 while ($line) {
   if (substr($line, 0, 1) eq '@') {
@@ -219,7 +229,9 @@ while ($line) {
   }
 
   # load amplicon info for read
-  if (! exists $amp{$spl[0]}) {
+  my $ramp = ($xp ? (xpPri(@spl))[0] :
+    (exists $amp{$spl[0]} ? $amps[$amp{$spl[0]} >> 2] : ""));
+  if (! $ramp) {
     warn "Warning! Skipping read $spl[0] --\n",
       "  no amplicon info\n";
     while ($line = <SAM>) {
@@ -230,7 +242,6 @@ while ($line) {
     }
     next;
   }
-  my $ramp = $amp{$spl[0]};
   my @cut = split("\t", $loc{$ramp});  # expected location: chr $cut[0],
                                        #  min pos $cut[1], max pos $cut[2]
 
@@ -247,16 +258,15 @@ while ($line) {
 
     # load removed-primer info
     my @pr = ();
-    if (exists $pri{$div[0]}) {
-      @pr = split("\t", $pri{$div[0]});
+    if ($xp) {
+      @pr = xpPri(@div);
+      shift @pr;  # amplicon
     } elsif (exists $dup{$div[0]}) {
       my $test = ($rc ? revComp($div[9]) : $div[9]);
-      foreach my $seq (keys %{$dup{$div[0]}}) {
-        if ($test eq $seq) {
-          @pr = split("\t", $dup{$div[0]}{$seq});
-          last;
-        }
-      }
+      @pr = priInfo($dup{$div[0]}{$test})
+        if (exists $dup{$div[0]}{$test});
+    } elsif (exists $amp{$div[0]}) {
+      @pr = priInfo($amp{$div[0]});
     }
     if (!@pr) {
       warn "Warning! No removed-primer info for read $div[0]\n";
@@ -286,7 +296,7 @@ while ($line) {
     if ($div[2] ne $cut[0] || $pos < $cut[1] || $pos > $cut[2]) {
 
       # skip if no genomic segment loaded
-      if (! exists $chr{$div[2]}) {
+      if (! defined $gen->chrLen($div[2])) {
         warn "Warning! No sequence loaded for reference $div[2]\n";
         $line = <SAM>;
         next;
@@ -309,9 +319,19 @@ while ($line) {
           }
         }
       }
+      # skip if judged before (in the database)
+      if (! $flag && $db) {
+        my $res = $db->lookup($ramp, ($both ? "both" : "one"),
+          ($rc ? '-' : '+'), $div[2], $pos);
+        if (defined $res) {
+          $alt{$ramp}{$both}{$rc}{$div[2]}{$pos} = $res
+            if (! $alt{$ramp}{$both}{$rc}{$div[2]}{$pos});
+          $flag = 1;
+        }
+      }
       # skipping subroutine:
       if ($flag) {
-        $tot{$ramp}{$both}{$rc}{$div[2]}{$pos}++;
+        $tot{$ramp}{$both}{$rc}{$div[2]}{$pos} += mult($div[0]);
         $line = <SAM>;
         next;
       }
@@ -330,15 +350,15 @@ while ($line) {
       #   -- allow 1bp wiggle room
       my $fwdP; my $revP = "";
       if ($rc) {
-        $fwdP = substr($chr{$div[2]}, $div[3] - 2 + $off + length $div[9], 2 + length $fiveP);
+        $fwdP = $gen->fetch($div[2], $div[3] - 2 + $off + length $div[9], 2 + length $fiveP);
         $fwdP = revComp($fwdP);
         if ($both) {
-          $revP = substr($chr{$div[2]}, $div[3] - 2 - length $threeP, 2 + length $threeP);
+          $revP = $gen->fetch($div[2], $div[3] - 2 - length $threeP, 2 + length $threeP);
         }
       } else {
-        $fwdP = substr($chr{$div[2]}, $div[3] - 2 - length $fiveP, 2 + length $fiveP);
+        $fwdP = $gen->fetch($div[2], $div[3] - 2 - length $fiveP, 2 + length $fiveP);
         if ($both) {
-          $revP = substr($chr{$div[2]}, $div[3] - 2 + $off + length $div[9], 2 + length $threeP);
+          $revP = $gen->fetch($div[2], $div[3] - 2 + $off + length $div[9], 2 + length $threeP);
           $revP = revComp($revP);
         }
       }
@@ -354,7 +374,8 @@ while ($line) {
       $res = 0 if ($scoreF < $pct || ($both && $scoreR < $pct));
 
       # record score
-      $tot{$ramp}{$both}{$rc}{$div[2]}{$pos}++;
+      $tot{$ramp}{$both}{$rc}{$div[2]}{$pos} += mult($div[0]);
+      $new{$ramp}{$both}{$rc}{$div[2]}{$pos} = 1;
       if ($res) {
         # if match, add results to position AND neighbors (3bp)
         for (my $x = -3; $x < 4; $x++) {
@@ -410,7 +431,7 @@ foreach my $am (sort {$a cmp $b} keys %tot) {
     foreach my $st (sort {$a <=> $b} keys %{$tot{$am}{$bo}}) {
       foreach my $ch (sort {$a cmp $b} keys %{$tot{$am}{$bo}{$st}}) {
 
-        my $res; my $min;
+        my $res; my $min; my $add;
         my $prev = -10;  # previous position analyzed
         my @loc = sort {$a <=> $b} keys %{$tot{$am}{$bo}{$st}{$ch}};
         for (my $x = 0; $x < scalar @loc; $x++) {
@@ -419,26 +440,50 @@ foreach my $am (sort {$a cmp $b} keys %tot) {
           if ($loc[$x] < $prev + 4) {
             $res = 1 if ($alt{$am}{$bo}{$st}{$ch}{$loc[$x]});
           } else {
-            if ($x) {
-              printf OUT "$am\t%s\t%s\t$ch\t%s\t$res\n",
-                ($bo ? "both" : "one"), ($st ? '-' : '+'),
-                ($min != $prev ? "$min-$prev" : $min);
-            }
+            printRes($am, $bo, $st, $ch, $min, $prev, $res, $add) if ($x);
             $res = $alt{$am}{$bo}{$st}{$ch}{$loc[$x]};
             $min = $loc[$x];
+            $add = 0;
           }
+          $add = 1 if (exists $new{$am}{$bo}{$st}{$ch}{$loc[$x]});
           $prev = $loc[$x];
         }
-        if (@loc) {
-          printf OUT "$am\t%s\t%s\t$ch\t%s\t$res\n",
-            ($bo ? "both" : "one"), ($st ? '-' : '+'),
-            ($min != $prev ? "$min-$prev" : $min);
-        }
+        printRes($am, $bo, $st, $ch, $min, $prev, $res, $add) if (@loc);
       }
     }
   }
 }
 close OUT;
+$db->save() if ($db);
+
+# print judgment for a range of positions (and add it
+#   to the database if any position was newly analyzed)
+sub printRes {
+  my ($am, $bo, $st, $ch, $min, $max, $res, $add) = @_;
+  my $pr = ($bo ? "both" : "one");
+  my $str = ($st ? '-' : '+');
+  print OUT "$am\t$pr\t$str\t$ch\t",
+    ($min != $max ? "$min-$max" : $min), "\t$res\n";
+  $db->add($am, $pr, $str, $ch, $min, $max, $res) if ($db && $add);
+}
+
+# removed-primer info -- (fwd|rev), "both" if so -- of a read
+#   saved from the fastq
+sub priInfo {
+  return ($_[0] & 2 ? "rev" : "fwd", ($_[0] & 1 ? "both" : ()));
+}
+
+# amplicon and removed-primer info -- (fwd|rev), "both" if so --
+#   from the XP:Z tag of a SAM record, or () if none
+sub xpPri {
+  for (my $x = 11; $x < scalar @_; $x++) {
+    if ($_[$x] =~ m/^XP:Z:(.+),(fwd|rev),(one|both)$/) {
+      return () if (! exists $loc{$1});
+      return ($3 eq "both" ? ($1, $2, $3) : ($1, $2));
+    }
+  }
+  return ();
+}
 
 # reverse-complement a sequence
 sub revComp {
@@ -0,0 +1,286 @@
+/*
+  October 2026
+
+  Saving and restoring checkpoints of a long run.
+  A checkpoint lists the positions of the input files (with
+    BGZF virtual offsets for BGZF compressed inputs), the
+    positions of the output files (after flushing them; gzip
+    outputs are finished, so a resumed run begins a new gzip
+    member), and the values of the counters. Resuming with
+    the same checkpoint interval produces the same output
+    as an uninterrupted run.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+#define _FILE_OFFSET_BITS 64
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <zlib.h>
+#include "shard.h"
+#include "checkpoint.h"
+
+/* int ckptError()
+ * Prints an error message.
+ */
+static int ckptError(char* msg, int err) {
+  char* msg2;
+  if (err == ERRCKOPEN) msg2 = MERRCKOPEN;
+  else if (err == ERRCKLOAD) msg2 = MERRCKLOAD;
+  else if (err == ERRCKMATCH) msg2 = MERRCKMATCH;
+  else if (err == ERRCKOUT) msg2 = MERRCKOUT;
+  else if (err == ERRCKINT) msg2 = MERRCKINT;
+  else msg2 = "Unknown error";
+
+  fprintf(stderr, "Error! %s%s\n", msg, msg2);
+  return -1;
+}
+
+/* void initCkpt()
+ * Initializes the checkpoint info (no checkpoints).
+ */
+void initCkpt(Ckpt* ck) {
+  ck->file = NULL;
+  ck->every = DEFCKPT;
+  ck->next = 0;
+  ck->resume = 0;
+  ck->nIn = ck->nOut = ck->nCount = ck->nSaved = 0;
+  ck->nSavedIn = ck->nSavedOut = 0;
+  ck->count = NULL;
+  ck->saved = NULL;
+}
+
+/* void setCkptInt()
+ * Sets the number of reads between checkpoints.
+ */
+void setCkptInt(Ckpt* ck, char* arg) {
+  char* endptr;
+  ck->every = (int) strtol(arg, &endptr, 10);
+  if (*endptr != '\0' || ck->every <= 0)
+    exit(ckptError(arg, ERRCKINT));
+}
+
+/* void loadCkpt()
+ * Loads a checkpoint to resume from. If there is no
+ *   checkpoint file, the run begins from the start.
+ */
+void loadCkpt(Ckpt* ck) {
+  if (ck->file == NULL || ! ck->resume)
+    return;
+  FILE* in = fopen(ck->file, "r");
+  if (in == NULL) {
+    ck->resume = 0;
+    return;
+  }
+
+  char tok[32];
+  if (fscanf(in, "%31s", tok) != 1 || strcmp(tok, CKPTHEAD))
+    exit(ckptError(ck->file, ERRCKLOAD));
+  while (fscanf(in, "%31s", tok) == 1) {
+    if (! strcmp(tok, "in")) {
+      if (ck->nSavedIn == CKPTMAX || fscanf(in, "%lld %lld",
+          &ck->in[ck->nSavedIn].pos, &ck->in[ck->nSavedIn].voff) != 2)
+        exit(ckptError(ck->file, ERRCKLOAD));
+      ck->nSavedIn++;
+    } else if (! strcmp(tok, "out")) {
+      if (ck->nSavedOut == CKPTMAX || fscanf(in, "%lld",
+          &ck->out[ck->nSavedOut].pos) != 1)
+        exit(ckptError(ck->file, ERRCKLOAD));
+      ck->nSavedOut++;
+    } else if (! strcmp(tok, "count")) {
+      ck->saved = (int*) realloc(ck->saved,
+        (ck->nSaved + 1) * sizeof(int));
+      if (ck->saved == NULL ||
+          fscanf(in, "%d", ck->saved + ck->nSaved) != 1)
+        exit(ckptError(ck->file, ERRCKLOAD));
+      ck->nSaved++;
+    } else
+      exit(ckptError(ck->file, ERRCKLOAD));
+  }
+  fclose(in);
+}
+
+/* int ckptWrite()
+ * Adds an output file to the checkpoint. When resuming,
+ *   the file is truncated to its saved position and opened
+ *   for appending (returns 1); otherwise, the caller opens it.
+ */
+int ckptWrite(Ckpt* ck, char* outFile, File* out, int gz) {
+  if (ck->file == NULL)
+    return 0;
+  if (ck->nOut == CKPTMAX)
+    exit(ckptError(outFile, ERRCKMATCH));
+  CkptFile* c = ck->out + ck->nOut++;
+  c->name = outFile;
+  c->f = out;
+  c->gz = gz;
+  c->last = 0;
+  if (! ck->resume)
+    return 0;
+  if (ck->nOut > ck->nSavedOut)
+    exit(ckptError(ck->file, ERRCKMATCH));
+
+  // same name as opened for writing (".gz" added if needed)
+  char* name = outFile;
+  int len = strlen(outFile);
+  if (gz && (len < strlen(GZEXT) ||
+      strcmp(outFile + len - strlen(GZEXT), GZEXT))) {
+    name = (char*) malloc(len + strlen(GZEXT) + 1);
+    if (name == NULL)
+      exit(ckptError(outFile, ERRCKOUT));
+    strcpy(name, outFile);
+    strcat(name, GZEXT);
+  }
+
+  // truncate to saved position
+  struct stat st;
+  if (stat(name, &st) || st.st_size < c->pos ||
+      truncate(name, (off_t) c->pos))
+    exit(ckptError(name, ERRCKOUT));
+  if (gz) {
+    out->gzf = gzopen(name, "a");
+    if (out->gzf == NULL)
+      exit(ckptError(name, ERRCKOUT));
+  } else {
+    out->f = fopen(name, "r+");
+    if (out->f == NULL || fseeko(out->f, 0, SEEK_END))
+      exit(ckptError(name, ERRCKOUT));
+  }
+  if (name != outFile)
+    free(name);
+  return 1;
+}
+
+/* void ckptRead()
+ * Adds an input file (already opened at raw offset 'st') to
+ *   the checkpoint. When resuming, the file is reopened at
+ *   its saved position.
+ */
+void ckptRead(Ckpt* ck, char* inFile, File* in, int gz,
+    long long st, Shard* sh) {
+  if (ck->file == NULL)
+    return;
+  if (ck->nIn == CKPTMAX)
+    exit(ckptError(inFile, ERRCKMATCH));
+  CkptFile* c = ck->in + ck->nIn++;
+  c->name = inFile;
+  c->f = in;
+  c->gz = gz;
+  c->bgzf = gz && isBgzf(inFile);
+  c->base = 0;
+  c->blk = st;
+  c->blkPos = 0;
+  if (! ck->resume)
+    return;
+  if (ck->nIn > ck->nSavedIn)
+    exit(ckptError(ck->file, ERRCKMATCH));
+
+  if ( (gz && gzclose(in->gzf) != Z_OK) || (! gz && fclose(in->f)) )
+    exit(ckptError(inFile, ERRCKLOAD));
+  c->base = reopenShard(inFile, in, gz, c->bgzf ? c->voff : -1,
+    c->pos, sh);
+  if (c->bgzf) {
+    c->blk = c->voff >> 16;
+    c->blkPos = c->base;
+  }
+}
+
+/* void ckptCount()
+ * Adds a counter to the checkpoint. The first one added
+ *   should be the number of reads analyzed.
+ */
+void ckptCount(Ckpt* ck, int* count) {
+  if (ck->file == NULL)
+    return;
+  ck->count = (int**) realloc(ck->count,
+    (ck->nCount + 1) * sizeof(int*));
+  if (ck->count == NULL)
+    exit(ckptError(ck->file, ERRCKLOAD));
+  ck->count[ck->nCount++] = count;
+}
+
+/* void ckptRestore()
+ * Restores the counters when resuming. Sets the read
+ *   count of the next checkpoint.
+ */
+void ckptRestore(Ckpt* ck) {
+  if (ck->file == NULL)
+    return;
+  if (ck->resume) {
+    if (ck->nSaved != ck->nCount || ck->nSavedIn != ck->nIn ||
+        ck->nSavedOut != ck->nOut)
+      exit(ckptError(ck->file, ERRCKMATCH));
+    for (int i = 0; i < ck->nCount; i++)
+      *ck->count[i] = ck->saved[i];
+  }
+  ck->next = (ck->nCount ? *ck->count[0] : 0) + ck->every;
+}
+
+/* void saveCkpt()
+ * Flushes the output files and writes a checkpoint.
+ *   The checkpoint is written to a temporary file first,
+ *   so an interrupted write leaves the previous one intact.
+ */
+void saveCkpt(Ckpt* ck) {
+  // flush output files
+  for (int i = 0; i < ck->nOut; i++) {
+    CkptFile* c = ck->out + i;
+    if (c->gz) {
+      // finish gzip member (unless nothing new was written,
+      //   to avoid empty members)
+      long long last = (long long) gztell(c->f->gzf);
+      if (last != c->last) {
+        if (gzflush(c->f->gzf, Z_FINISH) != Z_OK)
+          exit(ckptError(c->name, ERRCKOUT));
+        c->last = last;
+      }
+      c->pos = (long long) gzoffset(c->f->gzf);
+    } else {
+      if (fflush(c->f->f))
+        exit(ckptError(c->name, ERRCKOUT));
+      c->pos = (long long) ftello(c->f->f);
+    }
+  }
+
+  char* temp = (char*) malloc(strlen(ck->file) + strlen(CKPTTEMP) + 1);
+  if (temp == NULL)
+    exit(ckptError(ck->file, ERRCKOPEN));
+  strcpy(temp, ck->file);
+  strcat(temp, CKPTTEMP);
+  FILE* out = fopen(temp, "w");
+  if (out == NULL)
+    exit(ckptError(temp, ERRCKOPEN));
+
+  fprintf(out, "%s\n", CKPTHEAD);
+  for (int i = 0; i < ck->nIn; i++) {
+    CkptFile* c = ck->in + i;
+    long long pos = c->base + (c->gz ? (long long) gztell(c->f->gzf)
+      : (long long) ftello(c->f->f));
+    long long voff = c->bgzf ? bgzfVoff(c->name, &c->blk,
+      &c->blkPos, pos) : -1;
+    fprintf(out, "in\t%lld\t%lld\n", pos, voff);
+  }
+  for (int i = 0; i < ck->nOut; i++)
+    fprintf(out, "out\t%lld\n", ck->out[i].pos);
+  for (int i = 0; i < ck->nCount; i++)
+    fprintf(out, "count\t%d\n", *ck->count[i]);
+
+  if (fclose(out) || rename(temp, ck->file))
+    exit(ckptError(ck->file, ERRCKOPEN));
+  free(temp);
+  ck->next = *ck->count[0] + ck->every;
+}
+
+/* void endCkpt()
+ * Removes the checkpoint file after a completed run.
+ */
+void endCkpt(Ckpt* ck) {
+  if (ck->file != NULL)
+    remove(ck->file);
+  free(ck->count);
+  free(ck->saved);
+}
@@ -0,0 +1,69 @@
+/*
+  October 2026
+
+  Header file for checkpoint.c.
+*/
+
+#define CKPTMAX     8        // maximum number of input/output files
+#define DEFCKPT     1000000  // default reads between checkpoints
+#define CKPTTEMP    ".tmp"   // extension for checkpoint being written
+#define CKPTHEAD    "#checkpoint"
+#define GZEXT       ".gz"    // file extension for gzip compression
+
+// command-line parameters (shared by stitch, removePrimer)
+#define CKPTFILE    "-ck"
+#define CKPTINT     "-ci"
+#define RESUME      "-rs"
+
+// error messages
+#define ERRCKOPEN   0
+#define MERRCKOPEN  ": cannot open checkpoint file"
+#define ERRCKLOAD   1
+#define MERRCKLOAD  ": cannot load checkpoint"
+#define ERRCKMATCH  2
+#define MERRCKMATCH ": checkpoint does not match the current run"
+#define ERRCKOUT    3
+#define MERRCKOUT   ": cannot restore output file from checkpoint"
+#define ERRCKINT    4
+#define MERRCKINT   ": checkpoint interval must be greater than 0"
+
+typedef struct ckptFile {
+  char* name;
+  File* f;
+  int gz;
+  int bgzf;          // BGZF compressed input
+  long long base;    // stream position at which input was opened
+  long long blk;     // current BGZF block of input
+  long long blkPos;  //   (and its stream position)
+  long long pos;     // position loaded from checkpoint
+  long long voff;    // BGZF virtual offset loaded from checkpoint
+  long long last;    // bytes written to gzip output at last checkpoint
+} CkptFile;
+
+typedef struct ckpt {
+  char* file;        // checkpoint file (NULL = no checkpoints)
+  int every;         // reads between checkpoints
+  long long next;    // read count of next checkpoint
+  int resume;        // resuming from a checkpoint
+  int nIn;
+  CkptFile in[CKPTMAX];
+  int nOut;
+  CkptFile out[CKPTMAX];
+  int nCount;        // counters saved in checkpoint (the 1st is
+  int** count;       //   the number of reads analyzed)
+  int nSaved;        // counter values loaded from checkpoint
+  int* saved;
+  int nSavedIn;      // number of files in checkpoint
+  int nSavedOut;
+} Ckpt;
+
+void initCkpt(Ckpt* ck);
+void setCkptInt(Ckpt* ck, char* arg);
+void loadCkpt(Ckpt* ck);
+int ckptWrite(Ckpt* ck, char* outFile, File* out, int gz);
+void ckptRead(Ckpt* ck, char* inFile, File* in, int gz,
+  long long st, Shard* sh);
+void ckptCount(Ckpt* ck, int* count);
+void ckptRestore(Ckpt* ck);
+void saveCkpt(Ckpt* ck);
+void endCkpt(Ckpt* ck);
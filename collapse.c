@@ -0,0 +1,224 @@
+/*
+  October 2026
+
+  Collapsing reads with identical sequences (and amplicon
+    labels, as added by removePrimer) into one record.
+  The record is named for the first read, with the number
+    of reads appended (";size=<int>"), and has the maximum
+    quality score of the reads at each position. A mapping
+    file lists the reads of each record, with their quality
+    scores, in the order of the records, so that alignments
+    can be re-expanded to the original reads (expandSAM.pl).
+  All reads are held in memory until the end of the run.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+#include "shard.h"
+#include "collapse.h"
+
+/* int clError()
+ * Prints an error message.
+ */
+static int clError(char* msg, int err) {
+  char* msg2;
+  if (err == ERRCLOPEN) msg2 = MERRCLOPEN;
+  else if (err == ERRCLMEM) msg2 = MERRCLMEM;
+  else msg2 = "Unknown error";
+
+  fprintf(stderr, "Error! %s%s\n", msg, msg2);
+  return -1;
+}
+
+/* void* clAlloc()
+ * Allocates (or resizes) a heap block.
+ */
+static void* clAlloc(void* ptr, size_t size) {
+  void* ans = realloc(ptr, size);
+  if (ans == NULL)
+    exit(clError("", ERRCLMEM));
+  return ans;
+}
+
+/* char* clCopy()
+ * Returns a heap copy of the first 'len' chars of 'str'.
+ */
+static char* clCopy(char* str, int len) {
+  char* ans = (char*) clAlloc(NULL, len + 1);
+  memcpy(ans, str, len);
+  ans[len] = '\0';
+  return ans;
+}
+
+/* void initCollapse()
+ * Initializes the collapsing info (no collapsing).
+ */
+void initCollapse(Collapse* cl) {
+  cl->file = NULL;
+  cl->seq = NULL;
+  cl->nSeq = cl->maxSeq = 0;
+  cl->table = NULL;
+  cl->tableSize = 0;
+  cl->read = NULL;
+  cl->nRead = cl->maxRead = 0;
+}
+
+/* unsigned int hash()
+ * Returns the hash of a string (FNV-1a).
+ */
+static unsigned int hash(char* str) {
+  unsigned int h = 2166136261u;
+  for (; *str != '\0'; str++) {
+    h ^= (unsigned char) *str;
+    h *= 16777619u;
+  }
+  return h;
+}
+
+/* void growTable()
+ * Doubles the size of the hash table.
+ */
+static void growTable(Collapse* cl) {
+  free(cl->table);
+  cl->tableSize = cl->tableSize ? 2 * cl->tableSize : CLTABLE;
+  cl->table = (int*) clAlloc(NULL, cl->tableSize * sizeof(int));
+  for (int i = 0; i < cl->tableSize; i++)
+    cl->table[i] = -1;
+  for (int i = 0; i < cl->nSeq; i++) {
+    unsigned int j = hash(cl->seq[i].key) & (cl->tableSize - 1);
+    while (cl->table[j] != -1)
+      j = (j + 1) & (cl->tableSize - 1);
+    cl->table[j] = i;
+  }
+}
+
+/* int getLabel()
+ * Finds the amplicon label in a header (the tokens
+ *   "<amplicon> fwd|rev [both]" at the end, or the SAM tag
+ *   "XP:Z:..."). Returns the index of its start (the end of
+ *   the header if none).
+ */
+static int getLabel(char* head, int len) {
+  // find "fwd" or "rev" token, and the token before it
+  int prev = -1, cur = -1;
+  for (int i = 0; i < len; i++) {
+    if (head[i] != ' ' || i + 1 == len || head[i + 1] == ' ')
+      continue;
+    prev = cur;
+    cur = i + 1;
+    if (len - cur >= 5 && !strncmp(head + cur, "XP:Z:", 5))
+      return cur;
+    if (prev != -1 && len - cur >= 3 &&
+        (!strncmp(head + cur, "fwd", 3) || !strncmp(head + cur, "rev", 3)) &&
+        (cur + 3 == len || head[cur + 3] == ' '))
+      return prev;
+  }
+  return len;
+}
+
+/* void collapseRead()
+ * Adds a read to the collapsed records. The header should
+ *   begin with '@' (or '>'); the quality scores are NULL
+ *   for fasta.
+ */
+void collapseRead(Collapse* cl, char* head, char* seq, int len,
+    char* qual) {
+  // create key: amplicon label, tab, sequence
+  int hLen = strcspn(head, "\r\n");
+  int lab = getLabel(head, hLen);
+  int kLen = hLen - lab + 1 + len;
+  char* key = (char*) clAlloc(NULL, kLen + 1);
+  memcpy(key, head + lab, hLen - lab);
+  key[hLen - lab] = '\t';
+  memcpy(key + hLen - lab + 1, seq, len);
+  key[kLen] = '\0';
+
+  // find in hash table
+  if (2 * (cl->nSeq + 1) > cl->tableSize)
+    growTable(cl);
+  unsigned int j = hash(key) & (cl->tableSize - 1);
+  while (cl->table[j] != -1 && strcmp(cl->seq[cl->table[j]].key, key))
+    j = (j + 1) & (cl->tableSize - 1);
+
+  // save read
+  if (cl->nRead == cl->maxRead) {
+    cl->maxRead = cl->maxRead ? 2 * cl->maxRead : CLTABLE;
+    cl->read = (ClRead*) clAlloc(cl->read, cl->maxRead * sizeof(ClRead));
+  }
+  ClRead* r = cl->read + cl->nRead;
+  r->name = clCopy(head + 1, strcspn(head + 1, " \t\r\n"));
+  r->qual = (qual == NULL ? NULL : clCopy(qual, len));
+  r->next = -1;
+
+  ClSeq* s;
+  if (cl->table[j] == -1) {
+    // new sequence
+    if (cl->nSeq == cl->maxSeq) {
+      cl->maxSeq = cl->maxSeq ? 2 * cl->maxSeq : CLTABLE;
+      cl->seq = (ClSeq*) clAlloc(cl->seq, cl->maxSeq * sizeof(ClSeq));
+    }
+    cl->table[j] = cl->nSeq;
+    s = cl->seq + cl->nSeq++;
+    s->head = clCopy(head + 1, hLen - 1);
+    s->key = key;
+    s->seq = key + hLen - lab + 1;
+    s->qual = (qual == NULL ? NULL : clCopy(qual, len));
+    s->count = 1;
+    s->first = cl->nRead;
+  } else {
+    // repeated sequence: keep max. quality scores
+    s = cl->seq + cl->table[j];
+    free(key);
+    if (qual != NULL)
+      for (int i = 0; i < len; i++)
+        if (qual[i] > s->qual[i])
+          s->qual[i] = qual[i];
+    s->count++;
+    cl->read[s->last].next = cl->nRead;
+  }
+  s->last = cl->nRead++;
+}
+
+/* void writeCollapse()
+ * Writes the collapsed records and the mapping file.
+ *   Frees the memory.
+ */
+void writeCollapse(Collapse* cl, File out, int gz, int fastq) {
+  FILE* map = fopen(cl->file, "w");
+  if (map == NULL)
+    exit(clError(cl->file, ERRCLOPEN));
+  fprintf(map, "%s\n", CLHEAD);
+
+  for (int i = 0; i < cl->nSeq; i++) {
+    ClSeq* s = cl->seq + i;
+    int nLen = strcspn(s->head, " \t");
+    gz ? gzprintf(out.gzf, "%c%.*s%s%d%s\n%s\n", fastq ? '@' : '>',
+      nLen, s->head, CLSIZE, s->count, s->head + nLen, s->seq)
+      : fprintf(out.f, "%c%.*s%s%d%s\n%s\n", fastq ? '@' : '>',
+      nLen, s->head, CLSIZE, s->count, s->head + nLen, s->seq);
+    if (fastq)
+      gz ? gzprintf(out.gzf, "+\n%s\n", s->qual)
+        : fprintf(out.f, "+\n%s\n", s->qual);
+
+    // list reads
+    for (int j = s->first; j != -1; j = cl->read[j].next) {
+      ClRead* r = cl->read + j;
+      fprintf(map, "%.*s%s%d\t%s\t%s\n", nLen, s->head, CLSIZE,
+        s->count, r->name, r->qual == NULL ? "*" : r->qual);
+      free(r->name);
+      free(r->qual);
+    }
+    free(s->head);
+    free(s->key);
+    free(s->qual);
+  }
+
+  if (fclose(map))
+    exit(clError(cl->file, ERRCLOPEN));
+  free(cl->seq);
+  free(cl->table);
+  free(cl->read);
+  initCollapse(cl);
+}
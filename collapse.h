@@ -0,0 +1,51 @@
+/*
+  October 2026
+
+  Header file for collapse.c.
+*/
+
+#define CLSIZE      ";size="  // multiplicity, appended to read name
+#define CLTABLE     1024      // initial size of hash table
+#define CLHEAD      "#Collapsed\tRead\tQual"
+
+// command-line parameters (shared by removePrimer, qualTrim)
+#define CLFILE      "-cl"
+
+// error messages
+#define ERRCLOPEN   0
+#define MERRCLOPEN  ": cannot open file for writing"
+#define ERRCLMEM    1
+#define MERRCLMEM   "Cannot allocate memory"
+
+typedef struct clRead {
+  char* name;        // name of read
+  char* qual;        // quality scores (NULL for fasta)
+  int next;          // next read with same sequence (-1 = none)
+} ClRead;
+
+typedef struct clSeq {
+  char* head;        // header of first read (without '@'/'>')
+  char* key;         // amplicon label, tab, sequence
+  char* seq;         //   (sequence portion of key)
+  char* qual;        // max. quality score at each position
+  int count;         // multiplicity
+  int first;         // first and last reads (in ClRead array)
+  int last;
+} ClSeq;
+
+typedef struct collapse {
+  char* file;        // mapping file (NULL = no collapsing)
+  ClSeq* seq;        // unique sequences, in order of first read
+  int nSeq;
+  int maxSeq;
+  int* table;        // hash table of indexes into seq (-1 = empty)
+  int tableSize;
+  ClRead* read;
+  int nRead;
+  int maxRead;
+} Collapse;
+
+void initCollapse(Collapse* cl);
+void collapseRead(Collapse* cl, char* head, char* seq, int len,
+  char* qual);
+void writeCollapse(Collapse* cl, File out, int gz, int fastq);
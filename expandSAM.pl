@@ -0,0 +1,137 @@
+#!/usr/bin/perl
+
+# Oct. 2026
+
+# Expand a SAM file of collapsed reads (qualTrim or
+#   removePrimer -cl) to the original reads: each record
+#   of a collapsed read is repeated for every read it
+#   represents, with the read's name and quality scores.
+
+use strict;
+use warnings;
+use FindBin;
+use lib $FindBin::RealBin;
+use Collapsed qw(isCollapsed);
+
+sub usage {
+  print q(Usage: perl expandSAM.pl  <infile>  <outfile>  <mapfile1>  [<mapfile2> ...]
+  Required:
+    <infile>    Input SAM file of collapsed reads, with the records in the
+                  order of the reads (e.g. bowtie2 --reorder); records
+                  may have been filtered, and SAM files of separate
+                  subsets of the reads (e.g. from alignAmp and bowtie2)
+                  may be concatenated, at the cost of another pass
+                  over the mapping files for each (can use '-' for STDIN)
+    <outfile>   Output SAM file (can use '-' for STDOUT)
+    <mapfile1>  Mapping file of the collapsed reads (-cl)
+    <mapfile2>  Additional mapping files, in the order in which the
+                  collapsed reads were concatenated
+);
+  exit;
+}
+
+usage() if (scalar @ARGV < 3 || $ARGV[0] eq "-h");
+
+open(SAM, $ARGV[0]) || die "Cannot open $ARGV[0]\n";
+open(OUT, ">$ARGV[1]") || die "Cannot open $ARGV[1] for writing\n";
+my @all = @ARGV[2 .. $#ARGV];
+my @maps = @all;
+my $map = shift @maps;
+open(MAP, $map) || die "Cannot open $map\n";
+
+# get the reads of a collapsed read from the mapping files
+#   (skipping any that are not in the SAM)
+my $next = "";  # next line of mapping files
+my $wrap = 0;   # mapping files restarted (for next SAM subset)
+sub getReads {
+  my $name = $_[0];
+  my @reads;
+  while (1) {
+    if (! $next) {
+      $next = <MAP>;
+      if (! $next) {
+        $next = "";
+        last if (@reads);
+        if (! @maps) {
+          die "Error! Collapsed read $name not found in mapping files\n",
+            "  (SAM records must be in the order of the reads, e.g. ",
+            "bowtie2 --reorder)\n" if ($wrap);
+          $wrap = 1;
+          @maps = @all;
+        }
+        close MAP;
+        $map = shift @maps;
+        open(MAP, $map) || die "Cannot open $map\n";
+        next;
+      }
+      if (substr($next, 0, 1) eq '#') {
+        $next = "";
+        next;
+      }
+    }
+    my $ln = $next;
+    chomp $ln;
+    my @spl = split("\t", $ln);
+    die "Error! $map is improperly formatted\n" if (scalar @spl < 3);
+    if ($spl[0] ne $name) {
+      last if (@reads);
+      $next = "";  # collapsed read not in SAM
+      next;
+    }
+    push @reads, "$spl[1]\t$spl[2]";
+    $next = "";
+    $wrap = 0;
+  }
+  return @reads;
+}
+
+my $count = 0;  # counting variables
+my $exp = 0;
+my @rec;        # records of current read
+my $last = "";  # name of current read
+while (1) {
+  my $line = <SAM>;
+  if ($line && substr($line, 0, 1) eq '@') {
+    print OUT $line;
+    next;
+  }
+  my @spl;
+  if ($line) {
+    chomp $line;
+    @spl = split("\t", $line);
+    die "Error! $ARGV[0] is improperly formatted\n" if (scalar @spl < 11);
+    if ($spl[0] eq $last) {
+      push @rec, [ @spl ];
+      next;
+    }
+  }
+
+  # expand records of previous read
+  if (@rec) {
+    $count++;
+    if (! isCollapsed($last)) {
+      print OUT join("\t", @{$_}), "\n" foreach @rec;
+    } else {
+      foreach my $read (getReads($last)) {
+        my ($name, $qual) = split("\t", $read);
+        foreach my $r (@rec) {
+          my @div = @{$r};
+          $div[0] = $name;
+          if ($div[10] ne '*' && $qual ne '*') {
+            $div[10] = ($div[1] & 0x10 ? reverse $qual : $qual);
+          }
+          print OUT join("\t", @div), "\n";
+        }
+        $exp++;
+      }
+    }
+  }
+  last if (! $line);
+  @rec = ( [ @spl ] );
+  $last = $spl[0];
+}
+close SAM;
+close OUT;
+close MAP;
+
+print STDERR "Reads in SAM: $count\nReads expanded: $exp\n";
@@ -8,6 +8,10 @@
 
 use strict;
 use warnings;
+use FindBin;
+use lib $FindBin::RealBin;
+use AltDB;
+use Collapsed qw(mult);
 
 sub usage {
   print q(Usage: perl filterSAM.pl  <infile1>  <infile2>  <infile3>  <infile4>  \
@@ -15,10 +19,13 @@ sub usage {
   Required:
     <infile1>  File containing input reads in fastq format, with primers removed
                  and amplicon identification in header (produced by removePrimer;
-                 may be gzip compressed, with ".gz" extension)
+                 may be gzip compressed, with ".gz" extension) -- or '-xp' to
+                 read the identification from the XP:Z tag of each SAM record
+                 (removePrimer -xp, bowtie2 --sam-append-comment) instead
     <infile2>  BED file listing locations of primers
     <infile3>  File listing alternative mapping locations and whether putative primers
-                 are exact/close (1) or way off (0) (produced by checkAltMapping.pl)
+                 are exact/close (1) or way off (0) (produced by checkAltMapping.pl,
+                 or its database [-db])
     <infile4>  Input SAM file (can use '-' for STDIN [e.g. piped in from samtools])
     <outfile>  Output SAM file (can use '-' for STDOUT [e.g. piped out to samtools])
   Optional:
@@ -33,14 +40,17 @@ sub usage {
 usage() if (scalar @ARGV < 5 || $ARGV[0] eq "-h");
 
 # open files
-if (substr($ARGV[0], -3) eq ".gz") {
+my $xp = ($ARGV[0] eq "-xp" ? 1 : 0);  # amplicon info from SAM tags
+if ($xp) {
+  # no reads to load
+} elsif (substr($ARGV[0], -3) eq ".gz") {
   die "Cannot open $ARGV[0]\n" if (! -f $ARGV[0]);
   open(FQ, "zcat $ARGV[0] |");
 } else {
   open(FQ, $ARGV[0]) || die "Cannot open $ARGV[0]\n";
 }
 open(BED, $ARGV[1]) || die "Cannot open $ARGV[1]\n";
-open(ALT, $ARGV[2]) || die "Cannot open $ARGV[2]\n";
+die "Cannot open $ARGV[2]\n" if (! -f $ARGV[2]);
 open(SAM, $ARGV[3]) || die "Cannot open $ARGV[3]\n";
 open(OUT, ">$ARGV[4]") || die "Cannot open $ARGV[4] for writing\n";
 if (scalar @ARGV > 5) {
@@ -90,24 +100,38 @@ while (my $line = <BED>) {
 }
 close BED;
 
+# index amplicons (reads are saved with the index)
+my @amps = sort keys %loc;
+my %idx;
+for (my $x = 0; $x < scalar @amps; $x++) {
+  $idx{$amps[$x]} = $x;
+}
+
 # load amplicon info for reads from fastq
-my %amp;  # saves amplicon and (one|both)
-my %dup;  # saves amplicon and (one|both) for reads listed
+my %amp;  # saves amplicon index and (one|both), as 2*index+both
+my %dup;  # saves amplicon index and (one|both) for reads listed
           #   multiple times (singletons, unjoined)
 my %seq;  # saves sequences for reads listed multiple times --
           #   used as 2nd key for %dup
 my $count = 0; my $cdup = 0;
 $/ = "\n";
-while (my $line = <FQ>) {
+while (! $xp && defined(my $line = <FQ>)) {
   next if (substr($line, 0, 1) ne '@');
   chomp $line;
 
-  # determine amplicon ID
+  # determine amplicon ID, and if both primers were removed
   my @spl = split(" ", $line);
   my $id = "";
+  my $bo = 0;
   for (my $x = 1; $x < scalar @spl; $x++) {
+    if ($spl[$x] =~ m/^XP:Z:(.+),(fwd|rev),(one|both)$/) {
+      $id = $1;
+      $bo = 1 if ($3 eq "both");
+      last;
+    }
     if ($spl[$x] eq "fwd" || $spl[$x] eq "rev") {
       $id = $spl[$x-1];
+      $bo = 1 if ($x < $#spl && $spl[$x+1] eq "both");
       last;
     }
   }
@@ -116,26 +140,21 @@ while (my $line = <FQ>) {
   my $que = substr($spl[0], 1);
 
   # check amplicon, and for duplicates
-  foreach my $am (keys %loc) {
-    if ($id eq $am) {
-      if (exists $amp{$que}) {
-        my @div = split("\t", $amp{$que});
-        if ($id ne $div[0]) {
-          warn "Warning! Primers do not match for read $que\n";
-          delete $amp{$que};
-          last;
-        }
-        # save previous to %dup
-        $dup{$que}{$seq{$que}} = $amp{$que};
-        chomp ($line = <FQ>);
-        $dup{$que}{$line} = "$am\t".($spl[$#spl] eq "both" ? "both" : "one");
-        $cdup++;
-      } else {
-        $amp{$que} = "$am\t".($spl[$#spl] eq "both" ? "both" : "one");
-        chomp ($line = <FQ>);
-        $seq{$que} = $line;  # save sequence in case of duplicate
-      }
-      last;
+  if (exists $idx{$id}) {
+    my $val = 2 * $idx{$id} + $bo;
+    if (! exists $amp{$que}) {
+      $amp{$que} = $val;
+      chomp ($line = <FQ>);
+      $seq{$que} = $line;  # save sequence in case of duplicate
+    } elsif ($amp{$que} >> 1 != $idx{$id}) {
+      warn "Warning! Primers do not match for read $que\n";
+      delete $amp{$que};
+    } else {
+      # save previous to %dup
+      $dup{$que}{$seq{$que}} = $amp{$que};
+      chomp ($line = <FQ>);
+      $dup{$que}{$line} = $val;
+      $cdup++;
     }
   }
 
@@ -149,27 +168,15 @@ while (my $line = <FQ>) {
     $line = <FQ>;
   }
 }
-close FQ;
+close FQ if (! $xp);
 #print "Reads: $count\n";
 #print "Unique: ", scalar keys %amp,
 #  "\nDuplicates: $cdup\n";
 %seq = ();
 
-# load alternative site information
-my %alt;
-while (my $line = <ALT>) {
-  next if (substr($line, 0, 1) eq '#');
-  chomp $line;
-  my @spl = split("\t", $line);
-  my $res = pop @spl;
-  die "Error! $ARGV[2] is improperly formatted\n"
-    if (scalar @spl < 5 || (($res != 0) && ($res != 1))); 
-  my @div = split('-', $spl[$#spl]);
-  for (my $x = $div[0]; $x < $div[$#div]+1; $x++) {
-    $alt{"$spl[0]\t$spl[1]"}{"$spl[2]\t$spl[3]\t$x"} = $res;
-  }
-}
-close ALT;
+# load alternative site information (ranges of positions,
+#   indexed by window)
+my $alt = AltDB->new($ARGV[2]);
 
 # load realignments
 my %aln;  # for new alignments
@@ -183,9 +190,10 @@ if (scalar @ARGV > 5) {
     $total++;
     my @spl = split("\t", $line);
     die "Error! $ARGV[5] is improperly formatted\n" if (scalar @spl < 10);
-    $tot{"$spl[1] $spl[3]"}++;
+    my $n = mult($spl[0]);  # reads represented (if collapsed)
+    $tot{"$spl[1] $spl[3]"} += $n;
     if (($spl[$#spl-1] eq "external") && ($spl[$#spl] > $maxExt)) {
-      $xExt{"$spl[1] $spl[3]"}++;  # external artifact
+      $xExt{"$spl[1] $spl[3]"} += $n;  # external artifact
       next;
     }
 
@@ -196,7 +204,7 @@ if (scalar @ARGV > 5) {
     $spl[3] =~ m/^(\d+)([ID])/;
     $len -= $1 if ($2 eq 'I');
     if ($spl[2] > (0.6*$len+0.6) / 5) {
-      $xInv{"$spl[1] $spl[3]"}++;  # invalid new alignment
+      $xInv{"$spl[1] $spl[3]"} += $n;  # invalid new alignment
       next;
     }
 
@@ -242,7 +250,7 @@ while ($line) {
         ($div[9] ne $spl[9] && $div[9] ne revComp($spl[9])
         && $div[9] ne '*'));
     }
-  } elsif (! exists $amp{$spl[0]}) {
+  } elsif (! ($xp ? xpAmp(@spl) : exists $amp{$spl[0]})) {
     # no amplicon info: save results, check for new alignment
     warn "Warning! No amplicon info for read $spl[0]\n";
     push @res, $line;
@@ -256,7 +264,7 @@ while ($line) {
     }
   } else {
     # load amplicon info for read
-    my @brk = split("\t", $amp{$spl[0]});
+    my @brk = split("\t", $xp ? xpAmp(@spl) : ampInfo($amp{$spl[0]}));
     my @cut = split("\t", $loc{$brk[0]});  # expected location: chr $cut[0],
                                            #   min pos $cut[1], max pos $cut[2]
 
@@ -298,16 +306,14 @@ while ($line) {
 
         # load removed-primer info
         my $pr = "";  # for primer name and (both|one)
-        if (exists $dup{$div[0]}) {
+        if ($xp) {
+          $pr = xpAmp(@div);
+        } elsif (exists $dup{$div[0]}) {
           my $test = ($rc ? revComp($div[9]) : $div[9]);
-          foreach my $seq (keys %{$dup{$div[0]}}) {
-            if ($test eq $seq) {
-              $pr = $dup{$div[0]}{$seq};
-              last;
-            }
-          }
-        } else {
-          $pr = $amp{$div[0]};
+          $pr = ampInfo($dup{$div[0]}{$test})
+            if (exists $dup{$div[0]}{$test});
+        } elsif (exists $amp{$div[0]}) {
+          $pr = ampInfo($amp{$div[0]});
         }
         if (!$pr) {
           warn "Warning! No removed-primer info for read $div[0]\n";
@@ -317,14 +323,15 @@ while ($line) {
         }
 
         # check alternative location
-        my $lc = ($rc ? '-' : '+')."\t$div[2]\t$pos"; # 2nd key to %alt
-        if ((! exists $alt{$pr}) || (! exists $alt{$pr}{$lc})) {
+        my $lc = ($rc ? '-' : '+')."\t$div[2]\t$pos";
+        my $res = $alt->lookup(split("\t", "$pr\t$lc"));
+        if (! defined $res) {
           warn "Warning! No alt. location info for read $div[0], $pr\t$lc\n";
           #push @res, $line;  # save mapping(?)
           $line = <SAM>;
           next;
         }
-        if ($alt{$pr}{$lc}) {
+        if ($res) {
           # a match: save the result
           push @res, $line;
         }
@@ -379,7 +386,7 @@ while ($line) {
           # save previous alignment info
           $rec2 .= "\tOP:i:$fun[3]\tOC:Z:$fun[5]";
           $idx = $x;
-          $yBetter{"$div[0] $div[2]"}++; # new alignment is better
+          $yBetter{"$div[0] $div[2]"} += mult($spl[0]); # new alignment is better
         } else {
           # compare CIGARs
           my $d = 0; my $i = 0;
@@ -392,17 +399,21 @@ while ($line) {
             $i -= $1 if ($2 eq 'I');
           }
           if (!$d && !$i) {
-            $xSame{"$div[0] $div[2]"}++;  # equiv. I/D
+            $xSame{"$div[0] $div[2]"} += mult($spl[0]);  # equiv. I/D
             $skip = 1 if ($fun[5] eq $div[5]);  # skip identical realignment
           } else {
-            $xWorse{"$div[0] $div[2]"}++;  # prev. alignment is better (or equal)
+            $xWorse{"$div[0] $div[2]"} += mult($spl[0]);  # prev. alignment is better (or equal)
           }
         }
       } else {
-        $yUnmap{"$div[0] $div[2]"}++;  # previously unmapped to correct loc.
+        $yUnmap{"$div[0] $div[2]"} += mult($spl[0]);  # previously unmapped to correct loc.
       }
 
       $rec2 .= "\tYT:Z:UU";
+      if ($xp) {
+        my @tag = grep(m/^XP:Z:/, @spl[11 .. $#spl]);
+        $rec2 .= "\t$tag[0]" if (@tag);
+      }
       if (@res && !$x) {
         my $oldAS = getTag("AS", split("\t", $res[$x]));
         $rec .= "\tXS:i:$oldAS";  # save new XS
@@ -456,7 +467,7 @@ if (scalar @ARGV > 6) {
   # count realignments not used
   foreach my $x (keys %aln) {
     my @div = split("\t", $aln{$x});
-    $xFil{"$div[0] $div[2]"}++;
+    $xFil{"$div[0] $div[2]"} += mult($x);
   }
 
   foreach my $x (sort keys %tot) {
@@ -481,6 +492,22 @@ if (scalar @ARGV > 6) {
 #print "Total realignments: $real\n",
 #  "  Primary maps: $pral\n" if (scalar @ARGV > 5);
 
+# amplicon and (one|both) of a read saved from the fastq
+sub ampInfo {
+  return $amps[$_[0] >> 1] . ($_[0] & 1 ? "\tboth" : "\tone");
+}
+
+# amplicon and (one|both) from the XP:Z tag of a SAM record
+#   (as saved in %amp), or "" if none
+sub xpAmp {
+  for (my $x = 11; $x < scalar @_; $x++) {
+    if ($_[$x] =~ m/^XP:Z:(.+),(fwd|rev),(one|both)$/) {
+      return (exists $loc{$1} ? "$1\t$3" : "");
+    }
+  }
+  return "";
+}
+
 # reverse-complement a sequence
 sub revComp {
   my $seq = $_[0];
@@ -27,6 +27,11 @@ sub usage {
               over those that have not
      -q     Option to keep only higher quality singleton
   Other options:
+     -s     Option to stream the inputs, which must list the reads in
+              the same order (as from getReads.py and removePrimer),
+              rather than loading <in1> into memory; singletons found
+              in one input only are printed in input order (rather
+              than those of <in1> sorted and at the end)
      -ve    Option to print summary counts to STDOUT
 );
   exit;
@@ -37,14 +42,14 @@ usage() if (scalar @ARGV < 3 || $ARGV[0] eq "-h");
 # open files
 my $gz = 0;
 if (substr($ARGV[0], -3) eq ".gz") {
-  die "Cannot open $ARGV[0]\n" if (! -f $ARGV[0]);
+  die "Cannot open $ARGV[0]\n" if (! -e $ARGV[0]);
   open(FQ1, "zcat $ARGV[0] |");
   $gz = 1;
 } else {
   open(FQ1, $ARGV[0]) || die "Cannot open $ARGV[0]\n";
 }
 if (substr($ARGV[1], -3) eq ".gz") {
-  die "Cannot open $ARGV[1]\n" if (! -f $ARGV[1]);
+  die "Cannot open $ARGV[1]\n" if (! -e $ARGV[1]);
   open(FQ2, "zcat $ARGV[1] |");
   $gz = 1;
 } else {
@@ -61,6 +66,7 @@ if ($gz) {
 my $chim = 0;
 my $bth = 0;
 my $qul = 0;
+my $strm = 0;
 my $verb = 0;
 for (my $x = 3; $x < scalar @ARGV; $x++) {
   if ($ARGV[$x] eq "-c") {
@@ -69,157 +75,197 @@ for (my $x = 3; $x < scalar @ARGV; $x++) {
     $bth = 1;
   } elsif ($ARGV[$x] eq "-q") {
     $qul = 1;
+  } elsif ($ARGV[$x] eq "-s") {
+    $strm = 1;
   } elsif ($ARGV[$x] eq "-ve") {
     $verb = 1;
   }
 }
 
-# load info from first file
-my %pr;   # which amplicon the read came from
-my %qual; # avg. quality score
-my %seq;  # header, sequence, and qual scores
-my %both; # boolean if read had both primers removed
-my $count = 0;
-while (my $q = <FQ1>) {
-  next if (substr($q, 0, 1) ne "@");
-  my $w = <FQ1>;
-  my $e = <FQ1>;
-  my $r = <FQ1>;
-  my @spl = split(" ", $q);
-  die "Error! Read $spl[0] is duplicated in $ARGV[0]\n"
-    if (exists $seq{$spl[0]});
+my $print = 0; my $crem = 0;
+my $brem = 0; my $qrem = 0;  # counting variables
+my $count1 = 0; my $count2 = 0;
+if ($strm) {
+  streamReads();
+} else {
+  loadReads();
+}
+close FQ1;
+close FQ2;
+close OUT;
 
-  # determine amplicon ID
-  my $id = "";
-  my $bot = 0;
-  for (my $x = 1; $x < scalar @spl; $x++) {
-    if ($spl[$x] eq "fwd" || $spl[$x] eq "rev") {
-      $id = $spl[$x-1];
-      $bot = 1 if ($x + 1 <= $#spl && $spl[$x+1] eq "both");
-      last;
+if ($verb) {
+  print "Reads in $ARGV[0]: $count1",
+    "\nReads in $ARGV[1]: $count2",
+    "\nReads printed to $ARGV[2]: $print";
+  print "\nReads removed for being chimeras: $crem" if ($chim);
+  print "\nReads removed for not having both primers: $brem" if ($bth);
+  print "\nReads removed for being lower quality: $qrem" if ($qul);
+  print "\n";
+}
+
+# load reads from first file, then parse second
+sub loadReads {
+  my %seq;  # read records of first file
+  while (my $r1 = getRead(\*FQ1, $ARGV[0])) {
+    die "Error! Read $r1->[0] is duplicated in $ARGV[0]\n"
+      if (exists $seq{$r1->[0]});
+    $seq{$r1->[0]} = $r1;
+    $count1++;
+  }
+
+  my %dup;  # to check for duplicates
+  while (my $r2 = getRead(\*FQ2, $ARGV[1])) {
+    die "Error! Read $r2->[0] is duplicated in $ARGV[1]\n"
+      if (exists $dup{$r2->[0]});
+    $dup{$r2->[0]} = 1;
+    $count2++;
+
+    # check for duplicate
+    if (exists $seq{$r2->[0]}) {
+      filterPair($seq{$r2->[0]}, $r2);
+      delete $seq{$r2->[0]};
+    } else {
+      # not a duplicate
+      print OUT $r2->[3];
+      $print++;
     }
   }
-  die "Error! $ARGV[0] is improperly formatted:\n",
-    "  no amplicon ID in $q\n" if (!$id);
 
-  $pr{$spl[0]} = $id;
-  $seq{$spl[0]} = $q . $w . $e . $r;
-  $both{$spl[0]} = $bot;
+  # print remaining singletons from 1st file
+  foreach my $re (sort keys %seq) {
+    print OUT $seq{$re}[3];
+    $print++;
+  }
+}
 
-  # save avg qual score
-  if ($qul) {
-    chomp $r;
-    my $tot = 0;
-    for (my $x = 0; $x < length $r; $x++) {
-      $tot += ord(substr($r, $x, 1)) - 33; 
+# walk both files in parallel: reads not yet matched are held
+#   (with their names) until a read of the other file matches
+#   one, when those preceding it are printed as singletons;
+#   the next read is taken from the file with fewer reads held
+#   (ties to <in1>), so those held are bounded by the longest
+#   run of reads dropped from one file, whatever the rates
+sub streamReads {
+  my @pend = ([], []);  # reads not yet matched, for each file
+  my @name = ({}, {});  # names of reads in @pend
+  my @fh = (\*FQ1, \*FQ2);
+  my @eof = (0, 0);
+  while (! $eof[0] || ! $eof[1]) {
+    my $x = ($eof[0] || (! $eof[1] && @{$pend[1]} < @{$pend[0]})) ?
+      1 : 0;
+    my $r = getRead($fh[$x], $ARGV[$x]);
+    if (! $r) {
+      $eof[$x] = 1;
+      next;
+    }
+    $x ? $count2++ : $count1++;
+    my $y = 1 - $x;  # other file
+    if (exists $name[$y]{$r->[0]}) {
+      # print unmatched reads of both files, then the pair
+      flushReads($pend[$x], $name[$x], scalar @{$pend[$x]});
+      my $idx = 0;
+      $idx++ while ($pend[$y][$idx][0] ne $r->[0]);
+      flushReads($pend[$y], $name[$y], $idx);
+      my $o = shift @{$pend[$y]};
+      delete $name[$y]{$o->[0]};
+      filterPair($x ? ($o, $r) : ($r, $o));
+    } else {
+      die "Error! Read $r->[0] is duplicated in $ARGV[$x]\n"
+        if (exists $name[$x]{$r->[0]});
+      push @{$pend[$x]}, $r;
+      $name[$x]{$r->[0]} = 1;
     }
-    $qual{$spl[0]} = $tot / length $r;
   }
+  for (my $x = 0; $x < 2; $x++) {
+    flushReads($pend[$x], $name[$x], scalar @{$pend[$x]});
+  }
+}
 
-  $count++;
+# print (as singletons) the first $n reads held for a file
+sub flushReads {
+  my ($pend, $name, $n) = @_;
+  for (my $x = 0; $x < $n; $x++) {
+    my $r = shift @$pend;
+    delete $name->{$r->[0]};
+    print OUT $r->[3];
+    $print++;
+  }
 }
-close FQ1;
-print "Reads in $ARGV[0]: $count\n" if ($verb);
 
-# parse second file
-my $print = 0; my $crem = 0;
-my $brem = 0; my $qrem = 0;  # counting variables
-$count = 0;
-my %dup;  # to check for duplicates
-while (my $q = <FQ2>) {
-  next if (substr($q, 0, 1) ne "@");
-  my $w = <FQ2>;
-  my $e = <FQ2>;
-  my $r = <FQ2>;
+# apply filters to a pair of singletons (same read name)
+sub filterPair {
+  my ($r1, $r2) = @_;
+
+  # skip chimeras
+  if ($chim && $r1->[1] ne $r2->[1]) {
+    $crem += 2;
+    return;
+  }
+
+  # check if one has both primers removed
+  if ($bth && $r1->[2] != $r2->[2]) {
+    print OUT ($r1->[2] ? $r1->[3] : $r2->[3]);
+    $print++;
+    $brem++;
+    return;
+  }
+
+  # compare quality scores
+  if ($qul) {
+    # print higher avg -- if tie, choose 1st
+    print OUT ($r2->[4] > $r1->[4] ? $r2->[3] : $r1->[3]);
+    $print++;
+    $qrem++;
+  } else {
+    # print both
+    print OUT $r1->[3], $r2->[3];
+    $print += 2;
+  }
+}
+
+# load next read from a file: name, amplicon ID, boolean if
+#   both primers removed, fastq record, and avg. quality score
+#   (undef at end of file)
+sub getRead {
+  my ($fh, $file) = @_;
+  my $q;
+  while ($q = <$fh>) {
+    last if (substr($q, 0, 1) eq "@");
+  }
+  return undef if (! $q);
+  my $w = <$fh>;
+  my $e = <$fh>;
+  my $r = <$fh>;
   my @spl = split(" ", $q);
-  die "Error! Read $spl[0] is duplicated in $ARGV[1]\n"
-    if (exists $dup{$spl[0]});
-  $dup{$spl[0]} = 1;
 
   # determine amplicon ID
   my $id = "";
   my $bot = 0;
   for (my $x = 1; $x < scalar @spl; $x++) {
+    if ($spl[$x] =~ m/^XP:Z:(.+),(fwd|rev),(one|both)$/) {
+      $id = $1;
+      $bot = 1 if ($3 eq "both");
+      last;
+    }
     if ($spl[$x] eq "fwd" || $spl[$x] eq "rev") {
       $id = $spl[$x-1];
       $bot = 1 if ($x + 1 <= $#spl && $spl[$x+1] eq "both");
       last;
     }
   }
-  die "Error! $ARGV[1] is improperly formatted:\n",
+  die "Error! $file is improperly formatted:\n",
     "  no amplicon ID in $q\n" if (!$id);
-  $count++;
 
-  # check for duplicate
-  if (exists $seq{$spl[0]}) {
-
-    # skip chimeras
-    if ($chim && $pr{$spl[0]} ne $id) {
-      delete $seq{$spl[0]};
-      $crem += 2;
-      next;
-    }
-
-    # check if one has both primers removed
-    if ($bth) {
-      if ($both{$spl[0]} && !$bot) {
-        print OUT $seq{$spl[0]};      
-        delete $seq{$spl[0]};
-        $print++;
-        $brem++;
-        next;
-      } elsif ($bot && !$both{$spl[0]}) {
-        print OUT "$q$w$e$r";
-        delete $seq{$spl[0]};
-        $print++;
-        $brem++;
-        next;
-      }
-    }
-
-    # compare quality scores
-    if ($qul) {
-      chomp $r;
-      my $tot = 0;
-      for (my $x = 0; $x < length $r; $x++) {
-        $tot += ord(substr($r, $x, 1)) - 33; 
-      }
-      # print higher avg -- if tie, choose 1st
-      if ($tot / length $r > $qual{$spl[0]}) {
-        print OUT "$q$w$e$r\n";
-      } else {
-        print OUT $seq{$spl[0]};
-      }
-      $print++;
-      $qrem++;
-    } else {
-      # print both
-      print OUT "$seq{$spl[0]}$q$w$e$r";
-      $print += 2;
+  # save avg qual score
+  my $avg = 0;
+  if ($qul) {
+    chomp (my $s = $r);
+    my $tot = 0;
+    for (my $x = 0; $x < length $s; $x++) {
+      $tot += ord(substr($s, $x, 1)) - 33;
     }
-    delete $seq{$spl[0]};
-
-  } else {
-    # not a duplicate
-    print OUT "$q$w$e$r";
-    $print++;
+    $avg = $tot / length $s;
   }
 
-}
-close FQ2;
-
-# print remaining singletons from 1st file
-foreach my $re (sort keys %seq) {
-  print OUT $seq{$re};
-  $print++;
-}
-close OUT;
-
-if ($verb) {
-  print "Reads in $ARGV[1]: $count",
-    "\nReads printed to $ARGV[2]: $print";
-  print "\nReads removed for being chimeras: $crem" if ($chim);
-  print "\nReads removed for not having both primers: $brem" if ($bth);
-  print "\nReads removed for being lower quality: $qrem" if ($qul);
-  print "\n";
+  return [$spl[0], $id, $bot, $q . $w . $e . $r, $avg];
 }
@@ -61,7 +61,7 @@ open(IN, $ARGV[0]) || die "Cannot open $ARGV[0]\n";
 
 # get other command-line parameters
 my @opts;
-my %reg;  # target regions
+my %reg;  # target regions: sorted, merged intervals for each chrom
 my %minHP; my $maxHP = 100;  # maximum HP value
 my $minAF = 0; my $minAO = 0; my $minDP = 0;
 my $minID = 0; my $minCT = 0;
@@ -140,9 +140,7 @@ for (my $x = 2; $x < scalar @ARGV; $x++) {
               $st = $div[2] + 1;
               $end = $spl[1] + 1;
             }
-            for (my $y = $st; $y < $end; $y++) {
-              $reg{"$spl[0]\t$y"} = 1;
-            }
+            push @{$reg{$spl[0]}}, [$st, $end - 1] if ($st < $end);
           }
           delete $pos{$spl[3]};
         } else {
@@ -153,6 +151,20 @@ for (my $x = 2; $x < scalar @ARGV; $x++) {
       die "Error! No target regions loaded from $ARGV[$x]\n"
         if (scalar keys %reg == 0);
 
+      # sort and merge overlapping intervals
+      foreach my $chr (keys %reg) {
+        my @sort = sort { $a->[0] <=> $b->[0] } @{$reg{$chr}};
+        my @merge = (shift @sort);
+        foreach my $r (@sort) {
+          if ($r->[0] > $merge[$#merge][1] + 1) {
+            push @merge, $r;
+          } elsif ($r->[1] > $merge[$#merge][1]) {
+            $merge[$#merge][1] = $r->[1];
+          }
+        }
+        $reg{$chr} = \@merge;
+      }
+
     } else {
       die "Error! Unknown CL option: $ARGV[$x]\n";
     }
@@ -213,15 +225,10 @@ while (my $line = <IN>) {
     my $pos = 0;
     while ($cig =~ m/(\d+)([IDMX])/g) {
       if ($2 ne 'M') {
-        for (my $y = 0; $y < $1; $y++) {
-          my $loc = $spl[1] + $pos + $y;
-          if (exists $reg{"$spl[0]\t$loc"}) {
-            $targ = 1;
-            last;
-          }
-          last if ($2 eq 'I');
-        }
-      } 
+        # check positions of variant (1st only for insertion)
+        my $loc = $spl[1] + $pos;
+        $targ = inReg($spl[0], $loc, ($2 eq 'I' ? $loc : $loc + $1 - 1));
+      }
       last if ($targ);
       $pos += $1 if ($2 ne 'I');
     }
@@ -311,3 +318,21 @@ if ($verb) {
   print "\n  Variant in/near homopolymer run: $xHP" if (scalar keys %minHP > 0);
   print "\n";
 }
+
+# determine if any position in [st, end] is within a
+#   target region (binary search of merged intervals)
+sub inReg {
+  my ($chr, $st, $end) = @_;
+  my $list = $reg{$chr};
+  return 0 if (! $list);
+  my $lo = 0; my $hi = $#$list;
+  while ($lo < $hi) {
+    my $mid = ($lo + $hi + 1) >> 1;
+    if ($list->[$mid][0] <= $end) {
+      $lo = $mid;
+    } else {
+      $hi = $mid - 1;
+    }
+  }
+  return ($list->[$lo][0] <= $end && $list->[$lo][1] >= $st ? 1 : 0);
+}
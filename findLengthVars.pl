@@ -8,6 +8,9 @@
 
 use strict;
 use warnings;
+use FindBin;
+use lib $FindBin::RealBin;
+use Collapsed qw(mult);
 
 sub usage {
   print q(Usage: perl findLengthVars.pl  <infile1>  <infile2>  <outfile>  <percent>  <distance>
@@ -99,6 +102,10 @@ while (my $line = <IN>) {
   my @spl = split(" ", $line);
   my $id = "";
   for (my $x = 1; $x < scalar @spl; $x++) {
+    if ($spl[$x] =~ m/^XP:Z:(.+),(fwd|rev),(one|both)$/) {
+      $id = $1;
+      last;
+    }
     if ($spl[$x] eq "fwd" || $spl[$x] eq "rev") {
       $id = $spl[$x-1];
       last;
@@ -118,9 +125,10 @@ while (my $line = <IN>) {
   chomp $line;
   $count++;
   my $ln = length $line;
-  $tot{$id}++;
+  my $n = mult($spl[0]);  # collapsed reads (-cl)
+  $tot{$id} += $n;
   # record length if it is variant
-  $len{$id}{$ln}++ if (abs($ln - $pos{$id}) >= $dist);
+  $len{$id}{$ln} += $n if (abs($ln - $pos{$id}) >= $dist);
   for (my $x = 0; $x < 2; $x++) {
     $line = <IN>;
   }
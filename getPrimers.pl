@@ -8,6 +8,9 @@
 
 use strict;
 use warnings;
+use FindBin;
+use lib $FindBin::RealBin;
+use Faidx;
 
 sub usage {
   print q(Usage: perl getPrimers.pl  <infile>  <genome>  <outfile>
@@ -23,7 +26,8 @@ sub usage {
                    first space-delimited token in the headers of
                    the fasta reference genome.
     <genome>   Fasta file of reference genome (single file; may be
-                 gzip compressed, with ".gz" extension)
+                 gzip compressed, with ".gz" extension [bgzip for
+                 random access]; indexed as by 'samtools faidx')
     <outfile>  Output file containing primer and target sequences
 );
   exit;
@@ -32,12 +36,6 @@ sub usage {
 usage() if (scalar @ARGV < 3 || $ARGV[0] eq "-h");
 
 open(BED, $ARGV[0]) || die "Cannot open $ARGV[0]\n";
-if (substr($ARGV[1], -3) eq ".gz") {
-  die "Cannot open $ARGV[1]\n" if (! -f $ARGV[1]);
-  open(GEN, "zcat $ARGV[1] |");
-} else {
-  open(GEN, $ARGV[1]) || die "Cannot open $ARGV[1]\n";
-}
 open(OUT, ">$ARGV[2]") || die "Cannot open $ARGV[2] for writing\n";
 
 # load primer locations: chr# - 5'Loc - 5'PLen - targLen - 3'PLen
@@ -84,30 +82,20 @@ foreach my $amp (keys %pos) {
   $loc{$spl[0]}{$amp} = "$spl[1]\t$spl[2]\t$spl[3]\t$spl[4]";
 }
 
-# retrieve primers from genome
-$/ = '>';
-my %rep_ch;  # to check for repeated chromosome names
+# retrieve primers from genome (repeated chromosome names
+#   are rejected by the index)
+my $gen = Faidx->new($ARGV[1]);
 my $total = 0;
-my $waste = <GEN>;
-while (my $chunk = <GEN>) {
-  chomp $chunk;
-  my @spl = split("\n", $chunk);
-  my @head = split(" ", shift @spl);
-  my $ch = $head[0];
-  if (exists $rep_ch{$ch}) {
-    die "Error! In reference genome $ARGV[1]:\n" .
-      "  Chromosome name $ch repeated\n";
-  }
-  $rep_ch{$ch} = 1;
-  my $chr = join("", @spl);
+foreach my $ch ($gen->names()) {
+  next if (! exists $loc{$ch});
   foreach my $amp (sort keys %{$loc{$ch}}) {
     my @div = split("\t", $loc{$ch}{$amp});
-    if ($div[0] + $div[1] + $div[2] + $div[3] > length $chr) {
+    if ($div[0] + $div[1] + $div[2] + $div[3] > $gen->chrLen($ch)) {
       warn "Warning! Skipping amplicon $amp --\n",
         "  Outside bounds of chromosome $ch\n";
       next;
     }
-    my $seg = substr($chr, $div[0], $div[1]+$div[2]+$div[3]);
+    my $seg = $gen->fetch($ch, $div[0], $div[1]+$div[2]+$div[3]);
     $seg =~ tr/a-z/A-Z/;
     print OUT "$amp,", substr($seg, 0, $div[1]),
       ",", substr($seg, $div[1]+$div[2], $div[3]),
@@ -116,7 +104,6 @@ while (my $chunk = <GEN>) {
     $total++;
   }
 }
-close GEN;
 close OUT;
 
 if ($total < $count) {
@@ -0,0 +1,813 @@
+/*
+  October 2026
+
+  Finding the products of primer pairs in a reference
+    genome (in-silico PCR), in place of ipcress.
+  The genome is indexed by its k-mers once; the index
+    is saved next to the genome (<genome>.kix) and is
+    memory-mapped by later runs. Each primer, and its
+    reverse-complement, is seeded by k-mers (with up
+    to the allowed mismatches) and verified over its
+    full length. Pairs of sites on the same chromosome
+    that give a product within the length range are
+    printed in the format of ipcress, as read by
+    filterIpc.pl and readSim.pl. Primer pairs are
+    searched in parallel.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <zlib.h>
+#include "inSilicoPCR.h"
+
+// global variables
+static GenIdx idx;
+static Exper* exper;
+static int nExp;
+static int nextExp;           // next primer pair to search
+static pthread_mutex_t expLock = PTHREAD_MUTEX_INITIALIZER;
+static int misMax;            // max. mismatches per primer
+static int seedMis;           // mismatches in 3' seed (-1 for all seeds)
+
+/* void usage()
+ * Prints usage information.
+ */
+void usage(void) {
+  fprintf(stderr, "Usage: ./inSilicoPCR {%s <file> %s <file> ", PRIMFILE, GENFILE);
+  fprintf(stderr, "%s <file>} [optional parameters]\n", OUTFILE);
+  fprintf(stderr, "Required parameters:\n");
+  fprintf(stderr, "  %s <file>   File listing primer pairs, in the format of\n", PRIMFILE);
+  fprintf(stderr, "                ipcress (produced by formatPrimers.pl)\n");
+  fprintf(stderr, "  %s <file>   Reference genome (FASTA); can be gzip compressed,\n", GENFILE);
+  fprintf(stderr, "                with \"%s\" extension\n", GZEXT);
+  fprintf(stderr, "  %s <file>   Output file of products, in the format of ipcress\n", OUTFILE);
+  fprintf(stderr, "Optional parameters:\n");
+  fprintf(stderr, "  %s <int>    Max. mismatches per primer (def. %d)\n", MISMATCH, DEFMIS);
+  fprintf(stderr, "  %s <int>    Search only the 3'-terminal k-mer of each primer,\n", SEEDMIS);
+  fprintf(stderr, "                with this many mismatches (def. all k-mers,\n");
+  fprintf(stderr, "                which finds every site)\n");
+  fprintf(stderr, "  %s <file>   Genome index (def. <genome>%s; built if\n", IDXFILE, IDXEXT);
+  fprintf(stderr, "                missing or older than the genome)\n");
+  fprintf(stderr, "  %s <int>    Length of k-mers, when building the index\n", KMER);
+  fprintf(stderr, "                (def. %d)\n", DEFKMER);
+  fprintf(stderr, "  %s <int>    Number of threads (def. %d)\n", THREADS, DEFTHREADS);
+  fprintf(stderr, "  %s         Option to print counts of results to stdout\n", VERBOSE);
+  exit(-1);
+}
+
+/* int error()
+ * Prints an error message.
+ */
+int error(char* msg, int err) {
+  char* msg2;
+  if (err == ERROPEN) msg2 = MERROPEN;
+  else if (err == ERRCLOSE) msg2 = MERRCLOSE;
+  else if (err == ERROPENW) msg2 = MERROPENW;
+  else if (err == ERRMEM) msg2 = MERRMEM;
+  else if (err == ERRPARAM) msg2 = MERRPARAM;
+  else if (err == ERRINT) msg2 = MERRINT;
+  else if (err == ERRPRIM) msg2 = MERRPRIM;
+  else if (err == ERRPLEN) msg2 = MERRPLEN;
+  else if (err == ERRKMER) msg2 = MERRKMER;
+  else if (err == ERRGEN) msg2 = MERRGEN;
+  else if (err == ERRBIG) msg2 = MERRBIG;
+  else if (err == ERRIDX) msg2 = MERRIDX;
+  else if (err == ERRTHR) msg2 = MERRTHR;
+  else if (err == ERRNOPRIM) msg2 = MERRNOPRIM;
+  else msg2 = DEFERR;
+
+  fprintf(stderr, "Error! %s%s\n", msg, msg2);
+  return -1;
+}
+
+/* void* memalloc()
+ * Allocates a heap block.
+ */
+void* memalloc(size_t size) {
+  void* ans = malloc(size);
+  if (ans == NULL)
+    exit(error("", ERRMEM));
+  return ans;
+}
+
+/* void* memrealloc()
+ * Resizes a heap block.
+ */
+void* memrealloc(void* ptr, size_t size) {
+  void* ans = realloc(ptr, size);
+  if (ans == NULL)
+    exit(error("", ERRMEM));
+  return ans;
+}
+
+/* int getInt(char*)
+ * Converts the given char* to an int.
+ */
+int getInt(char* in) {
+  char* endptr;
+  int ans = (int) strtol(in, &endptr, 10);
+  if (*endptr != '\0')
+    exit(error(in, ERRINT));
+  return ans;
+}
+
+/* char* saveStr()
+ * Returns a heap copy of a string.
+ */
+char* saveStr(char* str) {
+  char* ans = (char*) memalloc(strlen(str) + 1);
+  strcpy(ans, str);
+  return ans;
+}
+
+/* FILE* openRead()
+ * Opens a file for reading.
+ */
+FILE* openRead(char* inFile) {
+  FILE* in = fopen(inFile, "r");
+  if (in == NULL)
+    exit(error(inFile, ERROPEN));
+  return in;
+}
+
+/* int baseCode()
+ * Returns the 2-bit code of a base (-1 if not ACGT).
+ */
+int baseCode(char c) {
+  switch (c) {
+    case 'A': return 0;
+    case 'C': return 1;
+    case 'G': return 2;
+    case 'T': return 3;
+    default: return -1;
+  }
+}
+
+/* uint64_t pad8()
+ * Rounds up to a multiple of 8 (for alignment in the index).
+ */
+uint64_t pad8(uint64_t n) {
+  return (n + 7) & ~((uint64_t) 7);
+}
+
+/*** genome index ***/
+
+/* char* loadGenome()
+ * Loads the chromosomes of the reference genome, in
+ *   uppercase, concatenated (non-ACGT bases as 'N').
+ *   Returns the sequence; saves the names (NUL-
+ *   terminated) and the start of each chromosome.
+ */
+char* loadGenome(char* genFile, uint64_t* len, char** names,
+    uint64_t* nameLen, uint64_t** off, int* nChr) {
+  gzFile in = gzopen(genFile, "r");
+  if (in == NULL)
+    exit(error(genFile, ERROPEN));
+  char* line = (char*) memalloc(MAX_SIZE);
+  uint64_t seqMax = 1 << 20, nameMax = 1024;
+  int offMax = 64;
+  char* seq = (char*) memalloc(seqMax);
+  *names = (char*) memalloc(nameMax);
+  *off = (uint64_t*) memalloc(offMax * sizeof(uint64_t));
+  *len = *nameLen = 0;
+  *nChr = 0;
+
+  int head = 0, cont = 0;  // within a header line; line continued
+  while (gzgets(in, line, MAX_SIZE) != NULL) {
+    int n = strlen(line);
+    int end = (n && line[n - 1] == '\n');
+    if (! cont) {
+      head = (line[0] == '>');
+      if (head) {
+        // save name and start of chromosome
+        char* name = strtok(line + 1, " \t\n\r");
+        if (name == NULL)
+          name = "";
+        int m = strlen(name) + 1;
+        while (*nameLen + m > nameMax) {
+          nameMax *= 2;
+          *names = (char*) memrealloc(*names, nameMax);
+        }
+        memcpy(*names + *nameLen, name, m);
+        *nameLen += m;
+        if (*nChr + 1 == offMax) {
+          offMax *= 2;
+          *off = (uint64_t*) memrealloc(*off, offMax * sizeof(uint64_t));
+        }
+        (*off)[(*nChr)++] = *len;
+      }
+    }
+    cont = ! end;
+    if (head || ! *nChr)
+      continue;
+
+    // append bases
+    if (*len + n > seqMax) {
+      while (*len + n > seqMax)
+        seqMax *= 2;
+      seq = (char*) memrealloc(seq, seqMax);
+    }
+    for (int i = 0; i < n; i++) {
+      char c = line[i];
+      if (c == '\n' || c == '\r' || c == ' ' || c == '\t')
+        continue;
+      if (c >= 'a' && c <= 'z')
+        c -= 32;
+      seq[(*len)++] = (baseCode(c) < 0 ? 'N' : c);
+    }
+  }
+  if (gzclose(in) != Z_OK)
+    exit(error("", ERRCLOSE));
+  free(line);
+  if (! *nChr)
+    exit(error(genFile, ERRGEN));
+  (*off)[*nChr] = *len;
+  return seq;
+}
+
+/* void scanKmers()
+ * Counts the k-mers of the genome in their buckets, or
+ *   (given 'pos') saves their positions. K-mers with
+ *   non-ACGT bases, or across chromosomes, are skipped.
+ */
+void scanKmers(char* seq, uint64_t* off, int nChr, int k,
+    uint32_t* cnt, uint32_t* pos) {
+  uint32_t mask = ((uint32_t) 1 << (2 * k)) - 1;
+  for (int c = 0; c < nChr; c++) {
+    uint32_t code = 0;
+    int valid = 0;
+    for (uint64_t p = off[c]; p < off[c + 1]; p++) {
+      int b = baseCode(seq[p]);
+      if (b < 0) {
+        valid = 0;
+        continue;
+      }
+      code = ((code << 2) | b) & mask;
+      if (valid < k)
+        valid++;
+      if (valid == k) {
+        if (pos == NULL)
+          cnt[code]++;
+        else
+          pos[cnt[code]++] = p - k + 1;
+      }
+    }
+  }
+}
+
+/* void buildIdx()
+ * Builds the index of the genome, written to a temporary
+ *   file (by mmap) and then renamed.
+ */
+void buildIdx(char* genFile, char* idxFile, int k, int verbose) {
+  uint64_t len, nameLen, *off;
+  char* names;
+  int nChr;
+  if (verbose)
+    printf("Indexing genome %s (k=%d)\n", genFile, k);
+  char* seq = loadGenome(genFile, &len, &names, &nameLen, &off, &nChr);
+  if (len >= UINT32_MAX)
+    exit(error(genFile, ERRBIG));
+
+  // count k-mers; start of each bucket
+  uint64_t nb = ((uint64_t) 1 << (2 * k)) + 1;
+  uint32_t* cnt = (uint32_t*) calloc(nb, sizeof(uint32_t));
+  if (cnt == NULL)
+    exit(error("", ERRMEM));
+  scanKmers(seq, off, nChr, k, cnt, NULL);
+  uint64_t nPos = 0;
+  for (uint64_t i = 0; i < nb; i++) {
+    uint32_t c = cnt[i];
+    cnt[i] = nPos;
+    nPos += c;
+  }
+
+  // create index file
+  IdxHead h;
+  memset(&h, 0, sizeof(IdxHead));
+  strncpy(h.magic, IDXMAGIC, sizeof(h.magic));
+  h.k = k;
+  h.nChr = nChr;
+  h.nameLen = pad8(nameLen);
+  h.seqLen = pad8(len);
+  h.nPos = nPos;
+  size_t size = sizeof(IdxHead) + h.nameLen + (nChr + 1) * sizeof(uint64_t)
+    + h.seqLen + (nb + nPos) * sizeof(uint32_t);
+  char* tmpFile = (char*) memalloc(strlen(idxFile) + 32);
+  sprintf(tmpFile, "%s.tmp%ld", idxFile, (long) getpid());
+  int fd = open(tmpFile, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd == -1)
+    exit(error(tmpFile, ERROPENW));
+  if (ftruncate(fd, size))
+    exit(error(tmpFile, ERROPENW));
+  char* map = (char*) mmap(NULL, size, PROT_READ | PROT_WRITE,
+    MAP_SHARED, fd, 0);
+  if (map == MAP_FAILED)
+    exit(error(tmpFile, ERRIDX));
+  close(fd);
+
+  // save header, names, chromosome offsets, sequence, buckets
+  char* p = map;
+  memcpy(p, &h, sizeof(IdxHead));
+  p += sizeof(IdxHead);
+  memcpy(p, names, nameLen);
+  p += h.nameLen;
+  memcpy(p, off, (nChr + 1) * sizeof(uint64_t));
+  p += (nChr + 1) * sizeof(uint64_t);
+  memcpy(p, seq, len);
+  p += h.seqLen;
+  memcpy(p, cnt, nb * sizeof(uint32_t));
+  p += nb * sizeof(uint32_t);
+
+  // save positions of k-mers
+  scanKmers(seq, off, nChr, k, cnt, (uint32_t*) p);
+
+  if (munmap(map, size) || rename(tmpFile, idxFile))
+    exit(error(idxFile, ERROPENW));
+  if (verbose)
+    printf("  Chromosomes: %d\n  Bases: %lu\n  K-mers indexed: %lu\n",
+      nChr, (unsigned long) len, (unsigned long) nPos);
+  free(tmpFile);
+  free(cnt);
+  free(seq);
+  free(names);
+  free(off);
+}
+
+/* int mapIdx()
+ * Maps the index of the genome (read-only). Returns 0
+ *   if the index is missing, invalid, or of another k
+ *   (if one is given).
+ */
+int mapIdx(char* idxFile, int k) {
+  int fd = open(idxFile, O_RDONLY);
+  if (fd == -1)
+    return 0;
+  struct stat st;
+  if (fstat(fd, &st) || st.st_size < (off_t) sizeof(IdxHead)) {
+    close(fd);
+    return 0;
+  }
+  void* map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED)
+    exit(error(idxFile, ERRIDX));
+
+  // check header
+  IdxHead* h = (IdxHead*) map;
+  uint64_t nb = 0;
+  int ok = ! strncmp(h->magic, IDXMAGIC, sizeof(h->magic))
+    && h->k >= MINKMER && h->k <= MAXKMER && (! k || h->k == k)
+    && h->nChr > 0;
+  if (ok) {
+    nb = ((uint64_t) 1 << (2 * h->k)) + 1;
+    ok = (size_t) st.st_size == sizeof(IdxHead) + h->nameLen
+      + (h->nChr + 1) * sizeof(uint64_t) + h->seqLen
+      + (nb + h->nPos) * sizeof(uint32_t);
+  }
+  if (! ok) {
+    munmap(map, st.st_size);
+    return 0;
+  }
+
+  // set pointers into index
+  idx.map = map;
+  idx.size = st.st_size;
+  idx.k = h->k;
+  idx.nChr = h->nChr;
+  char* p = (char*) map + sizeof(IdxHead);
+  idx.name = (char**) memalloc(idx.nChr * sizeof(char*));
+  char* name = p;
+  for (int i = 0; i < idx.nChr; i++) {
+    idx.name[i] = name;
+    name += strlen(name) + 1;
+  }
+  p += h->nameLen;
+  idx.off = (uint64_t*) p;
+  p += (h->nChr + 1) * sizeof(uint64_t);
+  idx.seq = p;
+  p += h->seqLen;
+  idx.bucket = (uint32_t*) p;
+  p += nb * sizeof(uint32_t);
+  idx.pos = (uint32_t*) p;
+  return 1;
+}
+
+/* void openIdx()
+ * Maps the index of the genome, building it first if
+ *   missing, older than the genome, or of another k.
+ */
+void openIdx(char* genFile, char* idxFile, int k, int verbose) {
+  struct stat gs, is;
+  if (stat(genFile, &gs))
+    exit(error(genFile, ERROPEN));
+  if (! stat(idxFile, &is) && is.st_mtime >= gs.st_mtime
+      && mapIdx(idxFile, k))
+    return;
+  buildIdx(genFile, idxFile, k ? k : DEFKMER, verbose);
+  if (! mapIdx(idxFile, 0))
+    exit(error(idxFile, ERRIDX));
+}
+
+/*** primers ***/
+
+/* char* saveSeq()
+ * Returns a heap copy of a primer, in uppercase; other
+ *   than ACGT, bases are saved as '-' (never matched).
+ */
+char* saveSeq(char* seq) {
+  char* ans = saveStr(seq);
+  for (int i = 0; ans[i] != '\0'; i++) {
+    if (ans[i] >= 'a' && ans[i] <= 'z')
+      ans[i] -= 32;
+    if (baseCode(ans[i]) < 0)
+      ans[i] = '-';
+  }
+  return ans;
+}
+
+/* char* revComp()
+ * Returns a heap copy of the reverse-complement of a primer.
+ */
+char* revComp(char* seq, int len) {
+  char* ans = (char*) memalloc(len + 1);
+  for (int i = 0; i < len; i++) {
+    char c = seq[len - i - 1];
+    ans[i] = (c == 'A' ? 'T' : c == 'C' ? 'G' : c == 'G' ? 'C' :
+      c == 'T' ? 'A' : c);
+  }
+  ans[len] = '\0';
+  return ans;
+}
+
+/* void loadPrimers()
+ * Loads the primer pairs (name, primer A, primer B,
+ *   min. and max. product lengths).
+ */
+void loadPrimers(FILE* in) {
+  char* line = (char*) memalloc(MAX_SIZE);
+  int max = 0;
+  nExp = 0;
+  exper = NULL;
+  while (fgets(line, MAX_SIZE, in) != NULL) {
+    if (line[0] == '#' || line[0] == '\n' || line[0] == '\r')
+      continue;
+    char* name = strtok(line, DEL);
+    char* a = strtok(NULL, DEL);
+    char* b = strtok(NULL, DEL);
+    char* min = strtok(NULL, DEL);
+    char* maxLen = strtok(NULL, DEL);
+    if (name == NULL)
+      continue;
+    if (maxLen == NULL)
+      exit(error(name, ERRPRIM));
+    if (nExp == max) {
+      max = max ? 2 * max : 64;
+      exper = (Exper*) memrealloc(exper, max * sizeof(Exper));
+    }
+    Exper* e = exper + nExp++;
+    e->name = saveStr(name);
+    e->seq[0] = saveSeq(a);
+    e->seq[2] = saveSeq(b);
+    e->len[0] = strlen(a);
+    e->len[1] = strlen(b);
+    e->seq[1] = revComp(e->seq[0], e->len[0]);
+    e->seq[3] = revComp(e->seq[2], e->len[1]);
+    e->min = getInt(min);
+    e->max = getInt(maxLen);
+    if (e->len[0] < idx.k || e->len[1] < idx.k)
+      exit(error(name, ERRPLEN));
+    e->outMax = 256;
+    e->out = (char*) memalloc(e->outMax);
+    e->outLen = e->count = 0;
+  }
+  if (! nExp)
+    exit(error("", ERRNOPRIM));
+  free(line);
+}
+
+/*** search ***/
+
+/* int findChr()
+ * Returns the chromosome of a position in the genome.
+ */
+int findChr(uint64_t pos) {
+  int lo = 0, hi = idx.nChr - 1;
+  while (lo < hi) {
+    int mid = (lo + hi + 1) / 2;
+    if (idx.off[mid] <= pos)
+      lo = mid;
+    else
+      hi = mid - 1;
+  }
+  return lo;
+}
+
+/* void addSite()
+ * Adds a site to an array.
+ */
+void addSite(Sites* s, uint32_t pos, int chr, int mis) {
+  if (s->n == s->max) {
+    s->max *= 2;
+    s->s = (Site*) memrealloc(s->s, s->max * sizeof(Site));
+  }
+  Site* t = s->s + s->n++;
+  t->pos = pos;
+  t->chr = chr;
+  t->mis = mis;
+}
+
+/* void checkSeed()
+ * Verifies the sites of a seed k-mer over the full
+ *   length of the primer.
+ */
+void checkSeed(Query* q, uint32_t code) {
+  for (uint32_t j = idx.bucket[code]; j < idx.bucket[code + 1]; j++) {
+    uint32_t p = idx.pos[j];
+    if (p < (uint32_t) q->off)
+      continue;
+    uint32_t st = p - q->off;
+    int c = findChr(st);
+    if (st + q->len > idx.off[c + 1])
+      continue;
+    char* g = idx.seq + st;
+    int mis = 0;
+    for (int i = 0; i < q->len && mis <= q->mis; i++)
+      if (g[i] != q->seq[i])
+        mis++;
+    if (mis <= q->mis)
+      addSite(q->out, st, c, mis);
+  }
+}
+
+/* void enumSeed()
+ * Enumerates the k-mers within 'e' mismatches of the
+ *   seed, from its i-th base on.
+ */
+void enumSeed(Query* q, int i, uint32_t code, int e) {
+  if (i == idx.k) {
+    checkSeed(q, code);
+    return;
+  }
+  int b = baseCode(q->seq[q->off + i]);
+  if (b >= 0)
+    enumSeed(q, i + 1, (code << 2) | b, e);
+  if (e)
+    for (int x = 0; x < 4; x++)
+      if (x != b)
+        enumSeed(q, i + 1, (code << 2) | x, e - 1);
+}
+
+/* int siteCmp()
+ * Compares sites by position (for qsort).
+ */
+int siteCmp(const void* a, const void* b) {
+  uint32_t x = ((Site*) a)->pos, y = ((Site*) b)->pos;
+  return x < y ? -1 : x > y;
+}
+
+/* void findSites()
+ * Finds the sites of a primer (or its rev-comp), in
+ *   order of position. With all seeds (seedMis < 0),
+ *   the primer is split into n k-mers, one of which
+ *   must match within floor(misMax / n) mismatches.
+ *   Otherwise, only the k-mer at the 3' end of the
+ *   primer (the left end of a rev-comp) is searched.
+ */
+void findSites(char* seq, int len, int rc, Sites* s) {
+  Query q;
+  q.seq = seq;
+  q.len = len;
+  q.mis = misMax;
+  q.out = s;
+  s->n = 0;
+  int k = idx.k;
+  if (seedMis >= 0) {
+    q.off = rc ? 0 : len - k;
+    enumSeed(&q, 0, 0, seedMis < misMax ? seedMis : misMax);
+  } else {
+    int n = len / k;
+    for (int i = 0; i < n; i++) {
+      q.off = rc ? k * i : len - k * (i + 1);
+      enumSeed(&q, 0, 0, misMax / n);
+    }
+  }
+
+  // sort, remove duplicates
+  qsort(s->s, s->n, sizeof(Site), siteCmp);
+  int j = 0;
+  for (int i = 0; i < s->n; i++)
+    if (! j || s->s[i].pos != s->s[j - 1].pos)
+      s->s[j++] = s->s[i];
+  s->n = j;
+}
+
+/* void appendOut()
+ * Adds a line to the output of a primer pair.
+ */
+void appendOut(Exper* e, char* fmt, ...) {
+  va_list ap;
+  for (;;) {
+    va_start(ap, fmt);
+    int n = vsnprintf(e->out + e->outLen, e->outMax - e->outLen, fmt, ap);
+    va_end(ap);
+    if (e->outLen + n < e->outMax) {
+      e->outLen += n;
+      return;
+    }
+    e->outMax = 2 * e->outMax + n;
+    e->out = (char*) memrealloc(e->out, e->outMax);
+  }
+}
+
+/* void pairSites()
+ * Pairs the sites of the 5' primer (plus strand) with
+ *   those of the 3' primer (minus strand) that give a
+ *   product within the length range. For "forward"
+ *   products, primer A is 5'; for "revcomp", primer B.
+ */
+void pairSites(Exper* e, Sites* s5, Sites* s3, int rev) {
+  int len5 = e->len[rev], len3 = e->len[! rev];
+  char p5 = rev ? 'B' : 'A', p3 = rev ? 'A' : 'B';
+  int j = 0;
+  for (int i = 0; i < s5->n; i++) {
+    Site* a = s5->s + i;
+    int64_t lo = (int64_t) a->pos + e->min - len3;
+    if (lo < (int64_t) a->pos + len5 - len3)
+      lo = (int64_t) a->pos + len5 - len3;  // 3' primer not before 5'
+    if (lo < a->pos)
+      lo = a->pos;
+    int64_t hi = (int64_t) a->pos + e->max - len3;
+    while (j < s3->n && s3->s[j].pos < lo)
+      j++;
+    for (int t = j; t < s3->n && s3->s[t].pos <= hi; t++) {
+      Site* b = s3->s + t;
+      if (b->chr != a->chr)
+        continue;
+      uint64_t off = idx.off[a->chr];
+      appendOut(e, "%s %s:%s %s %u %c %lu %d %c %lu %d %s\n",
+        IPCHEAD, idx.name[a->chr], IPCFILT, e->name,
+        b->pos + len3 - a->pos, p5, (unsigned long) (a->pos - off),
+        a->mis, p3, (unsigned long) (b->pos - off), b->mis,
+        rev ? IPCREV : IPCFWD);
+      e->count++;
+    }
+  }
+}
+
+/* void searchExper()
+ * Finds the products of a primer pair: sites of each
+ *   primer on either strand, then pairs of them.
+ */
+void searchExper(Exper* e, Sites* s) {
+  for (int i = 0; i < 4; i++)
+    findSites(e->seq[i], e->len[i / 2], i % 2, s + i);
+  pairSites(e, s, s + 3, 0);      // A, rev-comp of B
+  pairSites(e, s + 2, s + 1, 1);  // B, rev-comp of A
+}
+
+/* void* searchThread()
+ * Searches primer pairs until none are left.
+ */
+void* searchThread(void* arg) {
+  Sites s[4];
+  for (int i = 0; i < 4; i++) {
+    s[i].n = 0;
+    s[i].max = SITEINIT;
+    s[i].s = (Site*) memalloc(s[i].max * sizeof(Site));
+  }
+  for (;;) {
+    pthread_mutex_lock(&expLock);
+    int i = nextExp++;
+    pthread_mutex_unlock(&expLock);
+    if (i >= nExp)
+      break;
+    searchExper(exper + i, s);
+  }
+  for (int i = 0; i < 4; i++)
+    free(s[i].s);
+  return NULL;
+}
+
+/* void freeMemory()
+ * Frees the primer pairs and unmaps the index.
+ */
+void freeMemory(void) {
+  for (int i = 0; i < nExp; i++) {
+    free(exper[i].name);
+    for (int j = 0; j < 4; j++)
+      free(exper[i].seq[j]);
+    free(exper[i].out);
+  }
+  free(exper);
+  free(idx.name);
+  munmap(idx.map, idx.size);
+}
+
+/* void getParams()
+ * Gets command-line parameters.
+ */
+void getParams(int argc, char** argv) {
+
+  char* primFile = NULL, *genFile = NULL, *outFile = NULL,
+    *idxFile = NULL;
+  int k = 0, threads = DEFTHREADS, verbose = 0;
+  misMax = DEFMIS;
+  seedMis = -1;
+
+  // parse argv
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], HELP))
+      usage();
+    else if (!strcmp(argv[i], VERBOSE))
+      verbose = 1;
+    else if (i < argc - 1) {
+      if (!strcmp(argv[i], PRIMFILE))
+        primFile = argv[++i];
+      else if (!strcmp(argv[i], GENFILE))
+        genFile = argv[++i];
+      else if (!strcmp(argv[i], OUTFILE))
+        outFile = argv[++i];
+      else if (!strcmp(argv[i], IDXFILE))
+        idxFile = argv[++i];
+      else if (!strcmp(argv[i], MISMATCH))
+        misMax = getInt(argv[++i]);
+      else if (!strcmp(argv[i], SEEDMIS))
+        seedMis = getInt(argv[++i]);
+      else if (!strcmp(argv[i], KMER))
+        k = getInt(argv[++i]);
+      else if (!strcmp(argv[i], THREADS))
+        threads = getInt(argv[++i]);
+      else
+        exit(error(argv[i], ERRPARAM));
+    } else
+      exit(error(argv[i], ERRPARAM));
+  }
+
+  // check for parameter errors
+  if (primFile == NULL || genFile == NULL || outFile == NULL ||
+      misMax < 0 || threads < 1)
+    usage();
+  if (k && (k < MINKMER || k > MAXKMER))
+    exit(error(argv[0], ERRKMER));
+
+  // map genome index (built if needed)
+  char* defIdx = NULL;
+  if (idxFile == NULL) {
+    defIdx = (char*) memalloc(strlen(genFile) + strlen(IDXEXT) + 1);
+    strcpy(defIdx, genFile);
+    strcat(defIdx, IDXEXT);
+    idxFile = defIdx;
+  }
+  openIdx(genFile, idxFile, k, verbose);
+  free(defIdx);
+
+  // load primers
+  FILE* prim = openRead(primFile);
+  loadPrimers(prim);
+  if (fclose(prim))
+    exit(error("", ERRCLOSE));
+  FILE* out = fopen(outFile, "w");
+  if (out == NULL)
+    exit(error(outFile, ERROPENW));
+
+  // search primer pairs
+  nextExp = 0;
+  pthread_t* thr = (pthread_t*) memalloc(threads * sizeof(pthread_t));
+  for (int i = 0; i < threads; i++)
+    if (pthread_create(thr + i, NULL, searchThread, NULL))
+      exit(error("", ERRTHR));
+  for (int i = 0; i < threads; i++)
+    pthread_join(thr[i], NULL);
+  free(thr);
+
+  // print products, in order of primer pairs
+  int count = 0;
+  for (int i = 0; i < nExp; i++) {
+    fwrite(exper[i].out, 1, exper[i].outLen, out);
+    count += exper[i].count;
+  }
+  if (verbose)
+    printf("Primer pairs: %d\nProducts: %d\n", nExp, count);
+
+  if (fclose(out))
+    exit(error("", ERRCLOSE));
+  freeMemory();
+}
+
+/* int main()
+ * Main.
+ */
+int main(int argc, char* argv[]) {
+  getParams(argc, argv);
+  return 0;
+}
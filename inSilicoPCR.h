@@ -0,0 +1,122 @@
+/*
+  October 2026
+
+  Header file for inSilicoPCR.c.
+*/
+
+#define MAX_SIZE    65536  // maximum length for input line
+#define GZEXT       ".gz"  // file extension for gzip compression
+#define DEL         " \t\n\r" // delimiters of primers file
+#define IDXEXT      ".kix" // extension of genome index (k-mers)
+#define IDXMAGIC    "AMPKIX1"
+#define IPCHEAD     "ipcress:"  // output as ipcress (exonerate)
+#define IPCFILT     "filter(unmasked)"
+#define IPCFWD      "forward"
+#define IPCREV      "revcomp"
+#define SITEINIT    64     // initial size of arrays of sites
+
+// command-line parameters
+#define HELP        "-h"
+#define PRIMFILE    "-i"
+#define GENFILE     "-g"
+#define OUTFILE     "-o"
+#define IDXFILE     "-x"   // genome index (def. <genome>.kix)
+#define MISMATCH    "-m"
+#define SEEDMIS     "-e"   // 3'-anchored seeds, with given mismatches
+#define KMER        "-k"
+#define THREADS     "-t"
+#define VERBOSE     "-ve"  // option to print counts to stdout
+
+// default parameter values
+#define DEFMIS      0      // mismatches per primer (as ipcress)
+#define DEFKMER     12
+#define MINKMER     6
+#define MAXKMER     14
+#define DEFTHREADS  1
+
+// error messages
+#define ERROPEN     0
+#define MERROPEN    ": cannot open file for reading"
+#define ERRCLOSE    1
+#define MERRCLOSE   "Cannot close file"
+#define ERROPENW    2
+#define MERROPENW   ": cannot open file for writing"
+#define ERRMEM      3
+#define MERRMEM     "Cannot allocate memory"
+#define ERRPARAM    4
+#define MERRPARAM   ": unknown command-line parameter"
+#define ERRINT      5
+#define MERRINT     ": cannot convert to int"
+#define ERRPRIM     6
+#define MERRPRIM    ": improperly formatted line in primers file"
+#define ERRPLEN     7
+#define MERRPLEN    ": primer is shorter than the k-mers of the index"
+#define ERRKMER     8
+#define MERRKMER    ": k-mer length must be in [6,14]"
+#define ERRGEN      9
+#define MERRGEN     ": cannot load reference genome"
+#define ERRBIG      10
+#define MERRBIG     ": genome is too large to index (4 Gbp max.)"
+#define ERRIDX      11
+#define MERRIDX     ": cannot map genome index"
+#define ERRTHR      12
+#define MERRTHR     "Cannot create thread"
+#define ERRNOPRIM   13
+#define MERRNOPRIM  ": no primers loaded"
+#define DEFERR      "Unknown error"
+
+// genome index (memory-mapped): header, chromosome names
+//   (NUL-terminated), chromosome offsets, sequence, buckets
+//   of k-mers (start of each in 'pos'), positions of k-mers
+typedef struct idxHead {
+  char magic[8];
+  int32_t k;
+  int32_t nChr;
+  uint64_t nameLen;  // bytes of names (padded to 8)
+  uint64_t seqLen;   // bases (padded to 8)
+  uint64_t nPos;     // k-mers indexed
+} IdxHead;
+
+typedef struct genIdx {
+  void* map;
+  size_t size;
+  int k;
+  int nChr;
+  char** name;
+  uint64_t* off;     // start of each chromosome in seq (nChr+1)
+  char* seq;         // concatenated chromosomes (uppercase)
+  uint32_t* bucket;  // 4^k + 1
+  uint32_t* pos;
+} GenIdx;
+
+typedef struct site {
+  uint32_t pos;      // start in concatenated sequence
+  int chr;
+  int mis;           // mismatches to primer
+} Site;
+
+typedef struct sites {
+  Site* s;
+  int n;
+  int max;
+} Sites;
+
+typedef struct exper {
+  char* name;
+  char* seq[4];      // primer A, its rev-comp, primer B, its rev-comp
+  int len[2];
+  int min;           // min. and max. product lengths
+  int max;
+  char* out;         // output lines
+  int outLen;
+  int outMax;
+  int count;         // products found
+} Exper;
+
+typedef struct query {
+  char* seq;         // primer (or rev-comp) searched
+  int len;
+  int off;           // offset of the seed in seq
+  int mis;           // max. mismatches to primer
+  Sites* out;
+} Query;
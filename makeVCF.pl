@@ -14,7 +14,8 @@ sub usage {
   Required:
     <infile1>  Output from VarScan pileup2snp
     <infile2>  Output from VarScan pileup2indel
-    <infile3>  Pileup file
+    <infile3>  Pileup file, or table of counts from ampPileup (-c; its
+                 min. quality [-q] should match <minQual>)
     <outfile>  Output VCF file
   Optional:
     <minQual>  Minimum quality score used with VarScan
@@ -56,31 +57,22 @@ print OUT q(##fileformat=VCFv4.2
 );
 print OUT "#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT\t$samp\n";
 
-# save read depth at each position, and chromosome order
-my %dp;
-my %ord;  # for chromosome order
-my $idx = 0;
-while (my $line = <PIL>) {
-  chomp $line;
-  my @spl = split("\t", $line);
-  my $depth = 0;
-  for (my $x = 0; $x < length $spl[5]; $x++) {
-    # count only if quality is greater than min.
-    $depth++ if (ord(substr($spl[5], $x, 1)) > $min);
-  }
-  $dp{$spl[0]}{$spl[1]} = $depth;
-
-  # save order
-  if (! exists $ord{$spl[0]}) {
-    $ord{$spl[0]} = $idx;
-    $idx++;
-  }
-}
-close PIL;
+# count quality scores greater than min. (one tr/// pass)
+my $count = eval sprintf('sub { return $_[0] =~ tr/\x%02x-\xff//; }',
+  $min + 1);
 
-# append dummy chromosome
+# The pileup is read along with the (sorted) variants: read
+#   depths are saved only at or after the positions of the next
+#   SNP and in/del (on their chromosomes), so those held are the
+#   span of the next variant, not the whole pileup.
+my %dp;       # read depths of a window of positions
+my %ord;      # order of chromosomes (in the pileup)
+my $idx = 0;
+my $tab = 0;  # table of counts (depth at min. quality given)
+my @pil;      # next pileup position: chrom, pos, depth
 my $dummy = "zzzzz";
-$ord{$dummy} = $idx;
+my @sar; my @iar;  # next SNP and in/del
+readPil();
 
 # skip headers
 my $waste = <SNP>;
@@ -104,13 +96,27 @@ if ($sline) {
 # print sorted output
 while (1) {
 
-  my @sar = split("\t", $sline);
-  my @iar = split("\t", $iline);
+  @sar = split("\t", $sline);
+  @iar = split("\t", $iline);
   last if ($sar[0] eq $dummy && $iar[0] eq $dummy);
 
-  # determine which is next
-  my $next = ($ord{$iar[0]} < $ord{$sar[0]} ||
-    ($iar[0] eq $sar[0] && $iar[1] < $sar[1]) ? 1 : 0);
+  # drop depths of chromosomes with no variants left
+  foreach my $chr (keys %dp) {
+    delete $dp{$chr} if ($chr ne $sar[0] && $chr ne $iar[0]);
+  }
+
+  # determine which is next (reading the pileup until the
+  #   chromosome of either is found, if they differ)
+  my $next;
+  if ($iar[0] eq $sar[0]) {
+    $next = ($iar[1] < $sar[1] ? 1 : 0);
+  } else {
+    while (! exists $ord{$iar[0]} && ! exists $ord{$sar[0]} && @pil) {
+      readPil();
+    }
+    $next = (! exists $ord{$sar[0]} || (exists $ord{$iar[0]}
+      && $ord{$iar[0]} < $ord{$sar[0]}) ? 1 : 0);
+  }
 
   if ($next) {
     # in/del
@@ -155,6 +161,7 @@ while (1) {
     # depth is max at any variant position
     my $len = length $ref;
     $len = 2 if (length $alt > $len);  # insertion: only count 2 positions
+    loadDepth($iar[0], $iar[1], $iar[1] + $len - 1);
     my $dep = 0;
     for (my $x = 0; $x < $len; $x++) {
       $dep = $dp{$iar[0]}{$iar[1]+$x} if ($dp{$iar[0]}{$iar[1]+$x} > $dep);
@@ -181,6 +188,7 @@ while (1) {
     my ($alt, $gt) = getAlt($sar[2], $sar[3]);
     my $ao = $sar[5];
     my $ro = $sar[4];
+    loadDepth($sar[0], $sar[1], $sar[1]);
     my $dep = $dp{$sar[0]}{$sar[1]};
     my $af = int(1000000*$ao/$dep+0.5) / 1000000;
     my $cig = "1X";
@@ -201,6 +209,46 @@ while (1) {
 close OUT;
 close SNP;
 close IND;
+close PIL;
+
+# read depths of a variant's positions (through $end) from the
+#   pileup, and drop those before its position
+sub loadDepth {
+  my ($chr, $pos, $end) = @_;
+  while (@pil && ($pil[0] ne $chr ? ! exists $ord{$chr}
+      : $pil[1] <= $end)) {
+    readPil();
+  }
+  foreach my $x (keys %{$dp{$chr}}) {
+    delete $dp{$chr}{$x} if ($x < $pos);
+  }
+}
+
+# save the depth of the pending pileup position (if at or after
+#   the next SNP or in/del on its chromosome -- those before are
+#   not needed, as the variants are sorted), then load the next
+sub readPil {
+  $dp{$pil[0]}{$pil[1]} = $pil[2]
+    if (@pil && (($pil[0] eq $sar[0] && $pil[1] >= $sar[1]) ||
+      ($pil[0] eq $iar[0] && $pil[1] >= $iar[1])));
+  @pil = ();
+  while (my $line = <PIL>) {
+    chomp $line;
+    if (substr($line, 0, 1) eq '#') {
+      $tab = 1 if ($line =~ m/^#Chrom\tPos\tRef\tDepth\tQDepth/);
+      next;
+    }
+    my @spl = split("\t", $line);
+    @pil = ($spl[0], $spl[1], ($tab ? $spl[4] : $count->($spl[5])));
+
+    # save order
+    if (! exists $ord{$spl[0]}) {
+      $ord{$spl[0]} = $idx;
+      $idx++;
+    }
+    last;
+  }
+}
 
 # dissects IUPAC ambig code
 sub getAlt {
@@ -0,0 +1,128 @@
+#!/usr/bin/perl
+
+# Oct. 2026
+
+# Merge the outputs of stitch, removePrimer, or qualTrim
+#   run on separate shards (-sh) of the same input, producing
+#   the same results as a single whole-file run.
+
+use strict;
+use warnings;
+
+sub usage {
+  print q(Usage: perl mergeShards.pl  <type>  <outfile>  <infile1>  <infile2>  [...]
+  Required:
+    <type>     Type of files to merge:
+                 -f   reads (FASTQ/FASTA output files; concatenated in order,
+                        so gzip compressed files stay valid)
+                 -l   log files of removePrimer (-l), with counts summed
+                 -t   tab-delimited log files with a header line, such as
+                        those of stitch (-l, -dl); header printed once
+                 -v   counts printed to stdout by stitch or qualTrim (-ve),
+                        with counts summed
+    <outfile>  Output file
+    <infile1>  Output from shard #1
+    <infile2>    "     "     "   #2
+                 (etc. for multiple shards, listed in order)
+);
+  exit;
+}
+
+usage() if (scalar @ARGV < 3 || $ARGV[0] eq "-h");
+my $type = shift @ARGV;
+my $outfile = shift @ARGV;
+die "Error! Unknown type of files to merge: $type\n"
+  if ($type ne "-f" && $type ne "-l" && $type ne "-t" && $type ne "-v");
+
+open(OUT, ">$outfile") || die "Cannot open $outfile for writing\n";
+binmode OUT;
+
+if ($type eq "-f") {
+  # concatenate files
+  foreach my $file (@ARGV) {
+    open(IN, $file) || die "Cannot open $file\n";
+    binmode IN;
+    my $buf;
+    while (read(IN, $buf, 1048576)) {
+      print OUT $buf;
+    }
+    close IN;
+  }
+} elsif ($type eq "-t") {
+  # concatenate files, keeping first header only
+  my $head = "";
+  foreach my $file (@ARGV) {
+    open(IN, $file) || die "Cannot open $file\n";
+    my $line = <IN>;
+    if (defined $line) {
+      if (!$head) {
+        $head = $line;
+        print OUT $head;
+      } elsif ($line ne $head) {
+        die "Error! Header of $file does not match $ARGV[0]\n";
+      }
+    }
+    while ($line = <IN>) {
+      print OUT $line;
+    }
+    close IN;
+  }
+} else {
+  # sum counts, line by line
+  my @line;   # text of each line, with counts as undef
+  my @count;  # summed counts of each line
+  my $first = 1;
+  foreach my $file (@ARGV) {
+    open(IN, $file) || die "Cannot open $file\n";
+    my $x = 0;
+    while (my $line = <IN>) {
+      chomp $line;
+      my @spl = split("\t", $line, -1);
+      my @num;
+      for (my $y = 0; $y < scalar @spl; $y++) {
+        # counts are numeric fields, or follow a colon
+        if ($spl[$y] =~ m/^(.*:\s*)?(\d+)$/) {
+          $spl[$y] = (defined $1 ? $1 : "");
+          push @num, $2;
+        } else {
+          push @num, undef;
+        }
+      }
+      my $text = join("\t", @spl);
+
+      if ($first) {
+        push @line, $text;
+        push @count, \@num;
+      } else {
+        die "Error! $file does not match $ARGV[0] at line ", $x+1, "\n"
+          if ($x > $#line || $text ne $line[$x]);
+        for (my $y = 0; $y < scalar @num; $y++) {
+          next if (!defined $num[$y]);
+          if ($type eq "-l" && $text =~ m/^Primer pairs:/) {
+            # number of primer pairs is the same for all shards
+            die "Error! $file does not match $ARGV[0] at line ", $x+1, "\n"
+              if ($num[$y] != $count[$x][$y]);
+          } else {
+            $count[$x][$y] += $num[$y];
+          }
+        }
+      }
+      $x++;
+    }
+    close IN;
+    die "Error! $file does not match $ARGV[0] (line count)\n"
+      if (!$first && $x != scalar @line);
+    $first = 0;
+  }
+
+  # print output
+  for (my $x = 0; $x < scalar @line; $x++) {
+    my @spl = split("\t", $line[$x], -1);
+    @spl = ("") if (!@spl);
+    for (my $y = 0; $y < scalar @spl; $y++) {
+      $spl[$y] .= $count[$x][$y] if (defined $count[$x][$y]);
+    }
+    print OUT join("\t", @spl), "\n";
+  }
+}
+close OUT;
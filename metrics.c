@@ -0,0 +1,216 @@
+/*
+  October 2026
+
+  Reporting the progress of a run: reads analyzed, reads/sec,
+    input and output bytes/sec, and the counts of the outcomes.
+  Reports are printed to stderr and (optionally) written to a
+    Prometheus textfile-collector file. The clock is checked
+    only every METCHECK reads, and the counts are the program's
+    own counters, so metrics can remain on in production.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+#define _FILE_OFFSET_BITS 64
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/types.h>
+#include <zlib.h>
+#include "shard.h"
+#include "metrics.h"
+
+/* int metError()
+ * Prints an error message.
+ */
+static int metError(char* msg, int err) {
+  char* msg2;
+  if (err == ERRMETOPEN) msg2 = MERRMETOPEN;
+  else if (err == ERRMETINT) msg2 = MERRMETINT;
+  else msg2 = "Unknown error";
+
+  fprintf(stderr, "Error! %s%s\n", msg, msg2);
+  return -1;
+}
+
+/* double getTime()
+ * Returns the current (monotonic) time in seconds.
+ */
+static double getTime(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* void initMetrics()
+ * Initializes the metrics (off).
+ */
+void initMetrics(Metrics* m, char* tool) {
+  m->on = 0;
+  m->file = NULL;
+  m->tool = tool;
+  m->every = DEFMETINT;
+  m->check = METCHECK;
+  m->nIn = m->nOut = m->nCount = 0;
+}
+
+/* void setMetInt()
+ * Sets the seconds between reports (and turns metrics on).
+ */
+void setMetInt(Metrics* m, char* arg) {
+  char* endptr;
+  m->every = (int) strtol(arg, &endptr, 10);
+  if (*endptr != '\0' || m->every <= 0)
+    exit(metError(arg, ERRMETINT));
+  m->on = 1;
+}
+
+/* void metricsIn()
+ * Adds an input file whose bytes are counted.
+ */
+void metricsIn(Metrics* m, File* in, int gz) {
+  if (m->nIn < METMAX) {
+    m->in[m->nIn] = in;
+    m->inGz[m->nIn++] = gz;
+  }
+}
+
+/* void metricsOut()
+ * Adds an output file whose bytes are counted.
+ */
+void metricsOut(Metrics* m, File* out, int gz) {
+  if (m->nOut < METMAX) {
+    m->out[m->nOut] = out;
+    m->outGz[m->nOut++] = gz;
+  }
+}
+
+/* void metricsCount()
+ * Adds an outcome counter.
+ */
+void metricsCount(Metrics* m, char* name, int* count) {
+  if (m->nCount < METMAX) {
+    m->name[m->nCount] = name;
+    m->count[m->nCount++] = count;
+  }
+}
+
+/* long long inBytes()
+ * Returns the bytes read from the input files (compressed
+ *   bytes for gzip inputs).
+ */
+static long long inBytes(Metrics* m) {
+  long long sum = 0;
+  for (int i = 0; i < m->nIn; i++)
+    sum += m->inGz[i] ? (long long) gzoffset(m->in[i]->gzf)
+      : (long long) ftello(m->in[i]->f);
+  return sum;
+}
+
+/* long long outBytes()
+ * Returns the bytes written to the output files
+ *   (uncompressed).
+ */
+static long long outBytes(Metrics* m) {
+  long long sum = 0;
+  for (int i = 0; i < m->nOut; i++)
+    sum += m->outGz[i] ? (long long) gztell(m->out[i]->gzf)
+      : (long long) ftello(m->out[i]->f);
+  return sum;
+}
+
+/* void startMetrics()
+ * Saves the time, input position, and read count at the
+ *   start (which is not 0 when resuming from a checkpoint).
+ */
+void startMetrics(Metrics* m, int reads) {
+  if (! m->on)
+    return;
+  m->start = m->last = getTime();
+  m->in0 = m->lastIn = inBytes(m);
+  m->lastOut = outBytes(m);
+  m->lastReads = reads;
+}
+
+/* void writeProm()
+ * Writes the Prometheus textfile (via a temporary file,
+ *   so the collector never sees a partial file).
+ */
+static void writeProm(Metrics* m, long long reads, double rate,
+    long long in, double inRate, long long out, double outRate,
+    double elapsed) {
+  char* temp = (char*) malloc(strlen(m->file) + strlen(METTEMP) + 1);
+  if (temp == NULL)
+    exit(metError(m->file, ERRMETOPEN));
+  strcpy(temp, m->file);
+  strcat(temp, METTEMP);
+  FILE* f = fopen(temp, "w");
+  if (f == NULL)
+    exit(metError(temp, ERRMETOPEN));
+
+  fprintf(f, "# HELP %s_reads_total Reads analyzed.\n", METPREFIX);
+  fprintf(f, "# TYPE %s_reads_total counter\n", METPREFIX);
+  fprintf(f, "%s_reads_total{tool=\"%s\"} %lld\n", METPREFIX, m->tool, reads);
+  fprintf(f, "# HELP %s_reads_per_second Reads analyzed per second (last interval).\n", METPREFIX);
+  fprintf(f, "# TYPE %s_reads_per_second gauge\n", METPREFIX);
+  fprintf(f, "%s_reads_per_second{tool=\"%s\"} %.1f\n", METPREFIX, m->tool, rate);
+  fprintf(f, "# HELP %s_input_bytes_total Bytes read from input files.\n", METPREFIX);
+  fprintf(f, "# TYPE %s_input_bytes_total counter\n", METPREFIX);
+  fprintf(f, "%s_input_bytes_total{tool=\"%s\"} %lld\n", METPREFIX, m->tool, in);
+  fprintf(f, "# HELP %s_input_bytes_per_second Input bytes per second (last interval).\n", METPREFIX);
+  fprintf(f, "# TYPE %s_input_bytes_per_second gauge\n", METPREFIX);
+  fprintf(f, "%s_input_bytes_per_second{tool=\"%s\"} %.1f\n", METPREFIX, m->tool, inRate);
+  fprintf(f, "# HELP %s_output_bytes_total Bytes written to output files (uncompressed).\n", METPREFIX);
+  fprintf(f, "# TYPE %s_output_bytes_total counter\n", METPREFIX);
+  fprintf(f, "%s_output_bytes_total{tool=\"%s\"} %lld\n", METPREFIX, m->tool, out);
+  fprintf(f, "# HELP %s_output_bytes_per_second Output bytes per second (last interval).\n", METPREFIX);
+  fprintf(f, "# TYPE %s_output_bytes_per_second gauge\n", METPREFIX);
+  fprintf(f, "%s_output_bytes_per_second{tool=\"%s\"} %.1f\n", METPREFIX, m->tool, outRate);
+  fprintf(f, "# HELP %s_reads_outcome_total Reads analyzed, by outcome.\n", METPREFIX);
+  fprintf(f, "# TYPE %s_reads_outcome_total counter\n", METPREFIX);
+  for (int i = 0; i < m->nCount; i++)
+    fprintf(f, "%s_reads_outcome_total{tool=\"%s\",outcome=\"%s\"} %d\n",
+      METPREFIX, m->tool, m->name[i], *m->count[i]);
+  fprintf(f, "# HELP %s_elapsed_seconds Seconds since the start of the run.\n", METPREFIX);
+  fprintf(f, "# TYPE %s_elapsed_seconds gauge\n", METPREFIX);
+  fprintf(f, "%s_elapsed_seconds{tool=\"%s\"} %.1f\n", METPREFIX, m->tool, elapsed);
+
+  if (fclose(f) || rename(temp, m->file))
+    exit(metError(m->file, ERRMETOPEN));
+  free(temp);
+}
+
+/* void updateMetrics()
+ * Reports the metrics if the interval has passed (or if
+ *   this is the final report).
+ */
+void updateMetrics(Metrics* m, int reads, int final) {
+  m->check = METCHECK;
+  double now = getTime();
+  if (! final && now - m->last < m->every)
+    return;
+
+  // calculate rates over the last interval
+  double sec = now - m->last;
+  if (sec <= 0.0)
+    sec = 1e-9;
+  long long in = inBytes(m), out = outBytes(m);
+  double rate = (reads - m->lastReads) / sec;
+  double inRate = (in - m->lastIn) / sec;
+  double outRate = (out - m->lastOut) / sec;
+
+  fprintf(stderr, "%s: %d reads (%.0f reads/s), in %.2f MB/s, out %.2f MB/s",
+    m->tool, reads, rate, inRate / 1e6, outRate / 1e6);
+  for (int i = 0; i < m->nCount; i++)
+    fprintf(stderr, "%s %s %d", i ? "," : ";", m->name[i], *m->count[i]);
+  fprintf(stderr, "%s\n", final ? " (done)" : "");
+  if (m->file != NULL)
+    writeProm(m, reads, rate, in - m->in0, inRate, out, outRate,
+      now - m->start);
+
+  m->last = now;
+  m->lastReads = reads;
+  m->lastIn = in;
+  m->lastOut = out;
+}
@@ -0,0 +1,52 @@
+/*
+  October 2026
+
+  Header file for metrics.c.
+*/
+
+#define METMAX      8       // maximum number of files/outcomes
+#define METCHECK    1024    // reads between checks of the clock
+#define DEFMETINT   10      // default seconds between reports
+#define METTEMP     ".tmp"  // extension for metrics file being written
+#define METPREFIX   "amplicontools"
+
+// command-line parameters (shared by stitch, removePrimer, qualTrim)
+#define METINT      "-mi"
+#define METFILE     "-mp"
+
+// error messages
+#define ERRMETOPEN  0
+#define MERRMETOPEN ": cannot open metrics file for writing"
+#define ERRMETINT   1
+#define MERRMETINT  ": metrics interval must be greater than 0"
+
+typedef struct metrics {
+  int on;              // metrics enabled
+  char* file;          // Prometheus textfile (NULL = none)
+  char* tool;          // name of the program
+  int every;           // seconds between reports
+  int check;           // reads until next check of the clock
+  double start;        // time at start
+  double last;         //   and at last report
+  long long lastReads; // counts at last report
+  long long lastIn;
+  long long lastOut;
+  long long in0;       // input position at start
+  int nIn;
+  File* in[METMAX];
+  int inGz[METMAX];
+  int nOut;
+  File* out[METMAX];
+  int outGz[METMAX];
+  int nCount;          // outcome counters
+  char* name[METMAX];
+  int* count[METMAX];
+} Metrics;
+
+void initMetrics(Metrics* m, char* tool);
+void setMetInt(Metrics* m, char* arg);
+void metricsIn(Metrics* m, File* in, int gz);
+void metricsOut(Metrics* m, File* out, int gz);
+void metricsCount(Metrics* m, char* name, int* count);
+void startMetrics(Metrics* m, int reads);
+void updateMetrics(Metrics* m, int reads, int final);
@@ -0,0 +1,217 @@
+/*
+  October 2026
+
+  Reading a panel bundle (made by buildPanel): the primers,
+    their reverse-complements and IUPAC masks, the target
+    sequences, and the BED coordinates of the amplicons,
+    compiled into one binary file that is memory-mapped.
+  The bundle records the size, mtime, and CRC-32 of each of
+    its source files; a source that has since changed (its
+    checksum differs) makes the bundle stale.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+#define _FILE_OFFSET_BITS 64
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <zlib.h>
+#include "panel.h"
+
+/* int pnlError()
+ * Prints an error message.
+ */
+static int pnlError(char* msg, int err) {
+  char* msg2;
+  if (err == ERRPNLOPEN) msg2 = MERRPNLOPEN;
+  else if (err == ERRPNLVER) msg2 = MERRPNLVER;
+  else if (err == ERRPNLBAD) msg2 = MERRPNLBAD;
+  else if (err == ERRPNLOLD) msg2 = MERRPNLOLD;
+  else if (err == ERRPNLSRC) msg2 = MERRPNLSRC;
+  else msg2 = "Unknown error";
+
+  fprintf(stderr, "Error! %s%s\n", msg, msg2);
+  return -1;
+}
+
+/* int isPanel()
+ * Returns 1 if the file is a panel bundle (of any version).
+ */
+int isPanel(char* file) {
+  FILE* f = fopen(file, "rb");
+  if (f == NULL)
+    return 0;
+  char magic[8];
+  int ans = fread(magic, 1, sizeof(magic), f) == sizeof(magic)
+    && !strncmp(magic, PNLMAGIC, sizeof(magic));
+  fclose(f);
+  return ans;
+}
+
+/* int64_t fileTime()
+ * Returns the mtime of a file, in nanoseconds.
+ */
+static int64_t fileTime(struct stat* st) {
+  return (int64_t) st->st_mtim.tv_sec * 1000000000 + st->st_mtim.tv_nsec;
+}
+
+/* uint32_t fileCrc()
+ * Returns the CRC-32 of a file; saves its size and mtime.
+ */
+uint32_t fileCrc(char* file, uint64_t* size, int64_t* mtime) {
+  int fd = open(file, O_RDONLY);
+  struct stat st;
+  if (fd == -1 || fstat(fd, &st))
+    exit(pnlError(file, ERRPNLOPEN));
+  *size = st.st_size;
+  *mtime = fileTime(&st);
+  unsigned char* buf = (unsigned char*) malloc(PNLBUF);
+  if (buf == NULL)
+    exit(pnlError(file, ERRPNLOPEN));
+  uLong crc = crc32(0L, Z_NULL, 0);
+  ssize_t n;
+  while ((n = read(fd, buf, PNLBUF)) > 0)
+    crc = crc32(crc, buf, n);
+  if (n == -1)
+    exit(pnlError(file, ERRPNLOPEN));
+  close(fd);
+  free(buf);
+  return (uint32_t) crc;
+}
+
+/* int srcChanged()
+ * Returns 1 if a source file of the bundle has changed (a
+ *   missing source is not checked). The checksum is
+ *   computed only if the size or mtime differs.
+ */
+static int srcChanged(Panel* pn, int i) {
+  PnlSrc* s = pn->src + i;
+  if (! s->path)
+    return 0;
+  struct stat st;
+  char* path = pn->str + s->path;
+  if (stat(path, &st))
+    return 0;
+  if ((uint64_t) st.st_size == s->size && fileTime(&st) == s->mtime)
+    return 0;
+  uint64_t size;
+  int64_t mtime;
+  return fileCrc(path, &size, &mtime) != s->crc;
+}
+
+/* int mapPanel()
+ * Maps a panel bundle (read-only). Returns -1 if it is
+ *   valid, or the error.
+ */
+static int mapPanel(char* file, Panel* pn) {
+  pn->map = NULL;
+  int fd = open(file, O_RDONLY);
+  struct stat st;
+  if (fd == -1 || fstat(fd, &st)) {
+    if (fd != -1)
+      close(fd);
+    return ERRPNLOPEN;
+  }
+  if ((size_t) st.st_size < sizeof(PnlHead)) {
+    close(fd);
+    return ERRPNLBAD;
+  }
+  void* map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED)
+    return ERRPNLOPEN;
+
+  // check header
+  PnlHead* h = (PnlHead*) map;
+  size_t size = sizeof(PnlHead) + PNLSRC * sizeof(PnlSrc)
+    + (size_t) h->nAmp * (sizeof(PnlAmp) + sizeof(uint32_t)) + h->strLen;
+  int err = -1;
+  if (strncmp(h->magic, PNLMAGIC, sizeof(h->magic)))
+    err = ERRPNLBAD;
+  else if (h->version != PNLVERSION)
+    err = ERRPNLVER;
+  else if ((size_t) st.st_size != size || ! h->strLen
+      || ((char*) map)[size - 1] != '\0')
+    err = ERRPNLBAD;
+  if (err != -1) {
+    munmap(map, st.st_size);
+    return err;
+  }
+
+  // set pointers into bundle
+  pn->map = map;
+  pn->size = size;
+  pn->head = h;
+  char* p = (char*) map + sizeof(PnlHead);
+  pn->src = (PnlSrc*) p;
+  p += PNLSRC * sizeof(PnlSrc);
+  pn->amp = (PnlAmp*) p;
+  p += h->nAmp * sizeof(PnlAmp);
+  pn->byName = (uint32_t*) p;
+  p += h->nAmp * sizeof(uint32_t);
+  pn->str = p;
+  return -1;
+}
+
+/* void openPanel()
+ * Maps a panel bundle, and checks that its version is
+ *   current and its sources unchanged.
+ */
+void openPanel(char* file, Panel* pn) {
+  int err = mapPanel(file, pn);
+  if (err != -1)
+    exit(pnlError(file, err));
+  for (int i = 0; i < PNLSRC; i++)
+    if (srcChanged(pn, i))
+      exit(pnlError(pn->str + pn->src[i].path, ERRPNLOLD));
+}
+
+/* int panelCurrent()
+ * Returns 1 if the file is a bundle of the current version,
+ *   made from the given sources (absolute paths; NULL if
+ *   none), which are unchanged.
+ */
+int panelCurrent(char* file, char** src) {
+  Panel pn;
+  if (mapPanel(file, &pn) != -1)
+    return 0;
+  int ans = 1;
+  for (int i = 0; ans && i < PNLSRC; i++) {
+    PnlSrc* s = pn.src + i;
+    if (src[i] == NULL)
+      ans = ! s->path;
+    else
+      ans = s->path && !strcmp(pn.str + s->path, src[i])
+        && ! access(src[i], F_OK) && ! srcChanged(&pn, i);
+  }
+  closePanel(&pn);
+  return ans;
+}
+
+/* void checkPanelSrc()
+ * Checks that a file given along with the bundle (e.g. the
+ *   BED file) is its source, by checksum.
+ */
+void checkPanelSrc(Panel* pn, int src, char* file) {
+  PnlSrc* s = pn->src + src;
+  uint64_t size;
+  int64_t mtime;
+  if (! s->path || fileCrc(file, &size, &mtime) != s->crc)
+    exit(pnlError(file, ERRPNLSRC));
+}
+
+/* void closePanel()
+ * Unmaps a panel bundle.
+ */
+void closePanel(Panel* pn) {
+  if (pn->map != NULL)
+    munmap(pn->map, pn->size);
+  pn->map = NULL;
+}
@@ -0,0 +1,76 @@
+/*
+  October 2026
+
+  Header file for panel.c.
+*/
+
+#define PNLMAGIC    "AMPPNL"  // file begins with magic and version
+#define PNLVERSION  1
+#define PNLBUF      65536  // buffer for checksums of source files
+
+// source files of a bundle
+#define PNLPRIM     0      // primers file (getPrimers.pl)
+#define PNLBED      1      // BED file
+#define PNLGEN      2      // reference genome (optional)
+#define PNLSRC      3
+
+// error messages
+#define ERRPNLOPEN  0
+#define MERRPNLOPEN ": cannot open panel bundle"
+#define ERRPNLVER   1
+#define MERRPNLVER  ": panel bundle of another version (rebuild with buildPanel)"
+#define ERRPNLBAD   2
+#define MERRPNLBAD  ": invalid panel bundle"
+#define ERRPNLOLD   3
+#define MERRPNLOLD  ": source of panel bundle has changed (rebuild with buildPanel)"
+#define ERRPNLSRC   4
+#define MERRPNLSRC  ": not the BED file of the panel bundle"
+
+// bundle: header, sources, amplicons (in order of the primers
+//   file), index of amplicons by name, strings (NUL-terminated;
+//   referenced by offset)
+typedef struct pnlHead {
+  char magic[8];
+  uint32_t version;
+  uint32_t nAmp;
+  uint64_t strLen;
+} PnlHead;
+
+typedef struct pnlSrc {
+  uint32_t path;     // absolute path (0 = none)
+  uint32_t crc;      // CRC-32 of the file
+  uint64_t size;     // size and mtime (ns), when checksummed
+  int64_t mtime;
+} PnlSrc;
+
+typedef struct pnlAmp {
+  uint32_t name;
+  uint32_t fwd;      // primers (as in primers file)
+  uint32_t rev;
+  uint32_t frc;      // reverse-complements
+  uint32_t rrc;
+  uint32_t mask[4];  // IUPAC masks of fwd, rev, frc, rrc (A=1,
+                     //   C=2, G=4, T=8 per base)
+  uint32_t tgt;      // target sequence (empty if not in file)
+  uint32_t chr;      // chromosome (from BED)
+  int32_t nBed;      // lines of BED file (first two, in order)
+  int32_t st[2];     // 0-based start and end of each primer
+  int32_t end[2];
+} PnlAmp;
+
+typedef struct panel {
+  void* map;
+  size_t size;
+  PnlHead* head;
+  PnlSrc* src;
+  PnlAmp* amp;
+  uint32_t* byName;  // amplicons, sorted by name
+  char* str;
+} Panel;
+
+int isPanel(char* file);
+uint32_t fileCrc(char* file, uint64_t* size, int64_t* mtime);
+void openPanel(char* file, Panel* pn);
+int panelCurrent(char* file, char** src);
+void checkPanelSrc(Panel* pn, int src, char* file);
+void closePanel(Panel* pn);
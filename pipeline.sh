@@ -0,0 +1,136 @@
+# Oct. 2026
+
+# Runs the steps of a pipeline (sourced by run.sh) as a graph
+#   of dependencies: independent steps run concurrently, within
+#   a budget of CPUs, and a step that reads the output of another
+#   as it is written is started with it, through a named pipe.
+#
+#   step  <name>  <deps>  <cpus>  <command>
+#     <deps>  names of steps that must finish first; "<name>|"
+#               instead starts the step with <name>, whose output
+#               it reads through a FIFO (declared with 'fifo')
+#   fifo  <file> ...
+#   runSteps  <cpus>  <concurrent>
+#     <concurrent>  0 to run the steps one at a time, in the
+#               order given, with regular files in place of FIFOs
+
+stepList=()         # names of steps, in order given
+declare -A stepDeps stepCpus stepCmd stepPid stepState stepGroup
+fifoList=()
+
+# add a step to the graph
+step() {
+  stepList+=("$1")
+  stepDeps[$1]=$2
+  stepCpus[$1]=$3
+  stepCmd[$1]=$4
+  stepState[$1]=wait
+  stepGroup[$1]=$1
+}
+
+# declare files to be created as FIFOs
+fifo() {
+  fifoList+=("$@")
+}
+
+# kill a process and its descendants
+killTree() {
+  local child
+  for child in $(ps -o pid= --ppid $1 2> /dev/null); do
+    killTree $child
+  done
+  kill $1 2> /dev/null || true
+}
+
+# check if the steps of a group can start: each dependency outside
+#   the group has finished
+groupReady() {
+  local s d
+  for s in "${stepList[@]}"; do
+    [ "${stepGroup[$s]}" == "$1" ] || continue
+    for d in ${stepDeps[$s]}; do
+      d=${d%|}
+      if [ -z "${stepState[$d]}" ]; then
+        echo "Error! Step $s depends on unknown step $d" 1>&2
+        exit -1
+      fi
+      [[ "${stepGroup[$d]}" == "$1" || "${stepState[$d]}" == done ]] \
+        || return 1
+    done
+  done
+  return 0
+}
+
+# run the steps
+runSteps() {
+  local budget=$1 conc=$2
+  local s d g used=0 left=${#stepList[@]}
+  local stat=$(mktemp -d .steps.XXXXXX)
+
+  # group steps connected by FIFOs (started together)
+  if [ $conc -eq 1 ]; then
+    for s in "${stepList[@]}"; do
+      for d in ${stepDeps[$s]}; do
+        [ "${d%|}" != "$d" ] || continue
+        local from=${stepGroup[$s]} to=${stepGroup[${d%|}]}
+        for g in "${stepList[@]}"; do
+          [ "${stepGroup[$g]}" != "$from" ] || stepGroup[$g]=$to
+        done
+      done
+    done
+    for s in "${fifoList[@]}"; do
+      rm -f $s
+      mkfifo $s
+    done
+  else
+    budget=1
+  fi
+
+  while [ $left -gt 0 ]; do
+    # start groups that are ready, in order given, within the budget
+    #   (a group larger than the budget starts when nothing runs)
+    local started=""
+    for s in "${stepList[@]}"; do
+      g=${stepGroup[$s]}
+      [[ "${stepState[$s]}" == wait && " $started " != *" $g "* ]] \
+        || continue
+      started="$started $g"
+      groupReady $g || { [ $conc -eq 1 ] && continue || break; }
+      local cpus=0
+      for d in "${stepList[@]}"; do
+        [ "${stepGroup[$d]}" != "$g" ] || cpus=$((cpus + ${stepCpus[$d]}))
+      done
+      [[ $used -eq 0 || $((used + cpus)) -le $budget ]] || continue
+      used=$((used + cpus))
+      for d in "${stepList[@]}"; do
+        [ "${stepGroup[$d]}" == "$g" ] || continue
+        stepState[$d]=run
+        ( set +e; ( set -e; eval "${stepCmd[$d]}" ); echo $? > $stat/$d ) &
+        stepPid[$d]=$!
+      done
+    done
+    if [ $used -eq 0 ]; then
+      echo "Error! Steps cannot start (circular dependencies?)" 1>&2
+      exit -1
+    fi
+
+    # wait for a step to finish
+    wait -n || true
+    for s in "${stepList[@]}"; do
+      [[ "${stepState[$s]}" == run && -f $stat/$s ]] || continue
+      wait ${stepPid[$s]} || true
+      stepState[$s]=done
+      used=$((used - ${stepCpus[$s]}))
+      left=$((left - 1))
+      if [ "$(cat $stat/$s)" != "0" ]; then
+        echo "Error! Step $s failed" 1>&2
+        for d in "${stepList[@]}"; do
+          [ "${stepState[$d]}" != run ] || killTree ${stepPid[$d]}
+        done
+        rm -rf $stat
+        exit -1
+      fi
+    done
+  done
+  rm -rf $stat
+}
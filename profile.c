@@ -0,0 +1,79 @@
+/*
+  October 2026
+
+  Hot-path profiling counters (see profile.h). Timers use
+    the x86 time-stamp counter (cycles) where available,
+    and clock_gettime (ns) otherwise. The report, printed
+    to stderr at exit, lists for each kernel/stage the
+    calls, its own counters per call, and the share of the
+    total time.
+*/
+
+#ifdef PROFILE
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <time.h>
+#include "profile.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TICKUNIT    "Mcycles"
+#else
+#define TICKUNIT    "ms"
+#endif
+
+static unsigned long long profStart;
+
+/* unsigned long long profTicks()
+ * Returns the current time stamp.
+ */
+unsigned long long profTicks(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+/* void profInit()
+ * Saves the time at the start of the run.
+ */
+void profInit(void) {
+  profStart = profTicks();
+}
+
+/* void profReport()
+ * Prints the per-kernel/stage breakdown.
+ */
+void profReport(char* tool) {
+  double total = (double) (profTicks() - profStart);
+  if (total <= 0.0)
+    total = 1.0;
+  fprintf(stderr, "Profile of %s (total %.1f %s):\n", tool,
+    total / 1e6, TICKUNIT);
+  fprintf(stderr, "  %-12s %12s %10s %7s  %s\n", "Kernel", "Calls",
+    TICKUNIT, "%Time", "Counters");
+  for (int i = 0; i < profLen; i++) {
+    ProfStat* p = prof + i;
+    fprintf(stderr, "  %-12s %12llu", p->name, p->calls);
+    if (p->ticks)
+      fprintf(stderr, " %10.1f %6.1f%%", p->ticks / 1e6,
+        100.0 * p->ticks / total);
+    else
+      fprintf(stderr, " %10s %7s", "-", "-");
+    fprintf(stderr, " ");
+    if (p->iterName != NULL)
+      fprintf(stderr, " %s %llu (%.2f/call)", p->iterName, p->iters,
+        p->calls ? (double) p->iters / p->calls : 0.0);
+    if (p->exitName != NULL)
+      fprintf(stderr, " %s %llu (%.1f%%)", p->exitName, p->exits,
+        p->calls ? 100.0 * p->exits / p->calls : 0.0);
+    fprintf(stderr, "\n");
+  }
+}
+
+#endif
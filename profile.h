@@ -0,0 +1,52 @@
+/*
+  October 2026
+
+  Header file for profile.c.
+  Hot-path profiling counters, compiled in only with
+    -DPROFILE ("make PROFILE=1"); otherwise, the macros
+    expand to nothing. PROF_LAP(k, t) adds the time since
+    't' to kernel/stage 'k' and restarts 't', so that
+    consecutive stages of a loop need one timer read each.
+*/
+
+#ifdef PROFILE
+
+typedef struct profStat {
+  char* name;                // kernel or stage
+  char* iterName;            // what 'iters' counts (NULL = unused)
+  char* exitName;            // what 'exits' counts (NULL = unused)
+  unsigned long long calls;
+  unsigned long long iters;
+  unsigned long long exits;
+  unsigned long long ticks;  // time spent (cycles or ns)
+} ProfStat;
+
+// defined by each program
+extern ProfStat prof[];
+extern int profLen;
+
+void profInit(void);
+unsigned long long profTicks(void);
+void profReport(char* tool);
+
+#define PROF_INIT()         profInit()
+#define PROF_CALL(k)        (prof[k].calls++)
+#define PROF_ITER(k, n)     (prof[k].iters += (n))
+#define PROF_EXIT(k)        (prof[k].exits++)
+#define PROF_START(t)       unsigned long long t = profTicks()
+#define PROF_LAP(k, t)      do { unsigned long long now_ = profTicks(); \
+                              prof[k].ticks += now_ - (t); \
+                              (t) = now_; } while (0)
+#define PROF_REPORT(tool)   profReport(tool)
+
+#else
+
+#define PROF_INIT()
+#define PROF_CALL(k)
+#define PROF_ITER(k, n)
+#define PROF_EXIT(k)
+#define PROF_START(t)
+#define PROF_LAP(k, t)
+#define PROF_REPORT(tool)
+
+#endif
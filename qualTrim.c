@@ -9,6 +9,10 @@
 #include <stdlib.h>
 #include <string.h>
 #include <zlib.h>
+#include "shard.h"
+#include "metrics.h"
+#include "collapse.h"
+#include "simd.h"
 #include "qualTrim.h"
 
 /* void usage()
@@ -33,6 +37,20 @@ void usage(void) {
   fprintf(stderr, "  %s          Option to trim reads only at 5' end\n", FIVEOPT);
   fprintf(stderr, "  %s          Option to trim reads only at 3' end\n", THREEOPT);
   fprintf(stderr, "  %s         Option to print counts of results to stdout\n", VERBOSE);
+  fprintf(stderr, "  %s <int/int>  Process only the given shard of the input, e.g.\n", SHARDOPT);
+  fprintf(stderr, "                2/8 for the 2nd of 8 equal byte ranges of the\n");
+  fprintf(stderr, "                file (must be plain or BGZF compressed)\n");
+  fprintf(stderr, "  %s <int,int>  Process only reads beginning in the given\n", SHARDBYTE);
+  fprintf(stderr, "                byte range of the file (alternative to %s)\n", SHARDOPT);
+  fprintf(stderr, "  %s <int>    Seconds between progress reports (reads/sec,\n", METINT);
+  fprintf(stderr, "                bytes/sec, and counts) printed to stderr\n");
+  fprintf(stderr, "                (def. %d, if %s given)\n", DEFMETINT, METFILE);
+  fprintf(stderr, "  %s <file>   Prometheus textfile to which progress metrics\n", METFILE);
+  fprintf(stderr, "                are written with each report\n");
+  fprintf(stderr, "  %s <file>   Option to collapse reads with identical sequences\n", CLFILE);
+  fprintf(stderr, "                into one record (\"%s<int>\" appended to name,\n", CLSIZE);
+  fprintf(stderr, "                max. quality scores); reads of each record are\n");
+  fprintf(stderr, "                listed in the given mapping file\n");
   exit(-1);
 }
 
@@ -94,19 +112,15 @@ int getEnd(char* line, int len, float qual, int end) {
   int last = 0;
   int i;
   for (i = 1; i < len; i++) {
-    float sum = 0.0f;
     int j = end - 1;
-    for (int k = 0; k < i; k++)
-      sum += line[j - k] - OFFSET;
+    float sum = simd.qualSum(line + j - i + 1, i) - i * OFFSET;
     if (sum / i < qual)
       last = j - i + 1;
     else if (last)
       return last;
   }
   for (i = end - 1; i > len - 2; i--) {
-    float sum = 0.0f;
-    for (int j = 0; j < len; j++)
-      sum += line[i - j] - OFFSET;
+    float sum = simd.qualSum(line + i - len + 1, len) - len * OFFSET;
     if (sum / len < qual)
       last = i - len + 1;
     else if (last)
@@ -124,18 +138,14 @@ int getStart(char* line, int len, float qual, int end) {
   int st = 0;
   int i;
   for (i = 1; i < len; i++) {
-    float sum = 0.0f;
-    for (int k = 0; k < i; k++)
-      sum += line[k] - OFFSET;
+    float sum = simd.qualSum(line, i) - i * OFFSET;
     if (sum / i < qual)
       st = i;
     else if (st)
       return st;
   }
   for (i = 0; i < end - len + 1; i++) {
-    float sum = 0.0f;
-    for (int j = 0; j < len; j++)
-      sum += line[i + j] - OFFSET;
+    float sum = simd.qualSum(line + i, len) - len * OFFSET;
     if (sum / len < qual)
       st = i + len;
     else if (st)
@@ -164,9 +174,7 @@ int trimQual(char* line, int len, float qual, int* end,
  * Return 1 if OK, else 0.
  */
 int checkQual(char* line, int st, int end, float avg) {
-  float sum = 0.0f;
-  for (int i = st; i < end; i++)
-    sum += line[i] - OFFSET;
+  float sum = simd.qualSum(line + st, end - st) - (end - st) * OFFSET;
   return sum / (end - st) < avg ? 1 : 0;
 }
 
@@ -185,15 +193,21 @@ char* getLine(char* line, int size, File in, int gz) {
  */
 void readFile(File in, File out, int len, float qual,
     float avg, int minLen, int opt5, int opt3,
-    int gz, int verbose) {
+    int gz, int verbose, Shard* sh, Metrics* m, Collapse* cl) {
   char* head = (char*) memalloc(MAX_SIZE);
   char* seq = (char*) memalloc(MAX_SIZE);
   char* line = (char*) memalloc(MAX_SIZE);
 
   int count = 0, elim = 0;
-  while (getLine(head, MAX_SIZE, in, gz) != NULL) {
+  metricsCount(m, "printed", &count);
+  metricsCount(m, "eliminated", &elim);
+  startMetrics(m, 0);
+  while (inShard(in, gz, sh) &&
+      getLine(head, MAX_SIZE, in, gz) != NULL) {
     if (head[0] != '@')
       continue;
+    if (m->on && --m->check <= 0)
+      updateMetrics(m, count + elim, 0);
 
     // load sequence and quality scores
     if (getLine(seq, MAX_SIZE, in, gz) == NULL)
@@ -220,6 +234,11 @@ void readFile(File in, File out, int len, float qual,
 
     // print output
     if (st < end && end - st >= minLen) {
+      count++;
+      if (cl->file != NULL) {
+        collapseRead(cl, head, seq + st, end - st, line + st);
+        continue;
+      }
       gz ? gzprintf(out.gzf, "%s", head)
         : fprintf(out.f, "%s", head);
       for (int i = st; i < end; i++)
@@ -230,11 +249,14 @@ void readFile(File in, File out, int len, float qual,
         gz ? gzputc(out.gzf, line[i]) : putc(line[i], out.f);
       gz ? gzprintf(out.gzf, "\n")
         : fprintf(out.f, "\n");
-      count++;
     } else
       elim++;
   }
 
+  if (cl->file != NULL)
+    writeCollapse(cl, out, gz, 1);
+  if (m->on)
+    updateMetrics(m, count + elim, 1);
   if (verbose)
     printf("Reads printed: %d\nReads eliminated: %d\n",
       count, elim);
@@ -273,8 +295,10 @@ void openWrite(char* outFile, File* out, int gz) {
  * Open input and output files.
  */
 void openFiles(char* outFile, File* out,
-    char* inFile, File* in, int gz) {
-  if (gz) {
+    char* inFile, File* in, int gz, Shard* sh) {
+  if (isShard(sh))
+    openShard(inFile, in, gz, 1, sh);
+  else if (gz) {
     in->gzf = gzopen(inFile, "r");
     if (in->gzf == NULL)
       exit(error(inFile, ERROPEN));
@@ -295,6 +319,12 @@ void getParams(int argc, char** argv) {
   int windowLen = 0, minLen = 0, opt5 = 1, opt3 = 1;
   int verbose = 0;
   float windowAvg = 0.0f, qualAvg = 0.0f;
+  Shard sh;
+  initShard(&sh);
+  Metrics m;
+  initMetrics(&m, "qualTrim");
+  Collapse cl;
+  initCollapse(&cl);
 
   // parse argv
   for (int i = 1; i < argc; i++) {
@@ -319,6 +349,17 @@ void getParams(int argc, char** argv) {
         qualAvg = getFloat(argv[++i]);
       else if (!strcmp(argv[i], MINLEN))
         minLen = getInt(argv[++i]);
+      else if (!strcmp(argv[i], SHARDOPT))
+        parseShard(argv[++i], &sh);
+      else if (!strcmp(argv[i], SHARDBYTE))
+        parseShardBytes(argv[++i], &sh);
+      else if (!strcmp(argv[i], METINT))
+        setMetInt(&m, argv[++i]);
+      else if (!strcmp(argv[i], METFILE)) {
+        m.file = argv[++i];
+        m.on = 1;
+      } else if (!strcmp(argv[i], CLFILE))
+        cl.file = argv[++i];
       else
         exit(error(argv[i], ERRPARAM));
     } else
@@ -333,9 +374,11 @@ void getParams(int argc, char** argv) {
   int gz = 0;
   if (!strcmp(inFile + strlen(inFile) - strlen(GZEXT), GZEXT))
     gz = 1;
-  openFiles(outFile, &out, inFile, &in, gz);
+  openFiles(outFile, &out, inFile, &in, gz, &sh);
+  metricsIn(&m, &in, gz);
+  metricsOut(&m, &out, gz);
   readFile(in, out, windowLen, windowAvg, qualAvg,
-    minLen, opt5, opt3, gz, verbose);
+    minLen, opt5, opt3, gz, verbose, &sh, &m, &cl);
 
   if ( (gz && (gzclose(in.gzf) != Z_OK || gzclose(out.gzf) != Z_OK))
       || ( ! gz && (fclose(in.f) || fclose(out.f))) )
@@ -346,6 +389,7 @@ void getParams(int argc, char** argv) {
  * Main.
  */
 int main(int argc, char* argv[]) {
+  initSimd();
   getParams(argc, argv);
   return 0;
 }
@@ -39,8 +39,3 @@
 #define ERRINT      7
 #define MERRINT     ": cannot convert to int"
 #define DEFERR      "Unknown error"
-
-typedef union file {
-  FILE* f;
-  gzFile gzf;
-} File;
@@ -8,13 +8,36 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 #include <zlib.h>
+#include "shard.h"
+#include "checkpoint.h"
+#include "metrics.h"
+#include "profile.h"
+#include "collapse.h"
+#include "service.h"
+#include "panel.h"
+#include "simd.h"
 #include "removePrimer.h"
 
 // global variables
 static char* line;
 static char* hline;
 static Primer* primo;
+static char* svPrim;   // panel loaded by a service (primers, BED file)
+static char* svBed;
+static int svPairs;
+static Panel pnl;      // panel bundle (buildPanel), if loaded
+
+#ifdef PROFILE
+ProfStat prof[] = { {"read", NULL, NULL},
+  {"findPrim", "primers", "hits"},
+  {"checkRevEnd", "offsets", "hits"},
+  {"checkRevInt", "positions", "hits"},
+  {"checkRevLen", "offsets", "hits"},
+  {"output", NULL, NULL} };
+int profLen = 6;
+#endif
 
 /* void usage()
  * Prints usage information.
@@ -34,6 +57,8 @@ void usage(void) {
   fprintf(stderr, "                     NOTE: Both primers should be given with respect to the plus\n");
   fprintf(stderr, "                       strand, i.e. the sequence given for the reverse primer is\n");
   fprintf(stderr, "                       the reverse-complement of actual reverse primer\n");
+  fprintf(stderr, "                     Can also be a panel bundle (made by buildPanel), with\n");
+  fprintf(stderr, "                       the amplicon lengths for %s, %s\n", BEDFILE, LENBED);
   fprintf(stderr, "  %s  <file>       Output file for trimmed reads (same format and compression\n", OUTFILE);
   fprintf(stderr, "                     as input file containing reads [%s])\n", INFILE);
   fprintf(stderr, "Optional parameters:\n");
@@ -60,8 +85,54 @@ void usage(void) {
   fprintf(stderr, "  %s              Option to require second primer be found\n", REVOPT);
   fprintf(stderr, "  %s  <file>       Log file for counts of matches\n", LOGFILE);
   fprintf(stderr, "  %s  <file>       Output file for non-trimmed reads\n", WASTEFILE);
+  fprintf(stderr, "  %s              Option to write only the ordinals of non-trimmed reads\n", WASTEORD);
+  fprintf(stderr, "                     (\"%s<int>\" in headers, added by stitch -or) to %s,\n", ORDTAG, WASTEFILE);
+  fprintf(stderr, "                     for extraction from the original reads with stitch -x\n");
   fprintf(stderr, "  %s  <file>       Output file for trimmed reads with correct primers reattached\n", CORRFILE);
   fprintf(stderr, "                     (should only be used if specifying %s)\n", REVOPT);
+  fprintf(stderr, "  %s <int/int>    Process only the given shard of the input, e.g. 2/8 for\n", SHARDOPT);
+  fprintf(stderr, "                     the 2nd of 8 equal byte ranges of the file (must be\n");
+  fprintf(stderr, "                     plain or BGZF compressed; the outputs and logs of all\n");
+  fprintf(stderr, "                     shards can be merged with mergeShards.pl)\n");
+  fprintf(stderr, "  %s <int,int>    Process only reads beginning in the given byte range\n", SHARDBYTE);
+  fprintf(stderr, "                     of the input file (alternative to %s)\n", SHARDOPT);
+  fprintf(stderr, "  %s  <file>      Checkpoint file, written periodically during the run\n", CKPTFILE);
+  fprintf(stderr, "                     (removed when the run completes)\n");
+  fprintf(stderr, "  %s  <int>       Reads between checkpoints (def. %d)\n", CKPTINT, DEFCKPT);
+  fprintf(stderr, "  %s              Option to resume from the checkpoint file (%s), with\n", RESUME, CKPTFILE);
+  fprintf(stderr, "                     the same parameters as the interrupted run\n");
+  fprintf(stderr, "  %s  <int>       Seconds between progress reports (reads/sec, bytes/sec,\n", METINT);
+  fprintf(stderr, "                     and counts) printed to stderr (def. %d, if %s given)\n", DEFMETINT, METFILE);
+  fprintf(stderr, "  %s  <file>      Prometheus textfile to which progress metrics are\n", METFILE);
+  fprintf(stderr, "                     written with each report\n");
+  fprintf(stderr, "  %s  <file>      Option to collapse trimmed reads with identical sequences\n", CLFILE);
+  fprintf(stderr, "                     and primers into one record (\"%s<int>\" appended to\n", CLSIZE);
+  fprintf(stderr, "                     name, max. quality scores); reads of each record are\n");
+  fprintf(stderr, "                     listed in the given mapping file (cannot be used\n");
+  fprintf(stderr, "                     with %s)\n", CKPTFILE);
+  fprintf(stderr, "  %s              Option to label trimmed reads with a SAM tag only\n", XPOPT);
+  fprintf(stderr, "                     (\"<read> %s<amplicon>,fwd|rev,one|both\"; the rest\n", XPTAG);
+  fprintf(stderr, "                     of the header is dropped), which bowtie2 can copy to\n");
+  fprintf(stderr, "                     its alignments with --sam-append-comment\n");
+  fprintf(stderr, "  %s  <file>      Output file listing length variants: lengths of trimmed\n", LENFILE);
+  fprintf(stderr, "                     reads that differ from the expected length of the\n");
+  fprintf(stderr, "                     amplicon (from %s or %s) by at least %s bp, in at\n", BEDFILE, LENBED, LENDIST);
+  fprintf(stderr, "                     least %s of its reads (as findLengthVars.pl)\n", LENPCT);
+  fprintf(stderr, "  %s  <file>      Output file for trimmed reads of length variants, with\n", LENREADS);
+  fprintf(stderr, "                     the difference added to the header (as getLengthVars.pl)\n");
+  fprintf(stderr, "  %s  <file>      BED file for expected lengths of length variants only\n", LENBED);
+  fprintf(stderr, "                     (not used to search for the second primer, as %s)\n", BEDFILE);
+  fprintf(stderr, "  %s  <float>     Min. fraction of reads for a length variant (def. %.2f)\n", LENPCT, DEFLENPCT);
+  fprintf(stderr, "  %s  <int>       Min. length difference of a length variant (def. %d)\n", LENDIST, DEFLENDIST);
+  fprintf(stderr, "Service mode:\n");
+  fprintf(stderr, "  %s  <file>      Run as a service on the given Unix socket: load the\n", SVOPT);
+  fprintf(stderr, "                     primers (%s) and the amplicon lengths (%s) once, then\n", PRIMFILE, BEDFILE);
+  fprintf(stderr, "                     run each job submitted with %s (only %s, %s, and\n", SVCLIENT, PRIMFILE, BEDFILE);
+  fprintf(stderr, "                     %s are used; stopped by SIGTERM)\n", SVJOBS);
+  fprintf(stderr, "  %s  <int>       Max. jobs run at once by the service (def. %d)\n", SVJOBS, DEFSVJOBS);
+  fprintf(stderr, "  %s  <file>      Submit the command to the service on the given socket,\n", SVCLIENT);
+  fprintf(stderr, "                     instead of running it; the files of the panel (%s,\n", PRIMFILE);
+  fprintf(stderr, "                     %s, %s) must be those loaded by the service\n", BEDFILE, LENBED);
   exit(-1);
 }
 
@@ -82,6 +153,14 @@ int error(char* msg, int err) {
   else if (err == ERRBED) msg2 = MERRBED;
   else if (err == ERRBEDA) msg2 = MERRBEDA;
   else if (err == ERRINVAL) msg2 = MERRINVAL;
+  else if (err == ERRCLCK) msg2 = MERRCLCK;
+  else if (err == ERRORD) msg2 = MERRORD;
+  else if (err == ERRFLOAT) msg2 = MERRFLOAT;
+  else if (err == ERRLVBED) msg2 = MERRLVBED;
+  else if (err == ERRLVCK) msg2 = MERRLVCK;
+  else if (err == ERRLVCL) msg2 = MERRLVCL;
+  else if (err == ERRPANEL) msg2 = MERRPANEL;
+  else if (err == ERRLVTMP) msg2 = MERRLVTMP;
   else msg2 = DEFERR;
 
   fprintf(stderr, "Error! %s%s\n", msg, msg2);
@@ -94,17 +173,26 @@ int error(char* msg, int err) {
 void freeMemory(void) {
   Primer* temp;
   for (Primer* p = primo; p != NULL; ) {
-    free(p->name);
-    free(p->fwd);
-    free(p->rev);
-    free(p->frc);
-    free(p->rrc);
+    if (pnl.map == NULL) {
+      free(p->name);
+      free(p->fwd);
+      free(p->rev);
+      free(p->frc);
+      free(p->rrc);
+      free(p->fwdM);
+      free(p->revM);
+      free(p->frcM);
+      free(p->rrcM);
+    }
+    if (p->hist != NULL)
+      free(p->hist);
     temp = p;
     p = p->next;
     free(temp);
   }
   free(line);
   free(hline);
+  closePanel(&pnl);
 }
 
 /* void* memalloc()
@@ -128,6 +216,17 @@ int getInt(char* in) {
   return ans;
 }
 
+/* double getDouble(char*)
+ * Converts the given char* to a double.
+ */
+double getDouble(char* in) {
+  char* endptr;
+  double ans = strtod(in, &endptr);
+  if (*endptr != '\0')
+    exit(error(in, ERRFLOAT));
+  return ans;
+}
+
 /* char* getLine()
  * Reads the next line from a file.
  */
@@ -140,68 +239,54 @@ char* getLine(char* line, int size, File in, int gz) {
 
 /* int fastaOrQ ()
  * Determines, based on the first character, if
- *   a file is likely fasta or fastq.
+ *   a file is likely fasta or fastq. Comment lines
+ *   are skipped, and the character is put back (so
+ *   the input need not be rewound, and may be a pipe).
  */
 int fastaOrQ(File in, int gz) {
-  while (getLine(line, MAX_SIZE, in, gz) != NULL)
-    if (line[0] == '>')
-      return 0;
-    else if (line[0] == '@')
-      return 1;
-    else if (line[0] != '#')
+  int c;
+  while ((c = gz ? gzgetc(in.gzf) : getc(in.f)) == '#')
+    if (getLine(line, MAX_SIZE, in, gz) == NULL)
       break;
+  if (c == '>' || c == '@') {
+    gz ? gzungetc(c, in.gzf) : ungetc(c, in.f);
+    return c == '@';
+  }
   exit(error("", ERRUNK));
 }
 
-/* int ambig(char, char)
- * Checks ambiguous DNA bases.
- */
-int ambig(char x, char y) {
-  if (x == 'N' ||
-      (x == 'W' && (y == 'A' || y == 'T')) ||
-      (x == 'S' && (y == 'C' || y == 'G')) ||
-      (x == 'M' && (y == 'A' || y == 'C')) ||
-      (x == 'K' && (y == 'G' || y == 'T')) ||
-      (x == 'R' && (y == 'A' || y == 'G')) ||
-      (x == 'Y' && (y == 'C' || y == 'T')) ||
-      (x == 'B' && (y == 'C' || y == 'G' || y == 'T')) ||
-      (x == 'D' && (y == 'A' || y == 'G' || y == 'T')) ||
-      (x == 'H' && (y == 'A' || y == 'C' || y == 'T')) ||
-      (x == 'V' && (y == 'A' || y == 'C' || y == 'G')))
-    return 0;
-  return 1;
-}
-
 /* Primer* findPrim(char*)
  * Finds a primer match to the given sequence.
  */
 Primer* findPrim(char* seq, int misAllow, int fwdSt, int fwdEnd,
     int* st, int* f) {
+  int len = strlen(seq);
+  PROF_CALL(PR_FINDPRIM);
   for (Primer* p = primo; p != NULL; p = p->next) {
+    PROF_ITER(PR_FINDPRIM, 1);
     for (int i = 0; i < 2; i++) {
       char* prim = (i ? p->rrc : p->fwd);
+      char* mask = (i ? p->rrcM : p->fwdM);
+      int plen = (i ? p->rlen : p->flen);
       // allow primer to match starting at diff. positions
+      //   (bases before the read are skipped)
       for (int off = fwdSt; off < fwdEnd; off++) {
-        int mis = misAllow;
-        int j;
-        for (j = 0; prim[j] != '\0'; j++)
-          if (j + off < 0)
-            continue;
-          else if (seq[j+off] == '\0' ||
-              (prim[j] != seq[j+off] &&
-              (prim[j] == 'A' || prim[j] == 'C' ||
-              prim[j] == 'G' || prim[j] == 'T' ||
-              ambig(prim[j], seq[j+off])) && --mis < 0))
-            break;
-
-        if (prim[j] == '\0') {
-          if (seq[j+off] != '\0') {
-            *st = j+off;
-            *f = i;
-            return p;
-          } else
-            return NULL;
-        }
+        if (off + plen > len)
+          continue;
+        int j = (off < 0 ? -off : 0);
+        if (j > plen)
+          j = plen;
+        if (simd.primMis(prim + j, mask + j, seq + j + off, plen - j,
+            misAllow) > misAllow)
+          continue;
+
+        if (off + plen < len) {
+          *st = off + plen;
+          *f = i;
+          PROF_EXIT(PR_FINDPRIM);
+          return p;
+        } else
+          return NULL;
       }
     }
   }
@@ -212,23 +297,24 @@ Primer* findPrim(char* seq, int misAllow, int fwdSt, int fwdEnd,
  * Checks the seq for a match of the reverse primer
  *   based on the expected amplicon length.
  */
-int checkRevLen(char* seq, char* rev, int st,
+int checkRevLen(char* seq, char* rev, char* mask, int st,
     int bedSt, int bedEnd) {
   // check only the 3' fragment, do not allow mismatches
   // allow primer to match starting at diff. positions
   int len = strlen(seq);
+  int rlen = strlen(rev);
+  PROF_CALL(PR_REVLEN);
   for (int off = bedSt; off < bedEnd; off++) {
     if (st+off >= len)
       break;
-    int j;
-    for (j = 0; rev[j] != '\0' && seq[st+j+off] != '\0'; j++)
-      if (rev[j] != seq[st+j+off] &&
-          (rev[j] == 'A' || rev[j] == 'C' ||
-          rev[j] == 'G' || rev[j] == 'T' ||
-          ambig(rev[j], seq[st+j+off])))
-        break;
-    if (rev[j] == '\0' || seq[st+j+off] == '\0')
+    PROF_ITER(PR_REVLEN, 1);
+    int j = len - st - off;  // bases of the primer in the read
+    if (j > rlen)
+      j = rlen;
+    if (! simd.primMis(rev, mask, seq + st + off, j, 0)) {
+      PROF_EXIT(PR_REVLEN);
       return st+off;
+    }
   }
   return 0;
 }
@@ -237,20 +323,16 @@ int checkRevLen(char* seq, char* rev, int st,
  * Checks the seq for a match of the reverse primer
  *   internally.
  */
-int checkRevInt(char* seq, char* rev, int st,
+int checkRevInt(char* seq, char* rev, char* mask, int st,
     int misAllow, int len) {
   int last = strlen(seq) - len + 1;
+  PROF_CALL(PR_REVINT);
   for (int i = st; i < last; i++) {
-    int mis = misAllow;
-    int j;
-    for (j = 0; j < len; j++)
-      if (rev[j] != seq[i + j] &&
-          (rev[j] == 'A' || rev[j] == 'C' ||
-          rev[j] == 'G' || rev[j] == 'T' ||
-          ambig(rev[j], seq[i + j])) && --mis < 0)
-        break;
-    if (j == len)
+    PROF_ITER(PR_REVINT, 1);
+    if (simd.primMis(rev, mask, seq + i, len, misAllow) <= misAllow) {
+      PROF_EXIT(PR_REVINT);
       return i;
+    }
   }
   return 0;
 }
@@ -259,58 +341,141 @@ int checkRevInt(char* seq, char* rev, int st,
  * Checks the seq for a match of the reverse primer
  *   at the 3' end.
  */
-int checkRevEnd(char* seq, char* rev, int misAllow,
+int checkRevEnd(char* seq, char* rev, char* mask, int misAllow,
     int revSt, int revEnd) {
   int primEnd = strlen(rev) - 1;
   int seqEnd = strlen(seq) - 1;
+  PROF_CALL(PR_REVEND);
   // allow primer to match starting at diff. positions
+  //   (bases after the read are skipped)
   for (int off = revSt; off < revEnd; off++) {
-    int mis = misAllow;
-    int j;
-    for (j = 0; j < primEnd + 1; j++) {
-      int seqPos = seqEnd - j - off;
-      int pos = primEnd - j;
-      if (j + off < 0)
-        continue;
-      else if (seqPos < 0 ||
-          (rev[pos] != seq[seqPos] &&
-          (rev[pos] == 'A' || rev[pos] == 'C' ||
-          rev[pos] == 'G' || rev[pos] == 'T' ||
-          ambig(rev[pos], seq[seqPos])) && --mis < 0))
-        break;
-    }
-    if (j == primEnd + 1) {
-      return seqEnd - j - off + 1;  // last base of primer
-    }
+    PROF_ITER(PR_REVEND, 1);
+    int pos = seqEnd - primEnd - off;  // first base of primer
+    int j = primEnd + 1 + (off < 0 ? off : 0);  // bases compared
+    if (j > 0 && (pos < 0 || simd.primMis(rev, mask, seq + pos, j,
+        misAllow) > misAllow))
+      continue;
+    PROF_EXIT(PR_REVEND);
+    return pos;
   }
   return 0;
 }
 
+/* void makeLabel()
+ * Writes the label of a trimmed read: " <amplicon> fwd|rev
+ *   [both]", or " XP:Z:<amplicon>,fwd|rev,one|both".
+ */
+void makeLabel(char* lab, Primer* p, int f, int end, int xpOpt) {
+  if (xpOpt)
+    sprintf(lab, " %s%s,%s,%s", XPTAG, p->name, (f ? REV : FWD) + 1,
+      end ? BOTH + 1 : ONE);
+  else
+    sprintf(lab, " %s%s%s", p->name, f ? REV : FWD, end ? BOTH : "");
+}
+
+/* void printWaste()
+ * Prints the header and sequence of a non-trimmed read, or
+ *   only its ordinal (wasteOpt == 2).
+ */
+void printWaste(File waste, int wasteOpt, char* hline, char* line,
+    int gz) {
+  if (wasteOpt == 2) {
+    char* tag = strstr(hline, " " ORDTAG);
+    if (tag == NULL) {
+      hline[strcspn(hline, " \t\r\n")] = '\0';
+      exit(error(hline + 1, ERRORD));
+    }
+    tag += strlen(ORDTAG) + 1;
+    int n = strspn(tag, "0123456789");
+    gz ? gzprintf(waste.gzf, "%.*s\n", n, tag)
+      : fprintf(waste.f, "%.*s\n", n, tag);
+  } else
+    gz ? gzprintf(waste.gzf, "%s%s\n", hline, line)
+      : fprintf(waste.f, "%s%s\n", hline, line);
+}
+
+/* int countLen()
+ * Adds a trimmed read to the length histogram of its amplicon
+ *   (a collapsed read, "<read>;size=<N>", counts N times).
+ *   If it may be a length variant (and those reads are to be
+ *   written), it is saved to a temporary file (its quality
+ *   scores to follow), and 1 is returned.
+ */
+int countLen(LenVar* lv, Primer* p, char* hline, int hLen,
+    char* lab, char* seq, int len) {
+  if (!p->len)
+    return 0;
+  if (p->hist == NULL) {
+    p->hist = (int*) memalloc(MAX_SIZE * sizeof(int));
+    memset(p->hist, 0, MAX_SIZE * sizeof(int));
+  }
+  int n = 1;
+  char* size = strstr(hline, CLSIZE);
+  if (size != NULL && size < hline + strcspn(hline, " \t\r\n"))
+    n = atoi(size + strlen(CLSIZE));
+  p->hist[len] += n;
+  p->tot += n;
+  if (lv->readFile == NULL || abs(len - p->len) < lv->dist)
+    return 0;
+
+  if (lv->tmp == NULL && (lv->tmp = tmpfile()) == NULL)
+    exit(error("temporary file", ERROPENW));
+  fprintf(lv->tmp, "%s\t%d\t%.*s%s\n%.*s\n", p->name, len, hLen, hline,
+    lab, len, seq);
+  return 1;
+}
+
 /* int readFile()
  * Parses the input file. Produces the output file(s).
  */
 int readFile(File in, File out, int misAllow, int* match,
     int* rcmatch, int fwdSt, int fwdEnd, int revSt, int revEnd,
-    int bedSt, int bedEnd, File waste, int wasteOpt, int revMis,
+    int bedSt, int bedEnd, int bedOpt, File waste, int wasteOpt, int revMis,
     int revLen, int revLMis, int revOpt, File corr, int corrOpt,
-    int gz) {
-  // determine if input is fasta or fastq
-  int aorq = fastaOrQ(in, gz);
-  gz ? gzrewind(in.gzf) : rewind(in.f);
-
-  int count = 0;
-  while (getLine(hline, MAX_SIZE, in, gz) != NULL) {
+    int xpOpt, int aorq, int gz, Shard* sh, Ckpt* ck, Metrics* m,
+    Collapse* cl, LenVar* lv) {
+  int count = 0, wasted = 0;
+  int clOpt = cl->file != NULL;
+  int lvOpt = lv->file != NULL || lv->readFile != NULL;
+  char lab[MAX_SIZE];
+  char* chead = NULL, *cseq = NULL;
+  if (clOpt) {
+    chead = (char*) memalloc(2 * MAX_SIZE);
+    cseq = (char*) memalloc(MAX_SIZE);
+  }
+  ckptCount(ck, &count);
+  ckptCount(ck, match);
+  ckptCount(ck, rcmatch);
+  ckptCount(ck, &wasted);
+  for (Primer* p = primo; p != NULL; p = p->next) {
+    ckptCount(ck, &p->fcount);
+    ckptCount(ck, &p->fcountr);
+    ckptCount(ck, &p->rcount);
+    ckptCount(ck, &p->rcountr);
+  }
+  ckptRestore(ck);
+  metricsCount(m, "matched", match);
+  metricsCount(m, "both", rcmatch);
+  metricsCount(m, "wasted", &wasted);
+  startMetrics(m, count);
+  PROF_START(t);
+  while (inShard(in, gz, sh) &&
+      getLine(hline, MAX_SIZE, in, gz) != NULL) {
     if (hline[0] == '#')
       continue;
     count++;
+    PROF_CALL(PR_READ);
     if (getLine(line, MAX_SIZE, in, gz) == NULL)
       exit(error("", ERRSEQ));
     int len = strlen(line) - 1;
     if (line[len] == '\n')
       line[len] = '\0';
+    PROF_LAP(PR_READ, t);
 
     int st = 0, end = 0, f = 0;
+    int lr = 0;  // read saved as a length variant
     Primer* p = findPrim(line, misAllow, fwdSt, fwdEnd, &st, &f);
+    PROF_LAP(PR_FINDPRIM, t);
     if (p != NULL) {
       (*match)++;
       f ? p->rcount++ : p->fcount++;
@@ -318,19 +483,24 @@ int readFile(File in, File out, int misAllow, int* match,
       // search for reverse primer
       // first, check 3' end
       char* rev = (f ? p->frc : p->rev);
-      end = checkRevEnd(line, rev, revMis, revSt, revEnd);
+      char* mask = (f ? p->frcM : p->revM);
+      end = checkRevEnd(line, rev, mask, revMis, revSt, revEnd);
+      PROF_LAP(PR_REVEND, t);
 
       // check internal sequence
       if (!end && revLen) {
         int setLen = strlen(rev);
         if (setLen > revLen)
           setLen = revLen;
-        end = checkRevInt(line, rev, st, revLMis, setLen);
+        end = checkRevInt(line, rev, mask, st, revLMis, setLen);
+        PROF_LAP(PR_REVINT, t);
       }
 
       // check based on amplicon length
-      if (!end && p->len && st + p->len < strlen(line))
-        end = checkRevLen(line, rev, st + p->len, bedSt, bedEnd);
+      if (!end && bedOpt && p->len && st + p->len < strlen(line)) {
+        end = checkRevLen(line, rev, mask, st + p->len, bedSt, bedEnd);
+        PROF_LAP(PR_REVLEN, t);
+      }
 
       // evaluate outcome, produce output
       if (end <= st)
@@ -339,33 +509,38 @@ int readFile(File in, File out, int misAllow, int* match,
         f ? p->rcountr++ : p->fcountr++;
       if (revOpt && !end) {
         // rev primer not found (and was required [revOpt])
+        wasted++;
         if (wasteOpt)
-          gz ? gzprintf(waste.gzf, "%s%s\n", hline, line)
-            : fprintf(waste.f, "%s%s\n", hline, line);
+          printWaste(waste, wasteOpt, hline, line, gz);
       } else {
-        // print header
-        for (int i = 0; hline[i] != '\0' && hline[i] != '\n'; i++)
-          gz ? gzputc(out.gzf, hline[i]) : putc(hline[i], out.f);
-        gz ? gzprintf(out.gzf, " %s%s%s\n", p->name,
-          f ? REV : FWD, end ? BOTH : "")
-          : fprintf(out.f, " %s%s%s\n", p->name,
-          f ? REV : FWD, end ? BOTH : "");
-        if (corrOpt) {
-          for (int i = 0; hline[i] != '\0' && hline[i] != '\n'; i++)
-            gz ? gzputc(corr.gzf, hline[i]) : putc(hline[i], corr.f);
-          gz ? gzprintf(corr.gzf, " %s%s%s\n", p->name,
-            f ? REV : FWD, end ? BOTH : "")
-            : fprintf(corr.f, " %s%s%s\n", p->name,
-            f ? REV : FWD, end ? BOTH : "");
-        }
+        // print header (or save it, if collapsing) -- with
+        //   a SAM tag, only the read name is kept
+        int hLen = strcspn(hline, xpOpt ? " \t\r\n" : "\r\n");
+        makeLabel(lab, p, f, end, xpOpt);
+        if (clOpt)
+          sprintf(chead, "%.*s%s", hLen, hline, lab);
+        else
+          gz ? gzprintf(out.gzf, "%.*s%s\n", hLen, hline, lab)
+            : fprintf(out.f, "%.*s%s\n", hLen, hline, lab);
+        if (corrOpt)
+          gz ? gzprintf(corr.gzf, "%.*s%s\n", hLen, hline, lab)
+            : fprintf(corr.f, "%.*s%s\n", hLen, hline, lab);
         // print sequence
         if (!end)
           end = len;
         else
           (*rcmatch)++;
-        for (int i = st; i < end; i++)
-          gz ? gzputc(out.gzf, line[i]) : putc(line[i], out.f);
-        gz ? gzputc(out.gzf, '\n') : putc('\n', out.f);
+        if (lvOpt)
+          lr = countLen(lv, p, hline, hLen, lab, line + st, end - st);
+        if (clOpt) {
+          memcpy(cseq, line + st, end - st);
+          if (!aorq)
+            collapseRead(cl, chead, cseq, end - st, NULL);
+        } else {
+          for (int i = st; i < end; i++)
+            gz ? gzputc(out.gzf, line[i]) : putc(line[i], out.f);
+          gz ? gzputc(out.gzf, '\n') : putc('\n', out.f);
+        }
         // reattach primers
         if (corrOpt) {
           gz ? gzprintf(corr.gzf, "%s", f ? p->rrc : p->fwd)
@@ -376,9 +551,11 @@ int readFile(File in, File out, int misAllow, int* match,
             : fprintf(corr.f, "%s\n", f ? p->frc : p->rev);
         }
       }
-    } else if (wasteOpt)
-      gz ? gzprintf(waste.gzf, "%s%s\n", hline, line)
-        : fprintf(waste.f, "%s%s\n", hline, line);
+    } else {
+      wasted++;
+      if (wasteOpt)
+        printWaste(waste, wasteOpt, hline, line, gz);
+    }
 
     // read next 2 lines if fastq
     if (aorq) {
@@ -387,13 +564,19 @@ int readFile(File in, File out, int misAllow, int* match,
           exit(error("", ERRSEQ));
         else if (p != NULL) {
           if (revOpt && !end) {
-            if (wasteOpt)
+            if (wasteOpt == 1)
               gz ? gzprintf(waste.gzf, "%s", line)
                 : fprintf(waste.f, "%s", line);
           } else if (i) {
-            for (int j = st; j < end; j++)
-              gz ? gzputc(out.gzf, line[j]) : putc(line[j], out.f);
-            gz ? gzputc(out.gzf, '\n') : putc('\n', out.f);
+            if (lr)
+              fprintf(lv->tmp, "%.*s\n", end - st, line + st);
+            if (clOpt)
+              collapseRead(cl, chead, cseq, end - st, line + st);
+            else {
+              for (int j = st; j < end; j++)
+                gz ? gzputc(out.gzf, line[j]) : putc(line[j], out.f);
+              gz ? gzputc(out.gzf, '\n') : putc('\n', out.f);
+            }
             if (corrOpt) {
               for (int j = 0; j < strlen(f ? p->rrc : p->fwd); j++)
                 gz ? gzputc(corr.gzf, 'I') : putc('I', corr.f);
@@ -404,18 +587,33 @@ int readFile(File in, File out, int misAllow, int* match,
               gz ? gzputc(corr.gzf, '\n') : putc('\n', corr.f);
             }
           } else {
-            gz ? gzprintf(out.gzf, "%s", line)
-              : fprintf(out.f, "%s", line);
+            if (!clOpt)
+              gz ? gzprintf(out.gzf, "%s", line)
+                : fprintf(out.f, "%s", line);
             if (corrOpt)
               gz ? gzprintf(corr.gzf, "%s", line)
                 : fprintf(corr.f, "%s", line);
           }
-        } else if (wasteOpt)
+        } else if (wasteOpt == 1)
           gz ? gzprintf(waste.gzf, "%s", line)
             : fprintf(waste.f, "%s", line);
 
     }
+
+    if (ck->file != NULL && count >= ck->next)
+      saveCkpt(ck);
+    if (m->on && --m->check <= 0)
+      updateMetrics(m, count, 0);
+    PROF_CALL(PR_OUTPUT);
+    PROF_LAP(PR_OUTPUT, t);
   }
+  if (clOpt) {
+    writeCollapse(cl, out, gz, aorq);
+    free(chead);
+    free(cseq);
+  }
+  if (m->on)
+    updateMetrics(m, count, 1);
   return count;
 }
 
@@ -467,6 +665,125 @@ void openGZWrite(char* outFile, File* out, int gz) {
     out->f = openWrite(outFile);
 }
 
+/* int isLenVar()
+ * Determines if a length of an amplicon's reads is a
+ *   length variant.
+ */
+int isLenVar(LenVar* lv, Primer* p, int len) {
+  return abs(len - p->len) >= lv->dist &&
+    (double) p->hist[len] / p->tot >= lv->pct;
+}
+
+/* int cmpLen()
+ * Compares lengths as strings (for the order of
+ *   findLengthVars.pl's output).
+ */
+int cmpLen(const void* a, const void* b) {
+  char x[16], y[16];
+  sprintf(x, "%d", *(int*) a);
+  sprintf(y, "%d", *(int*) b);
+  return strcmp(x, y);
+}
+
+/* int cmpPrim()
+ * Compares primers by name.
+ */
+int cmpPrim(const void* a, const void* b) {
+  return strcmp((*(Primer**) a)->name, (*(Primer**) b)->name);
+}
+
+/* void writeLengths()
+ * Writes the table of length variants, and the saved reads
+ *   (candidates) that are of length variants.
+ */
+void writeLengths(LenVar* lv, int gz, int aorq) {
+  if (lv->file != NULL) {
+    FILE* out = openWrite(lv->file);
+    fprintf(out, "%s\n", LENHEAD);
+
+    // sort amplicons by name
+    int n = 0;
+    for (Primer* p = primo; p != NULL; p = p->next)
+      if (p->hist != NULL)
+        n++;
+    Primer** arr = (Primer**) memalloc((n ? n : 1) * sizeof(Primer*));
+    n = 0;
+    for (Primer* p = primo; p != NULL; p = p->next)
+      if (p->hist != NULL)
+        arr[n++] = p;
+    qsort(arr, n, sizeof(Primer*), cmpPrim);
+
+    int* lens = (int*) memalloc(MAX_SIZE * sizeof(int));
+    for (int i = 0; i < n; i++) {
+      int m = 0;
+      for (int j = 0; j < MAX_SIZE; j++)
+        if (arr[i]->hist[j] && isLenVar(lv, arr[i], j))
+          lens[m++] = j;
+      qsort(lens, m, sizeof(int), cmpLen);
+      for (int j = 0; j < m; j++)
+        fprintf(out, "%s\t%d\t%d\t%.1f\n", arr[i]->name, arr[i]->len,
+          lens[j], 100.0 * arr[i]->hist[lens[j]] / arr[i]->tot);
+    }
+    free(lens);
+    free(arr);
+    if (fclose(out))
+      exit(error("", ERRCLOSE));
+  }
+
+  if (lv->readFile != NULL) {
+    File out;
+    openGZWrite(lv->readFile, &out, gz);
+    if (lv->tmp != NULL) {
+      // amplicons by name, to look up those of the candidates
+      int n = 0;
+      for (Primer* p = primo; p != NULL; p = p->next)
+        n++;
+      Primer** arr = (Primer**) memalloc(n * sizeof(Primer*));
+      n = 0;
+      for (Primer* p = primo; p != NULL; p = p->next)
+        arr[n++] = p;
+      qsort(arr, n, sizeof(Primer*), cmpPrim);
+
+      char* head = (char*) memalloc(3 * MAX_SIZE);
+      char* seq = (char*) memalloc(MAX_SIZE);
+      char* qual = (char*) memalloc(MAX_SIZE);
+      rewind(lv->tmp);
+      while (fgets(head, 3 * MAX_SIZE, lv->tmp) != NULL) {
+        if (fgets(seq, MAX_SIZE, lv->tmp) == NULL ||
+            (aorq && fgets(qual, MAX_SIZE, lv->tmp) == NULL))
+          exit(error("temporary file", ERRLVTMP));
+        char* name = strtok(head, "\t");
+        int len = atoi(strtok(NULL, "\t"));
+        char* rest = strtok(NULL, "\n");
+        Primer key, * k = &key;
+        key.name = name;
+        Primer** p = (Primer**) bsearch(&k, arr, n, sizeof(Primer*),
+          cmpPrim);
+        if (p == NULL || rest == NULL)
+          exit(error("temporary file", ERRLVTMP));
+        if (!isLenVar(lv, *p, len))
+          continue;
+        int diff = len - (*p)->len;
+        gz ? gzprintf(out.gzf, "%s %d%c\n%s", rest, abs(diff),
+            diff < 0 ? 'D' : 'I', seq)
+          : fprintf(out.f, "%s %d%c\n%s", rest, abs(diff),
+            diff < 0 ? 'D' : 'I', seq);
+        if (aorq)
+          gz ? gzprintf(out.gzf, "+\n%s", qual)
+            : fprintf(out.f, "+\n%s", qual);
+      }
+      free(head);
+      free(seq);
+      free(qual);
+      free(arr);
+      fclose(lv->tmp);  // (deletes the file)
+      lv->tmp = NULL;
+    }
+    if ( (gz && gzclose(out.gzf) != Z_OK) || (! gz && fclose(out.f)) )
+      exit(error("", ERRCLOSE));
+  }
+}
+
 /* FILE* openRead()
  * Opens a file for reading.
  */
@@ -484,18 +801,22 @@ void openFiles(char* outFile, File* out,
     char* primFile, FILE** prim, char* inFile, File* in,
     char* logFile, FILE** log, char* bedFile, FILE** bed,
     char* wasteFile, File* waste,
-    char* corrFile, File* corr, int gz) {
+    char* corrFile, File* corr, int gz, Ckpt* ck) {
   // open required files
-  *prim = openRead(primFile);
+  // (outputs reopened at checkpoint positions if resuming)
+  if (primFile != NULL)
+    *prim = openRead(primFile);
   if (gz) {
     // gzip compressed files
     in->gzf = gzopen(inFile, "r");
     if (in->gzf == NULL)
       exit(error(inFile, ERROPEN));
-    openGZWrite(outFile, out, gz);
+    if (! ckptWrite(ck, outFile, out, gz))
+      openGZWrite(outFile, out, gz);
   } else {
     in->f = openRead(inFile);
-    out->f = openWrite(outFile);
+    if (! ckptWrite(ck, outFile, out, gz))
+      out->f = openWrite(outFile);
   }
 
   // open optional files
@@ -503,48 +824,21 @@ void openFiles(char* outFile, File* out,
     *bed = openRead(bedFile);
   if (logFile != NULL)
     *log = openWrite(logFile);
-  if (wasteFile != NULL)
+  if (wasteFile != NULL && ! ckptWrite(ck, wasteFile, waste, gz))
     openGZWrite(wasteFile, waste, gz);
-  if (corrFile != NULL)
+  if (corrFile != NULL && ! ckptWrite(ck, corrFile, corr, gz))
     openGZWrite(corrFile, corr, gz);
 }
 
-/* char rc(char)
- * Returns the complement of the given base.
- */
-char rc(char in) {
-  char out;
-  if (in == 'A') out = 'T';
-  else if (in == 'T') out = 'A';
-  else if (in == 'C') out = 'G';
-  else if (in == 'G') out = 'C';
-  else if (in == 'Y') out = 'R';
-  else if (in == 'R') out = 'Y';
-  else if (in == 'W') out = 'W';
-  else if (in == 'S') out = 'S';
-  else if (in == 'K') out = 'M';
-  else if (in == 'M') out = 'K';
-  else if (in == 'B') out = 'V';
-  else if (in == 'V') out = 'B';
-  else if (in == 'D') out = 'H';
-  else if (in == 'H') out = 'D';
-  else if (in == 'N') out = 'N';
-  else exit(error("", ERRPRIM));
-  return out;
-}
-
 /* char* revComp(char*)
  * Reverse-complements the given sequence.
  */
 char* revComp(char* seq) {
-  int i = strlen(seq) - 1;
-  char* out = (char*) memalloc(2 + i);
-  int j;
-  for (j = 0; i > -1; j++) {
-    char nuc = seq[i--];
-    out[j] = rc(nuc);
-  }
-  out[j] = '\0';
+  int len = strlen(seq);
+  char* out = (char*) memalloc(len + 1);
+  if (simd.revComp(out, seq, len, 1))
+    exit(error("", ERRPRIM));
+  out[len] = '\0';
   return out;
 }
 
@@ -583,11 +877,19 @@ int loadSeqs(FILE* prim) {
     strcpy(p->fwd, seq);
     strcpy(p->rev, rev);
 
-    // save sequence rc's
+    // save sequence rc's, masks
     p->frc = revComp(p->fwd);
     p->rrc = revComp(p->rev);
+    p->fwdM = iupacMask(p->fwd);
+    p->revM = iupacMask(p->rev);
+    p->frcM = iupacMask(p->frc);
+    p->rrcM = iupacMask(p->rrc);
+    p->flen = strlen(p->fwd);
+    p->rlen = strlen(p->rev);
 
     p->fcount = p->rcount = p->fcountr = p->rcountr = 0;
+    p->hist = NULL;
+    p->tot = 0;
     p->next = NULL;
     if (primo == NULL)
       primo = p;
@@ -645,6 +947,60 @@ void getLengths(FILE* bed) {
   }
 }
 
+/* int loadPanel()
+ * Loads the primers from a panel bundle (buildPanel),
+ *   pointing into the mapped file, and the expected
+ *   lengths of the amplicons if a BED file (its source)
+ *   is given.
+ */
+int loadPanel(char* file, char* bedFile) {
+  openPanel(file, &pnl);
+  if (bedFile != NULL)
+    checkPanelSrc(&pnl, PNLBED, bedFile);
+  Primer* prev = NULL;
+  for (uint32_t i = 0; i < pnl.head->nAmp; i++) {
+    PnlAmp* a = pnl.amp + i;
+    Primer* p = (Primer*) memalloc(sizeof(Primer));
+    p->name = pnl.str + a->name;
+    p->fwd = pnl.str + a->fwd;
+    p->rev = pnl.str + a->rev;
+    p->frc = pnl.str + a->frc;
+    p->rrc = pnl.str + a->rrc;
+    p->fwdM = pnl.str + a->mask[0];
+    p->revM = pnl.str + a->mask[1];
+    p->frcM = pnl.str + a->mask[2];
+    p->rrcM = pnl.str + a->mask[3];
+    p->flen = strlen(p->fwd);
+    p->rlen = strlen(p->rev);
+    p->fcount = p->rcount = p->fcountr = p->rcountr = 0;
+    p->hist = NULL;
+    p->tot = 0;
+    p->next = NULL;
+    if (primo == NULL)
+      primo = p;
+    else
+      prev->next = p;
+    prev = p;
+
+    // save length (as getLengths)
+    p->len = 0;
+    p->fpos = -1;
+    if (bedFile == NULL || ! a->nBed)
+      continue;
+    p->fpos = a->st[0];
+    p->rpos = a->end[0];
+    if (a->nBed == 2) {
+      p->len = (p->fpos < a->st[1] ? a->st[1] - p->rpos :
+        p->fpos - a->end[1]);
+      if (p->len < 0) {
+        error(p->name, ERRBEDA);
+        p->len = 0;
+      }
+    }
+  }
+  return pnl.head->nAmp;
+}
+
 /* void getParams()
  * Parses the command line.
  */
@@ -653,9 +1009,22 @@ void getParams(int argc, char** argv) {
   char* outFile = NULL, *inFile = NULL, *primFile = NULL,
     *bedFile = NULL, *fwdPos = NULL, *revPos = NULL,
     *bedPos = NULL, *logFile = NULL, *wasteFile = NULL,
-    *corrFile = NULL;
+    *corrFile = NULL, *lenBed = NULL;
   int misAllow = 0, revLen = 0, revMis = 0, revLMis = 0,
-    revOpt = 0;
+    revOpt = 0, xpOpt = 0, wasteOrd = 0;
+  Shard sh;
+  initShard(&sh);
+  Ckpt ck;
+  initCkpt(&ck);
+  Metrics m;
+  initMetrics(&m, "removePrimer");
+  Collapse cl;
+  initCollapse(&cl);
+  LenVar lv;
+  lv.file = lv.readFile = NULL;
+  lv.pct = DEFLENPCT;
+  lv.dist = DEFLENDIST;
+  lv.tmp = NULL;
 
   // parse argv
   for (int i = 1; i < argc; i++) {
@@ -663,6 +1032,12 @@ void getParams(int argc, char** argv) {
       usage();
     else if (!strcmp(argv[i], REVOPT))
       revOpt = 1;
+    else if (!strcmp(argv[i], XPOPT))
+      xpOpt = 1;
+    else if (!strcmp(argv[i], WASTEORD))
+      wasteOrd = 1;
+    else if (!strcmp(argv[i], RESUME))
+      ck.resume = 1;
     else if (i < argc - 1) {
       if (!strcmp(argv[i], OUTFILE))
         outFile = argv[++i];
@@ -692,6 +1067,31 @@ void getParams(int argc, char** argv) {
         revLMis = getInt(argv[++i]);
       else if (!strcmp(argv[i], CORRFILE))
         corrFile = argv[++i];
+      else if (!strcmp(argv[i], SHARDOPT))
+        parseShard(argv[++i], &sh);
+      else if (!strcmp(argv[i], SHARDBYTE))
+        parseShardBytes(argv[++i], &sh);
+      else if (!strcmp(argv[i], CKPTFILE))
+        ck.file = argv[++i];
+      else if (!strcmp(argv[i], CKPTINT))
+        setCkptInt(&ck, argv[++i]);
+      else if (!strcmp(argv[i], METINT))
+        setMetInt(&m, argv[++i]);
+      else if (!strcmp(argv[i], METFILE)) {
+        m.file = argv[++i];
+        m.on = 1;
+      } else if (!strcmp(argv[i], CLFILE))
+        cl.file = argv[++i];
+      else if (!strcmp(argv[i], LENFILE))
+        lv.file = argv[++i];
+      else if (!strcmp(argv[i], LENREADS))
+        lv.readFile = argv[++i];
+      else if (!strcmp(argv[i], LENBED))
+        lenBed = argv[++i];
+      else if (!strcmp(argv[i], LENPCT))
+        lv.pct = getDouble(argv[++i]);
+      else if (!strcmp(argv[i], LENDIST))
+        lv.dist = getInt(argv[++i]);
       else
         exit(error(argv[i], ERRINVAL));
     } else
@@ -700,34 +1100,91 @@ void getParams(int argc, char** argv) {
 
   if (outFile == NULL || inFile == NULL || primFile == NULL)
     usage();
+  if (cl.file != NULL && ck.file != NULL)
+    exit(error("", ERRCLCK));
+  int lvOpt = lv.file != NULL || lv.readFile != NULL;
+  if (lvOpt) {
+    if (bedFile == NULL && lenBed == NULL)
+      exit(error("", ERRLVBED));
+    if (ck.file != NULL)
+      exit(error("", ERRLVCK));
+    if (lv.readFile != NULL && cl.file != NULL)
+      exit(error("", ERRLVCL));
+  }
   int gz = 0;
   if (!strcmp(inFile + strlen(inFile) - strlen(GZEXT), GZEXT))
     gz = 1;
 
+  // job of a service: the panel is loaded already
+  int bedOpt = bedFile != NULL;
+  if (svPrim != NULL) {
+    if (! sameFile(primFile, svPrim))
+      exit(error(primFile, ERRPANEL));
+    if (bedFile != NULL && (svBed == NULL || ! sameFile(bedFile, svBed)))
+      exit(error(bedFile, ERRPANEL));
+    if (lenBed != NULL && (svBed == NULL || ! sameFile(lenBed, svBed)))
+      exit(error(lenBed, ERRPANEL));
+    primFile = bedFile = lenBed = NULL;
+  }
+
+  // panel bundle: primers (and lengths) loaded from it
+  int pr = svPairs;
+  if (primFile != NULL && isPanel(primFile)) {
+    pr = loadPanel(primFile, bedOpt ? bedFile : (lvOpt ? lenBed : NULL));
+    primFile = bedFile = lenBed = NULL;
+  }
+
   // open files, load primer sequences
   File out, in, waste, corr;
   FILE* prim = NULL, *log = NULL, *bed = NULL;
+  PROF_INIT();
+  loadCkpt(&ck);
   openFiles(outFile, &out, primFile, &prim, inFile, &in,
     logFile, &log, bedFile, &bed, wasteFile, &waste,
-    corrFile, &corr, gz);
-  int pr = loadSeqs(prim);
+    corrFile, &corr, gz, &ck);
+  if (prim != NULL)
+    pr = loadSeqs(prim);
+
+  // determine if input is fasta or fastq
+  int aorq = fastaOrQ(in, gz);
+  if (isShard(&sh)) {
+    if ( (gz && gzclose(in.gzf) != Z_OK) || (! gz && fclose(in.f)) )
+      exit(error("", ERRCLOSE));
+    openShard(inFile, &in, gz, aorq, &sh);
+  }
+  ckptRead(&ck, inFile, &in, gz, sh.st, &sh);
+  metricsIn(&m, &in, gz);
+  metricsOut(&m, &out, gz);
+  if (wasteFile != NULL)
+    metricsOut(&m, &waste, gz);
+  if (corrFile != NULL)
+    metricsOut(&m, &corr, gz);
 
   // get start and end locations
   int fwdSt = 0, fwdEnd = 1, revSt = 0, revEnd = 1,
     bedSt = 0, bedEnd = 1;
   getPos(fwdPos, &fwdSt, &fwdEnd);
   getPos(revPos, &revSt, &revEnd);
-  if (bed != NULL) {
-    getLengths(bed);
+  if (bedOpt) {
+    if (bed != NULL)
+      getLengths(bed);
     getPos(bedPos, &bedSt, &bedEnd);
+  } else if (lvOpt && lenBed != NULL) {
+    FILE* lbed = openRead(lenBed);
+    getLengths(lbed);
+    if (fclose(lbed))
+      exit(error("", ERRCLOSE));
   }
 
   // read file
   int match = 0, rcmatch = 0;  // counting variables
   int count = readFile(in, out, misAllow, &match, &rcmatch,
-    fwdSt, fwdEnd, revSt, revEnd, bedSt, bedEnd,
-    waste, wasteFile != NULL, revMis, revLen, revLMis,
-    revOpt, corr, corrFile != NULL, gz);
+    fwdSt, fwdEnd, revSt, revEnd, bedSt, bedEnd, bedOpt,
+    waste, wasteFile == NULL ? 0 : wasteOrd + 1, revMis, revLen, revLMis,
+    revOpt, corr, corrFile != NULL, xpOpt, aorq, gz, &sh, &ck, &m, &cl,
+    &lv);
+  if (lvOpt)
+    writeLengths(&lv, gz, aorq);
 
   // print log output
   if (log != NULL) {
@@ -746,9 +1203,61 @@ void getParams(int argc, char** argv) {
       ( ! gz && (fclose(in.f) || fclose(out.f) ||
       (wasteFile != NULL && fclose(waste.f)) ||
       (corrFile != NULL && fclose(corr.f)) ) ) ||
-      fclose(prim) || (log != NULL && fclose(log)) ||
+      (prim != NULL && fclose(prim)) || (log != NULL && fclose(log)) ||
       (bed != NULL && fclose(bed)) )
     exit(error("", ERRCLOSE));
+  endCkpt(&ck);
+  PROF_REPORT("removePrimer");
+}
+
+/* void startService()
+ * Loads the panel (primers, and amplicon lengths from the
+ *   BED file), then serves jobs on the socket. Returns in
+ *   the process of each job, with its command line.
+ */
+void startService(int* argc, char*** argv) {
+  Service sv;
+  initService(&sv);
+  char* primFile = NULL, *bedFile = NULL;
+  for (int i = 1; i < *argc; i++) {
+    char* arg = (*argv)[i];
+    if (!strcmp(arg, HELP))
+      usage();
+    else if (i < *argc - 1) {
+      if (!strcmp(arg, SVOPT))
+        sv.path = (*argv)[++i];
+      else if (!strcmp(arg, SVJOBS))
+        setSvJobs(&sv, (*argv)[++i]);
+      else if (!strcmp(arg, PRIMFILE))
+        primFile = (*argv)[++i];
+      else if (!strcmp(arg, BEDFILE))
+        bedFile = (*argv)[++i];
+      else
+        exit(error(arg, ERRINVAL));
+    } else
+      exit(error(arg, ERRINVAL));
+  }
+  if (primFile == NULL)
+    usage();
+
+  if (isPanel(primFile))
+    svPairs = loadPanel(primFile, bedFile);
+  else {
+    FILE* prim = openRead(primFile);
+    svPairs = loadSeqs(prim);
+    if (fclose(prim))
+      exit(error("", ERRCLOSE));
+    if (bedFile != NULL) {
+      FILE* bed = openRead(bedFile);
+      getLengths(bed);
+      if (fclose(bed))
+        exit(error("", ERRCLOSE));
+    }
+  }
+  svPrim = absPath(primFile);
+  if (bedFile != NULL)
+    svBed = absPath(bedFile);
+  serveJobs(&sv, argc, argv);
 }
 
 /* int main()
@@ -758,7 +1267,19 @@ int main(int argc, char* argv[]) {
   line = (char*) memalloc(MAX_SIZE);
   hline = (char*) memalloc(MAX_SIZE);
   primo = NULL;
+  svPrim = svBed = NULL;
+  initSimd();
+
+  // submit to a service, or run as one
+  char* sock = findOpt(argc, argv, SVCLIENT);
+  if (sock != NULL)
+    return submitJob(sock, argc, argv);
+  if (findOpt(argc, argv, SVOPT) != NULL)
+    startService(&argc, &argv);
+
   getParams(argc, argv);
+  if (svPrim != NULL)
+    endJob();
   freeMemory();
   return 0;
 }
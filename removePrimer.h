@@ -15,6 +15,17 @@
 #define FWD         " fwd"  // read matched a fwd primer
 #define REV         " rev"  // read matched a rev primer
 #define BOTH        " both" // read matched primers on both ends
+#define ONE         "one"   // read matched one primer (SAM tag only)
+#define XPTAG       "XP:Z:" // label as SAM tag (e.g. "XP:Z:amp1,fwd,both")
+#define ORDTAG      "OR:i:" // read ordinal (added by stitch -or)
+
+// kernels/stages profiled with "make PROFILE=1"
+#define PR_READ     0
+#define PR_FINDPRIM 1
+#define PR_REVEND   2
+#define PR_REVINT   3
+#define PR_REVLEN   4
+#define PR_OUTPUT   5
 
 // command-line options and parameters
 #define HELP        "-h"
@@ -32,7 +43,19 @@
 #define REVOPT      "-rq"
 #define LOGFILE     "-l"
 #define WASTEFILE   "-w"
+#define WASTEORD    "-wo"   // option to write ordinals of non-trimmed reads
 #define CORRFILE    "-c"
+#define XPOPT       "-xp"   // option to write label as a SAM tag
+#define LENFILE     "-lv"   // table of length variants
+#define LENREADS    "-lr"   // reads of length variants
+#define LENBED      "-lb"   // BED file for expected lengths only
+#define LENPCT      "-lp"
+#define LENDIST     "-ld"
+
+// default parameter values (length variants, as findLengthVars.pl)
+#define DEFLENPCT   0.01
+#define DEFLENDIST  5
+#define LENHEAD     "#Amplicon\tExpected\tVarLength\tPercent"
 
 // error messages
 #define ERROPEN     0
@@ -59,6 +82,22 @@
 #define MERRBEDA    ": error determining length from BED file"
 #define ERRINVAL    11
 #define MERRINVAL   ": invalid parameter or usage"
+#define ERRCLCK     12
+#define MERRCLCK    "cannot collapse reads when writing checkpoints"
+#define ERRORD      13
+#define MERRORD     ": read has no ordinal (stitch -or)"
+#define ERRFLOAT    14
+#define MERRFLOAT   ": cannot convert to float"
+#define ERRLVBED    15
+#define MERRLVBED   "length variants need a BED file (-b or -lb)"
+#define ERRLVCK     16
+#define MERRLVCK    "cannot find length variants when writing checkpoints"
+#define ERRLVCL     17
+#define MERRLVCL    "cannot write length-variant reads when collapsing"
+#define ERRPANEL    18
+#define MERRPANEL   ": not the file of the panel loaded by the service"
+#define ERRLVTMP    19
+#define MERRLVTMP   ": improperly formatted reads of length variants"
 #define DEFERR      "Unknown error"
 
 typedef struct primer {
@@ -67,6 +106,12 @@ typedef struct primer {
   char* rev;
   char* frc;
   char* rrc;
+  char* fwdM;  // IUPAC masks of fwd, rev, frc, rrc (simd.c)
+  char* revM;
+  char* frcM;
+  char* rrcM;
+  int flen;    // lengths of fwd and rev
+  int rlen;
   int len;  // expected amplicon length
   int fpos;
   int rpos;
@@ -74,10 +119,16 @@ typedef struct primer {
   int rcount;
   int fcountr;
   int rcountr;
+  int* hist;  // counts of trimmed reads by length
+  int tot;
   struct primer* next;
 } Primer;
 
-typedef union file {
-  FILE* f;
-  gzFile gzf;
-} File;
+typedef struct lenvar {
+  char* file;      // table of length variants
+  char* readFile;  // reads of length variants
+  double pct;      // min. fraction of an amplicon's reads
+  int dist;        // min. difference from expected length
+  FILE* tmp;       // candidate reads (in input order), as
+                   //   "<primer>\t<len>\t<header>", seq, [qual]
+} LenVar;
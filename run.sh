@@ -8,9 +8,9 @@
 
 # External software requirements:
 #   - bowtie2 (2.2.3)   -- assumed to be in $PATH
-#   - samtools (0.1.19) -- assumed to be in $PATH
-#   - VarScan (2.3.7)   -- set location here:
-VARSCAN="./VarScan.v2.3.7.jar"
+#   - samtools (0.1.19) -- assumed to be in $PATH (not if nativePileup=1)
+#   - VarScan (2.3.7)   -- set location here (or in $VARSCAN):
+VARSCAN=${VARSCAN:-"./VarScan.v2.3.7.jar"}
 if [ ! -f $VARSCAN ]; then
   echo "VarScan jar file not found"
   exit -1
@@ -29,6 +29,9 @@ bed=$3            # BED file listing locations of primers
 gen=$4            # reference genome (FASTA)
 idx=$5            # bowtie2 index prefix (indexes will be generated if necessary)
 dir=$6            # output directory
+sample=${sample:-$dir}  # sample name in the VCF (def. <DIR>)
+rpService=${rpService:-""}  # socket of a removePrimer service (-sv) with
+                            #   the panel loaded (e.g. by runBatch.sh)
 
 # check input files
 if [[ ! -f $file1 || ! -f $file2 ]]; then
@@ -52,148 +55,305 @@ fi
 # set home directory
 HOME_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
 
+# steps run as a graph of dependencies (pipeline.sh): the joined
+#   and unjoined reads are processed concurrently, and a step that
+#   reads another's output as it is written is connected by a FIFO
+. ${HOME_DIR}/pipeline.sh
+pipeline=1  # set to 0 to run the steps one at a time, with regular files
+proc=${proc:-$(nproc 2> /dev/null || echo 1)}  # number of processors (CPU budget)
+
 # retrieve primer-target sequences
 prim=primers.txt
+primCmd=":"
 if [ ! -f $prim ]; then
-  perl ${HOME_DIR}/getPrimers.pl $bed $gen $prim
+  primCmd="perl ${HOME_DIR}/getPrimers.pl $bed $gen $prim"
 fi
+step primers "" 1 "$primCmd"
+
+# compile the panel into a bundle, memory-mapped by removePrimer,
+#   alignAmp, and ampPileup (rebuilt only if a source has changed)
+pnl=panel.pnl
+step panel "primers" 1 "${HOME_DIR}/buildPanel -p $prim -b $bed -g $gen -o $pnl -u"
 
 # stitch together reads
-echo "Stitching reads"
 tr1=join.fastq$gz
 tr2=un1.fastq$gz
 tr3=un2.fastq$gz
 stParam="-m 20 -p 0.1 -d"  # min overlap 20, 10% allowed mismatches, dovetailing
-${HOME_DIR}/stitch -1 $file1 -2 $file2 -o $tr1 -u1 $tr2 -u2 $tr3 $stParam
+ordinals=1  # label stitched reads with their ordinals, so the reads whose
+            #   primers aren't found can be retrieved in one pass (stitch -x)
+if [ $ordinals -eq 1 ]; then
+  stParam="$stParam -or"
+fi
+fifo $tr1
+step stitch "" 1 "echo 'Stitching reads'
+  ${HOME_DIR}/stitch -1 $file1 -2 $file2 -o $tr1 -u1 $tr2 -u2 $tr3 $stParam"
 
 # remove primers, with -rq
-echo "Removing primers"
 log1=joinlog.txt
 tr0=join-pr.fastq$gz
 tr4=join-nopr.fastq$gz
+wParam=""
+if [ $ordinals -eq 1 ]; then
+  tr4=join-nopr.txt$gz
+  wParam="-wo"  # write only the ordinals of the reads
+fi
 rpParam="-fp -1,1 -rp -1,1 -ef 2 -er 2"  # allowing 2 subs, can start at +/- 1
-${HOME_DIR}/removePrimer -i $tr1 -p $prim -o $tr0 $rpParam -rq -l $log1 -w $tr4  # require both primers
+rpCmd=${HOME_DIR}/removePrimer
+if [ -n "$rpService" ]; then
+  rpCmd="$rpCmd -sc $rpService"  # submit to the service
+fi
+xpTag=0  # set to 1 to label reads with a SAM tag, carried by bowtie2 into
+         #   the alignments (needs --sam-append-comment, bowtie2 >= 2.3.4),
+         #   so checkAltMapping.pl and filterSAM.pl need not load the reads
+fqIn=""
+if [ $xpTag -eq 1 ]; then
+  rpParam="$rpParam -xp"
+  fqIn="-xp"
+fi
+tr11=len1.txt
+tr12=len2.fastq
+lenVars=0  # set to 1 to find length variants while removing primers, in
+           #   place of findLengthVars.pl and getLengthVars.pl (counted
+           #   before quality trimming, so percentages near -lp and the
+           #   reads realigned may differ)
+lvParam=""
+if [ $lenVars -eq 1 ]; then
+  tr12=len2.fastq$gz
+  lvParam="-lb $bed -lv $tr11 -lr $tr12"
+fi
+fifo $tr0
+step rp "panel stitch|" 1 "echo 'Removing primers'
+  $rpCmd -i $tr1 -p $pnl -o $tr0 $rpParam -rq -l $log1 -w $tr4 $wParam $lvParam"  # require both primers
 
 # retrieve reads whose primers weren't found
-echo "Getting failure reads"
 tr5=nopr1.fastq$gz
 tr6=nopr2.fastq$gz
-python ${HOME_DIR}/getReads.py $tr4 $file1 $tr5
-python ${HOME_DIR}/getReads.py $tr4 $file2 $tr6
+if [ $ordinals -eq 1 ]; then
+  fifo $tr4
+  step fail "rp|" 1 "echo 'Getting failure reads'
+    ${HOME_DIR}/stitch -x $tr4 -1 $file1 -2 $file2 -u1 $tr5 -u2 $tr6"
+else
+  step fail "rp" 1 "echo 'Getting failure reads'
+    python ${HOME_DIR}/getReads.py $tr4 $file1 $tr5
+    python ${HOME_DIR}/getReads.py $tr4 $file2 $tr6"
+fi
 # cat with unjoined reads
-cat $tr2 >> $tr5
-cat $tr3 >> $tr6
+step unjoin "stitch fail" 1 "cat $tr2 >> $tr5
+  cat $tr3 >> $tr6"
 
 # removePrimer individually
-echo "Removing primers individually"
 tr7=nopr1-pr.fastq$gz
 tr8=nopr2-pr.fastq$gz
 log2=nopr1log.txt
 log3=nopr2log.txt
 rpParam2="-rl 16 -el 1 -b $bed -bp -1,1"  # more options to find second primer
-${HOME_DIR}/removePrimer -i $tr5 -p $prim -o $tr7 $rpParam $rpParam2 -l $log2
-${HOME_DIR}/removePrimer -i $tr6 -p $prim -o $tr8 $rpParam $rpParam2 -l $log3
+fifo $tr7 $tr8
+step rp1 "unjoin" 1 "echo 'Removing primers individually'
+  $rpCmd -i $tr5 -p $pnl -o $tr7 $rpParam $rpParam2 -l $log2"
+step rp2 "unjoin" 1 \
+  "$rpCmd -i $tr6 -p $pnl -o $tr8 $rpParam $rpParam2 -l $log3"
 
 # filter singletons
 tr9=noprcomb.fastq$gz
-fsParam="-b -q -c"  # prefer both primers removed, higher quality read, no chimeras
-perl ${HOME_DIR}/filterSingle.pl $tr7 $tr8 $tr9 $fsParam
+fsParam="-b -q -c -s"  # prefer both primers removed, higher quality read, no chimeras;
+                       #   stream the inputs (same read order)
+fifo $tr9
+step single "rp1| rp2|" 1 \
+  "perl ${HOME_DIR}/filterSingle.pl $tr7 $tr8 $tr9 $fsParam"
 
 # quality trim
-echo "Quality filtering"
 out1=joined.fastq$gz
 qtParam="-t 30 -n 20"  # min avg qual 30; min len 20; no window filtering
-${HOME_DIR}/qualTrim -i $tr0 -o $out1 $qtParam
+collapse=0  # set to 1 to collapse identical reads (mapped once, expanded
+            #   to the original reads before variant calling)
+map1=joined.map
+map2=noprcomb-qt.map
+qtCl1=""; qtCl2=""
+if [ $collapse -eq 1 ]; then
+  qtCl1="-cl $map1"
+  qtCl2="-cl $map2"
+fi
+step qt1 "rp|" 1 "echo 'Quality filtering'
+  ${HOME_DIR}/qualTrim -i $tr0 -o $out1 $qtParam $qtCl1"
 tr10=noprcomb-qt.fastq$gz
-${HOME_DIR}/qualTrim -i $tr9 -o $tr10 $qtParam
+step qt2 "single|" 1 "${HOME_DIR}/qualTrim -i $tr9 -o $tr10 $qtParam $qtCl2"
 
 # cat joined and singletons
 out2=combined.fastq$gz
-cat $out1 $tr10 > $out2
+step combine "qt1 qt2" 1 "cat $out1 $tr10 > $out2"
 
 # check for bowtie2 indexes
 gen2=tempGenome.fa
+idxCmd=":"
 if [[ ! -f $idx.1.bt2 || ! -f $idx.2.bt2 ||
     ! -f $idx.3.bt2 || ! -f $idx.4.bt2 ||
     ! -f $idx.rev.1.bt2 || ! -f $idx.rev.2.bt2 ]]; then
-  echo "Building bowtie2 indexes"
+  idxCmd="echo 'Building bowtie2 indexes'"
   if [ ${gen:(-3)} == ".gz" ]; then
-    echo "  Gunzipping genome"
-    gunzip -c $gen > $gen2
-    bowtie2-build $gen2 $idx
+    idxCmd="$idxCmd
+      echo '  Gunzipping genome'
+      gunzip -c $gen > $gen2
+      bowtie2-build $gen2 $idx"
   else
-    bowtie2-build $gen $idx
+    idxCmd="$idxCmd
+      bowtie2-build $gen $idx"
   fi
 fi
+step index "" 1 "$idxCmd"
 
-# map with bowtie2
-echo "Mapping with bowtie2"
+# align reads to their amplicons; only the failures are mapped
+#   genome-wide by bowtie2
 out3=combined.sam
+fastpath=1  # set to 0 to map all reads with bowtie2
+bwtIn=$out2
+bwtDep=combine
+if [ $fastpath -eq 1 ]; then
+  tr19=combinedAmp.sam
+  tr20=combinedFail.fastq$gz
+  aaParam="-w 10"  # band of +/- 10bp; bowtie2's default min. score
+  step align "panel combine" 1 "echo 'Aligning reads to amplicons'
+    ${HOME_DIR}/alignAmp -i $out2 -p $pnl -o $tr19 -u $tr20 $aaParam"
+  bwtIn=$tr20
+  bwtDep=align
+fi
+
+# map with bowtie2
 bwtParam="-D 200 -N 1 -L 18 -i S,1,0.50 -k 20"
-proc=1   # number of processors
-bowtie2 -x $idx -U $out2 -S $out3 $bwtParam -p $proc
+if [[ $collapse -eq 1 || $proc -gt 1 ]]; then
+  bwtParam="$bwtParam --reorder"  # SAM in order of reads (for expandSAM.pl,
+                                  #   and the same with any number of threads)
+fi
+if [ $xpTag -eq 1 ]; then
+  bwtParam="$bwtParam --sam-append-comment"
+fi
+mmap=${mmap:-0}  # set to 1 to load the index with memory-mapped I/O, shared
+                 #   by concurrent runs (as runBatch.sh)
+if [ $mmap -eq 1 ]; then
+  bwtParam="$bwtParam --mm"
+fi
+bwtCmd="echo 'Mapping with bowtie2'
+  bowtie2 -x $idx -U $bwtIn -S $out3 $bwtParam -p $proc"
+if [ $fastpath -eq 1 ]; then
+  bwtCmd="$bwtCmd
+    cat $tr19 >> $out3
+    rm $tr19 $tr20"
+fi
+step bowtie "$bwtDep index" $proc "$bwtCmd"
 
 # find length variants
-echo "Finding length variants"
-tr11=len1.txt
-perl ${HOME_DIR}/findLengthVars.pl $out1 $bed $tr11
-# the output file (len1.txt) can be edited to exclude certain length variants
-tr12=len2.fastq
-perl ${HOME_DIR}/getLengthVars.pl $out1 $tr11 $tr12
+lenDep=rp
+lenCmd="echo 'Finding length variants'"
+if [ $lenVars -eq 0 ]; then
+  lenDep=qt1
+  lenCmd="$lenCmd
+    perl ${HOME_DIR}/findLengthVars.pl $out1 $bed $tr11
+    perl ${HOME_DIR}/getLengthVars.pl $out1 $tr11 $tr12"
+  # the output file (len1.txt) can be edited to exclude certain length variants
+fi
 len3=realign.txt
 tr13=len3v.txt
-perl ${HOME_DIR}/alignLengthVars.pl $tr12 $prim $bed $len3 $tr13 $gen
+step length "primers $lenDep" $proc "$lenCmd
+  perl ${HOME_DIR}/alignLengthVars.pl $tr12 $prim $bed $len3 $tr13 $gen -n $proc"
 
 # check alternative mapping sites
+if [ -z "$fqIn" ]; then
+  fqIn=$out2
+fi
 out4=altMapping.txt
-if [ ! -f $out4 ]; then
-  echo "Checking alternative mapping sites"
-  perl ${HOME_DIR}/checkAltMapping.pl $out2 $out3 $prim $bed $gen $out4
+altDB=${altDB:-""}  # database of judgments shared by samples (e.g. one per panel):
+                    #   sites judged for earlier samples are not rescored
+altCmd=":"
+if [ -n "$altDB" ]; then
+  altCmd="echo 'Checking alternative mapping sites'
+    touch $altDB  # (filterSAM.pl needs the file, even if no sites are judged)
+    perl ${HOME_DIR}/checkAltMapping.pl $fqIn $out3 $prim $bed $gen $out4 -db $altDB"
+elif [ ! -f $out4 ]; then
+  altCmd="echo 'Checking alternative mapping sites'
+    perl ${HOME_DIR}/checkAltMapping.pl $fqIn $out3 $prim $bed $gen $out4"
 fi
+step alt "bowtie" 1 "$altCmd"
 
 # at this point, one can combine the altMapping results for
 #   multiple samples using combAltMapping.pl, then proceed
-#   with the new altMapping.txt as $out4
+#   with the new altMapping.txt as $out4 (with $altDB, the
+#   database holds the results of all samples)
+altIn=$out4
+if [ -n "$altDB" ]; then
+  altIn=$altDB
+fi
 
 # filter SAM -- multi-mapping and realignment of length variants
-echo "Filtering SAM"
 out5=combinedFiltered.sam
 log4=realign.log
-perl ${HOME_DIR}/filterSAM.pl $out2 $bed $out4 $out3 $out5 $len3 $log4
+filtCmd="echo 'Filtering SAM'
+  perl ${HOME_DIR}/filterSAM.pl $fqIn $bed $altIn $out3 $out5 $len3 $log4"
 
-# convert SAM to sorted BAM
-echo "Converting SAM to sorted BAM"
-out6=combinedFiltered.bam
-samtools view -bS $out5 | samtools sort -f - $out6
+# expand collapsed reads
+if [ $collapse -eq 1 ]; then
+  tr14=combinedCollapsed.sam
+  filtCmd="$filtCmd
+    echo 'Expanding collapsed reads'
+    mv $out5 $tr14
+    perl ${HOME_DIR}/expandSAM.pl $tr14 $out5 $map1 $map2
+    rm $tr14"
+fi
+step filter "alt length" 1 "$filtCmd"
 
-# call variants
-echo "Calling variants"
+# pile up reads over the amplicons: by samtools sort and mpileup,
+#   or with nativePileup=1 by ampPileup (no sorting or BAM; records
+#   outside the amplicons are saved to $out6 in place of the sorted
+#   BAM, and the pileup's quality scores are averages of each allele,
+#   so VarScan's average qualities differ from those of mpileup)
+qual=30  # min quality score to count a base
 out7=combinedFiltered.pileup
-if [ ${gen:(-3)} == ".gz" ]; then
-  if [ ! -f $gen2 ]; then
-    echo "  Gunzipping genome for samtools mpileup"
-    gunzip -c $gen > $gen2
-  fi
-  samtools mpileup -B -Q 0 -d 100000 -f $gen2 $out6 > $out7
+nativePileup=0
+if [ $nativePileup -eq 1 ]; then
+  out6=combinedOffTarget.sam
+  out9=combinedFiltered.counts
+  step pileup "panel filter" 1 "echo 'Piling up reads'
+    ${HOME_DIR}/ampPileup -i $out5 -p $pnl -o $out7 -c $out9 \
+      -u $out6 -q $qual"
+  depIn=$out9
 else
-  samtools mpileup -B -Q 0 -d 100000 -f $gen $out6 > $out7
+  # convert SAM to sorted BAM
+  out6=combinedFiltered.bam
+  out9=""
+  pileCmd="echo 'Converting SAM to sorted BAM'
+    samtools view -bS $out5 | samtools sort -f - $out6"
+  if [ ${gen:(-3)} == ".gz" ]; then
+    pileCmd="$pileCmd
+      if [ ! -f $gen2 ]; then
+        echo '  Gunzipping genome for samtools mpileup'
+        gunzip -c $gen > $gen2
+      fi
+      samtools mpileup -B -Q 0 -d 100000 -f $gen2 $out6 > $out7"
+  else
+    pileCmd="$pileCmd
+      samtools mpileup -B -Q 0 -d 100000 -f $gen $out6 > $out7"
+  fi
+  step pileup "filter index" 1 "$pileCmd"
+  depIn=$out7
 fi
-qual=30  # min quality score to count a base
+
+# call variants
 tr15=combFil.snp
-java -jar ${VARSCAN} pileup2snp --min-avg-qual $qual --min-coverage 0 --min-var-freq 0.01 --variants < $out7 > $tr15
+step snp "pileup" 1 "echo 'Calling variants'
+  java -jar ${VARSCAN} pileup2snp --min-avg-qual $qual --min-coverage 0 --min-var-freq 0.01 --variants < $out7 > $tr15"
 tr16=combFil.indel
-java -jar ${VARSCAN} pileup2indel --min-avg-qual $qual --min-coverage 0 --min-var-freq 0.01 --variants < $out7 > $tr16
+step indel "pileup" 1 \
+  "java -jar ${VARSCAN} pileup2indel --min-avg-qual $qual --min-coverage 0 --min-var-freq 0.01 --variants < $out7 > $tr16"
 
 # make VCF, filter
-echo "Producing VCF"
 tr17=temp.vcf
-perl ${HOME_DIR}/makeVCF.pl $tr15 $tr16 $out7 $tr17 $qual $dir
 tr18=temp2.vcf
-perl ${HOME_DIR}/addHPtoVCF.pl $tr17 $gen $tr18
+step vcf "snp indel" 1 "echo 'Producing VCF'
+  perl ${HOME_DIR}/makeVCF.pl $tr15 $tr16 $depIn $tr17 $qual $sample
+  perl ${HOME_DIR}/addHPtoVCF.pl $tr17 $gen $tr18"
 
 # filter variants: remove variants outside target regions
 out8=combinedFiltered.vcf
-perl ${HOME_DIR}/filterVCF.pl $tr18 $out8 -b $bed
+step filterVCF "vcf" 1 "perl ${HOME_DIR}/filterVCF.pl $tr18 $out8 -b $bed"
   # other filtering options for filterVCF.pl:
   #   min. depth 20                          -d 20
   #   min. variant allele observations 10    -o 10
@@ -203,6 +363,8 @@ perl ${HOME_DIR}/filterVCF.pl $tr18 $out8 -b $bed
   #   min. AF for variants in/near homopolymer runs (sliding scale):
   #       -p 4,0.05,0.1:5,0.1,0.2:6,0.2,0.3:7,0.3,0.4:8,0.4,0.5
 
+runSteps $proc $pipeline
+
 # remove extra files
 rm $tr0 $tr1 $tr2 $tr3 $tr4 $tr5 $tr6 $tr7 $tr8 $tr9 $tr10 \
   $tr11 $tr12 $tr13 $tr15 $tr16 $tr17 $tr18
@@ -215,6 +377,9 @@ if [ ! -d $dir ]; then
   mkdir $dir
 fi
 if [ $dir != "." ]; then
-  mv $out1 $out2 $out3 $out4 $out5 $out6 $out7 $out8 \
+  mv $out1 $out2 $out3 $out4 $out5 $out6 $out7 $out8 $out9 \
     $log1 $log2 $log3 $log4 $len3 $dir
+  if [ $collapse -eq 1 ]; then
+    mv $map1 $map2 $dir
+  fi
 fi
@@ -0,0 +1,212 @@
+#!/bin/bash -e
+
+# Oct. 2026
+
+# Runs the pipeline (run.sh) on a batch of samples, each in its own
+#   scratch directory, as many at once as the cores and memory allow.
+#   The per-panel files (primers.txt, the panel bundle, the bowtie2
+#   index, and the database of alternative mapping sites) are made
+#   once and shared, and a removePrimer service loads the panel once
+#   for all samples.
+#   A report lists the outcome of each sample.
+
+# check command-line arguments
+if [ $# -lt 5 ]; then
+  echo "Usage: ./`basename $0`  <SHEET>  <BED>  <GEN>  <IDX>  <DIR>  [<CORES>  [<MEM>]]" 1>&2
+  echo "  <SHEET>  Sample sheet: name, FASTQ1, FASTQ2 (whitespace-delimited)" 1>&2
+  echo "  <CORES>  Total cores (def. all)" 1>&2
+  echo "  <MEM>    Total memory, in GB (def. all)" 1>&2
+  exit -1
+fi
+
+# set home directory
+HOME_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
+
+# absolute path of a file (from the current directory)
+absPath() {
+  case $1 in
+    /*) echo $1 ;;
+    *)  echo $PWD/$1 ;;
+  esac
+}
+
+# input files
+sheet=$1
+bed=$(absPath $2)
+gen=$(absPath $3)
+idx=$(absPath $4)
+dir=$(absPath $5)
+cores=${6:-$(nproc 2> /dev/null || echo 1)}
+mem=${7:-$(awk '/^MemTotal/ { print int($2 / 1048576) }' /proc/meminfo)}
+
+# resources per sample
+sampleCpus=2  # processors given to each run.sh (bowtie2, alignLengthVars.pl)
+sampleMem=2   # GB of memory per sample (the bowtie2 index is shared, via --mm)
+
+# check input files
+if [ ! -f $sheet ]; then
+  echo "Sample sheet not found"
+  exit -1
+elif [ ! -f $bed ]; then
+  echo "Input primer BED file not found"
+  exit -1
+elif [ ! -f $gen ]; then
+  echo "Input reference genome not found"
+  exit -1
+fi
+VARSCAN=$(absPath ${VARSCAN:-"./VarScan.v2.3.7.jar"})
+if [ ! -f $VARSCAN ]; then
+  echo "VarScan jar file not found"
+  exit -1
+fi
+
+# load sample sheet
+names=(); fq1=(); fq2=()
+while read -r name file1 file2 rest; do
+  [[ -z "$name" || ${name:0:1} == "#" ]] && continue
+  # names are used as directory names (and removed)
+  if [[ ! "$name" =~ ^[A-Za-z0-9_.-]+$ || "$name" == "." ||
+      "$name" == ".." ]]; then
+    echo "Error! Sample name $name must be letters, digits, '_', '.', or '-'" 1>&2
+    exit -1
+  elif [ -z "$file2" ]; then
+    echo "Error! Sample $name needs two FASTQ files" 1>&2
+    exit -1
+  elif [[ " ${names[*]} work " == *" $name "* ]]; then
+    echo "Error! Sample $name is repeated" 1>&2
+    exit -1
+  fi
+  file1=$(absPath $file1)
+  file2=$(absPath $file2)
+  if [[ ! -f $file1 || ! -f $file2 ]]; then
+    echo "Error! Input FASTQ files of sample $name not found" 1>&2
+    exit -1
+  fi
+  names+=("$name"); fq1+=("$file1"); fq2+=("$file2")
+done < $sheet
+if [ ${#names[@]} -eq 0 ]; then
+  echo "Error! No samples in $sheet" 1>&2
+  exit -1
+fi
+
+# number of samples run at once
+slots=$((cores / sampleCpus))
+if [ $((mem / sampleMem)) -lt $slots ]; then
+  slots=$((mem / sampleMem))
+fi
+if [ $slots -lt 1 ]; then
+  slots=1
+fi
+mkdir -p "$dir/work"
+
+# per-panel files: primer-target sequences, panel bundle,
+#   bowtie2 index, and the database of alternative mapping sites
+prim=$dir/primers.txt
+if [ ! -f $prim ]; then
+  echo "Retrieving primer-target sequences"
+  perl ${HOME_DIR}/getPrimers.pl $bed $gen $prim
+fi
+pnl=$dir/panel.pnl
+${HOME_DIR}/buildPanel -p $prim -b $bed -g $gen -o $pnl -u
+if [[ ! -f $idx.1.bt2 || ! -f $idx.2.bt2 ||
+    ! -f $idx.3.bt2 || ! -f $idx.4.bt2 ||
+    ! -f $idx.rev.1.bt2 || ! -f $idx.rev.2.bt2 ]]; then
+  echo "Building bowtie2 indexes"
+  if [ ${gen:(-3)} == ".gz" ]; then
+    gen2=$dir/work/tempGenome.fa
+    gunzip -c $gen > $gen2
+    bowtie2-build $gen2 $idx
+    rm $gen2
+  else
+    bowtie2-build $gen $idx
+  fi
+fi
+perl -I${HOME_DIR} -MFaidx -e 'Faidx->new($ARGV[0])' $gen  # index the genome
+export VARSCAN
+export altDB=$(absPath ${altDB:-$dir/altMapping.db})
+export proc=$sampleCpus
+export mmap=1
+
+# removePrimer service: the panel is loaded once, and each run's
+#   removePrimer jobs (up to 3 at once) are submitted to it
+service=1  # set to 0 to start removePrimer anew for each job
+if [ $service -eq 1 ]; then
+  sock=${TMPDIR:-/tmp}/removePrimer.$$.sock
+  ${HOME_DIR}/removePrimer -sv $sock -p $pnl -b $bed \
+    -sj $((3 * slots)) > /dev/null &
+  svPid=$!
+  trap "kill $svPid 2> /dev/null || true" EXIT
+  while [ ! -S $sock ]; do
+    kill -0 $svPid 2> /dev/null || { echo "Error! Cannot start removePrimer service" 1>&2; exit -1; }
+    sleep 0.1
+  done
+  export rpService=$sock
+fi
+
+# run a sample in its scratch directory
+runSample() {
+  local x=$1
+  local work="$dir/work/${names[$x]}"
+  rm -rf "$work"
+  mkdir -p "$work"
+  ln -s "$prim" "$work/primers.txt"
+  ln -s "$pnl" "$work/panel.pnl"
+  cd "$work"
+  local start=$(date +%s)
+  local stat=0
+  sample=${names[$x]} ${HOME_DIR}/run.sh ${fq1[$x]} ${fq2[$x]} $bed $gen $idx \
+    "$dir/${names[$x]}" > "$work.log" 2>&1 || stat=$?
+  echo -e "$stat\t$(( $(date +%s) - start ))" > "$work.status"
+  if [ $stat -eq 0 ]; then
+    cd "$dir"
+    rm -rf "$work"
+    mv "$work.log" "$dir/${names[$x]}/run.log"
+  fi
+}
+
+# run the samples, at most $slots at once
+echo "Running ${#names[@]} samples, $slots at a time"
+running=0
+pids=()
+for ((x = 0; x < ${#names[@]}; x++)); do
+  if [ $running -ge $slots ]; then
+    wait -n || true
+    running=$((running - 1))
+  fi
+  echo "  ${names[$x]}"
+  runSample $x &
+  pids+=($!)
+  running=$((running + 1))
+done
+wait ${pids[@]} || true
+
+# combined report
+report=$dir/report.txt
+echo -e "#Sample\tStatus\tSeconds\tJoinedReads\tVariants\tOutput" > $report
+fail=0
+for ((x = 0; x < ${#names[@]}; x++)); do
+  name=${names[$x]}
+  stat=-1; secs="-"
+  if [ -f "$dir/work/$name.status" ]; then
+    read -r stat secs < "$dir/work/$name.status"
+    rm "$dir/work/$name.status"
+  fi
+  if [ $stat -eq 0 ]; then
+    out="$dir/$name"
+    if [ -f "$out/joined.fastq.gz" ]; then
+      reads=$(gunzip -c "$out/joined.fastq.gz" | awk 'END { print int(NR / 4) }')
+    else
+      reads=$(awk 'END { print int(NR / 4) }' "$out/joined.fastq")
+    fi
+    vars=$(grep -vc '^#' "$out/combinedFiltered.vcf" || true)
+    echo -e "$name\tOK\t$secs\t$reads\t$vars\t$out" >> $report
+  else
+    fail=$((fail + 1))
+    echo -e "$name\tFAILED($stat)\t$secs\t-\t-\t$dir/work/$name.log" >> $report
+  fi
+done
+rmdir "$dir/work" 2> /dev/null || true
+echo "Samples completed: $(( ${#names[@]} - fail )) of ${#names[@]} (see $report)"
+if [ $fail -gt 0 ]; then
+  exit 1
+fi
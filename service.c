@@ -0,0 +1,324 @@
+/*
+  October 2026
+
+  Running a program as a service on a Unix socket, so that
+    data loaded at start-up (e.g. the primers of a panel)
+    are reused by many jobs.
+  A client sends its working directory and command line.
+    The service forks a process for each job (sharing the
+    loaded data, copy-on-write), which runs the command in
+    that directory, with its messages sent to the client,
+    followed by a line with its exit status.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include "service.h"
+
+static char* svSock;  // socket to remove when the service stops
+static int svDone;    // job completed
+
+/* int svError()
+ * Prints an error message.
+ */
+static int svError(char* msg, int err) {
+  char* msg2;
+  if (err == ERRSVSOCK) msg2 = MERRSVSOCK;
+  else if (err == ERRSVCONN) msg2 = MERRSVCONN;
+  else if (err == ERRSVJOBS) msg2 = MERRSVJOBS;
+  else if (err == ERRSVMSG) msg2 = MERRSVMSG;
+  else if (err == ERRSVFORK) msg2 = MERRSVFORK;
+  else if (err == ERRSVCWD) msg2 = MERRSVCWD;
+  else msg2 = "Unknown error";
+
+  fprintf(stderr, "Error! %s%s\n", msg, msg2);
+  return -1;
+}
+
+/* void* svAlloc()
+ * Resizes (or allocates) a heap block.
+ */
+static void* svAlloc(void* ptr, size_t size) {
+  void* ans = realloc(ptr, size);
+  if (ans == NULL) {
+    fprintf(stderr, "Error! cannot allocate memory\n");
+    exit(-1);
+  }
+  return ans;
+}
+
+/* void initService()
+ * Initializes a service (none).
+ */
+void initService(Service* sv) {
+  sv->path = NULL;
+  sv->sock = -1;
+  sv->jobs = DEFSVJOBS;
+  sv->running = 0;
+}
+
+/* void setSvJobs()
+ * Sets the max. number of jobs run at once.
+ */
+void setSvJobs(Service* sv, char* in) {
+  char* endptr;
+  sv->jobs = (int) strtol(in, &endptr, 10);
+  if (*endptr != '\0' || sv->jobs < 1)
+    exit(svError(in, ERRSVJOBS));
+}
+
+/* char* findOpt()
+ * Returns the value of a command-line option (NULL if
+ *   not given).
+ */
+char* findOpt(int argc, char** argv, char* opt) {
+  for (int i = 1; i < argc - 1; i++)
+    if (!strcmp(argv[i], opt))
+      return argv[i + 1];
+  return NULL;
+}
+
+/* char* getDir()
+ * Returns the current working directory (heap copy).
+ */
+static char* getDir(void) {
+  size_t size = SVLINE;
+  char* dir = (char*) svAlloc(NULL, size);
+  while (getcwd(dir, size) == NULL) {
+    if (errno != ERANGE)
+      exit(svError(".", ERRSVCWD));
+    size *= 2;
+    dir = (char*) svAlloc(dir, size);
+  }
+  return dir;
+}
+
+/* char* absPath()
+ * Returns the path of a file from the root (heap copy),
+ *   to be found by jobs run in other directories.
+ */
+char* absPath(char* file) {
+  if (file[0] == '/') {
+    char* ans = (char*) svAlloc(NULL, strlen(file) + 1);
+    strcpy(ans, file);
+    return ans;
+  }
+  char* dir = getDir();
+  char* ans = (char*) svAlloc(NULL, strlen(dir) + strlen(file) + 2);
+  sprintf(ans, "%s/%s", dir, file);
+  free(dir);
+  return ans;
+}
+
+/* int sameFile()
+ * Returns 1 if the given paths name the same file.
+ */
+int sameFile(char* file1, char* file2) {
+  struct stat s1, s2;
+  return ! stat(file1, &s1) && ! stat(file2, &s2)
+    && s1.st_dev == s2.st_dev && s1.st_ino == s2.st_ino;
+}
+
+/* void stopService()
+ * Removes the socket when the service is stopped (signal).
+ */
+static void stopService(int sig) {
+  unlink(svSock);
+  _exit(0);
+}
+
+/* void jobExit()
+ * Sends the exit status of a job to its client (at exit).
+ */
+static void jobExit(void) {
+  fflush(stdout);
+  fprintf(stderr, "%s%d\n", SVEXIT, svDone ? 0 : 1);
+  fflush(stderr);
+}
+
+/* void endJob()
+ * Marks a job as completed.
+ */
+void endJob(void) {
+  svDone = 1;
+}
+
+/* void readJob()
+ * Receives a job (working directory, then the arguments,
+ *   each NUL-terminated) in its process, and sets it up:
+ *   stdout and stderr go to the client.
+ */
+static void readJob(int conn, int* argc, char*** argv) {
+  size_t max = SVLINE, len = 0;
+  char* msg = (char*) svAlloc(NULL, max);
+  ssize_t n;
+  while ((n = read(conn, msg + len, max - len)) > 0) {
+    len += n;
+    if (len == max) {
+      max *= 2;
+      msg = (char*) svAlloc(msg, max);
+    }
+  }
+  if (dup2(conn, STDOUT_FILENO) == -1 || dup2(conn, STDERR_FILENO) == -1)
+    exit(-1);
+  close(conn);
+  atexit(jobExit);
+  if (n == -1 || ! len || msg[len - 1] != '\0')
+    exit(svError("", ERRSVMSG));
+
+  // working directory, arguments (after the program name)
+  if (chdir(msg))
+    exit(svError(msg, ERRSVCWD));
+  int k = 0;
+  for (size_t i = 0; i < len; i++)
+    if (msg[i] == '\0')
+      k++;
+  char** args = (char**) svAlloc(NULL, (k + 1) * sizeof(char*));
+  args[0] = (*argv)[0];
+  char* arg = msg + strlen(msg) + 1;
+  for (int i = 1; i < k; i++) {
+    args[i] = arg;
+    arg += strlen(arg) + 1;
+  }
+  args[k] = NULL;
+  *argc = k;
+  *argv = args;
+}
+
+/* void serveJobs()
+ * Accepts jobs on the socket, each run in a new process,
+ *   at most 'jobs' at once. Returns only in the process
+ *   of a job, with its command line.
+ */
+void serveJobs(Service* sv, int* argc, char*** argv) {
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (strlen(sv->path) >= sizeof(addr.sun_path))
+    exit(svError(sv->path, ERRSVSOCK));
+  strcpy(addr.sun_path, sv->path);
+
+  // remove a socket left by a previous service
+  struct stat st;
+  if (! stat(sv->path, &st) && S_ISSOCK(st.st_mode))
+    unlink(sv->path);
+  sv->sock = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (sv->sock == -1 || bind(sv->sock, (struct sockaddr*) &addr,
+      sizeof(addr)) || listen(sv->sock, SVBACKLOG))
+    exit(svError(sv->path, ERRSVSOCK));
+  svSock = sv->path;
+  signal(SIGINT, stopService);
+  signal(SIGTERM, stopService);
+  printf("Service ready on %s\n", sv->path);
+  fflush(stdout);
+
+  for (;;) {
+    // collect finished jobs (waiting for one if at the max.)
+    while (sv->running) {
+      pid_t pid = waitpid(-1, NULL,
+        sv->running < sv->jobs ? WNOHANG : 0);
+      if (pid <= 0)
+        break;
+      sv->running--;
+    }
+
+    int conn = accept(sv->sock, NULL, NULL);
+    if (conn == -1)
+      continue;
+    pid_t pid = fork();
+    if (pid == -1) {
+      svError("", ERRSVFORK);
+      close(conn);
+    } else if (pid == 0) {
+      close(sv->sock);
+      signal(SIGINT, SIG_DFL);
+      signal(SIGTERM, SIG_DFL);
+      readJob(conn, argc, argv);
+      return;
+    } else {
+      close(conn);
+      sv->running++;
+    }
+  }
+}
+
+/* int writeAll()
+ * Writes a block to a socket. Returns 0 on failure.
+ */
+static int writeAll(int fd, char* buf, size_t len) {
+  while (len) {
+    ssize_t n = write(fd, buf, len);
+    if (n <= 0)
+      return 0;
+    buf += n;
+    len -= n;
+  }
+  return 1;
+}
+
+/* int submitJob()
+ * Sends the command line (without SVCLIENT <socket>) to the
+ *   service, and relays its messages to stderr. Returns the
+ *   exit status of the job.
+ */
+int submitJob(char* path, int argc, char** argv) {
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (strlen(path) >= sizeof(addr.sun_path))
+    exit(svError(path, ERRSVCONN));
+  strcpy(addr.sun_path, path);
+  int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (sock == -1 || connect(sock, (struct sockaddr*) &addr, sizeof(addr)))
+    exit(svError(path, ERRSVCONN));
+
+  // send working directory and arguments
+  char* dir = getDir();
+  int ok = writeAll(sock, dir, strlen(dir) + 1);
+  free(dir);
+  for (int i = 1; ok && i < argc; i++) {
+    if (!strcmp(argv[i], SVCLIENT) && i < argc - 1)
+      i++;
+    else
+      ok = writeAll(sock, argv[i], strlen(argv[i]) + 1);
+  }
+  if (! ok || shutdown(sock, SHUT_WR))
+    exit(svError(path, ERRSVCONN));
+
+  // relay messages; the last line is the exit status
+  FILE* in = fdopen(sock, "r");
+  if (in == NULL)
+    exit(svError(path, ERRSVCONN));
+  char* line = (char*) svAlloc(NULL, SVLINE);
+  char* prev = (char*) svAlloc(NULL, SVLINE);
+  int stat = 1, saved = 0;
+  while (fgets(line, SVLINE, in) != NULL) {
+    if (saved)
+      fputs(prev, stderr);
+    char* temp = prev;
+    prev = line;
+    line = temp;
+    saved = 1;
+  }
+  if (saved) {
+    if (!strncmp(prev, SVEXIT, strlen(SVEXIT)))
+      stat = atoi(prev + strlen(SVEXIT));
+    else
+      fputs(prev, stderr);
+  }
+  fclose(in);
+  free(line);
+  free(prev);
+  return stat;
+}
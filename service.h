@@ -0,0 +1,45 @@
+/*
+  October 2026
+
+  Header file for service.c.
+*/
+
+#define SVBACKLOG   64     // pending connections to the socket
+#define SVLINE      1024   // initial size of job message; reply lines
+#define SVEXIT      "#exit "  // last line of a reply: exit status of job
+#define DEFSVJOBS   1
+
+// command-line parameters (removePrimer)
+#define SVOPT       "-sv"  // run as a service, on the given socket
+#define SVJOBS      "-sj"  // max. jobs at once
+#define SVCLIENT    "-sc"  // submit the command to a service
+
+// error messages
+#define ERRSVSOCK   0
+#define MERRSVSOCK  ": cannot open socket for service"
+#define ERRSVCONN   1
+#define MERRSVCONN  ": cannot connect to service"
+#define ERRSVJOBS   2
+#define MERRSVJOBS  ": jobs must be an int greater than 0"
+#define ERRSVMSG    3
+#define MERRSVMSG   "cannot receive job from client"
+#define ERRSVFORK   4
+#define MERRSVFORK  "cannot start job"
+#define ERRSVCWD    5
+#define MERRSVCWD   ": cannot change to directory of client"
+
+typedef struct service {
+  char* path;      // Unix socket
+  int sock;
+  int jobs;        // max. jobs at once
+  int running;
+} Service;
+
+void initService(Service* sv);
+void setSvJobs(Service* sv, char* in);
+char* findOpt(int argc, char** argv, char* opt);
+char* absPath(char* file);
+int sameFile(char* file1, char* file2);
+void serveJobs(Service* sv, int* argc, char*** argv);
+void endJob(void);
+int submitJob(char* path, int argc, char** argv);
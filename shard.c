@@ -0,0 +1,440 @@
+/*
+  October 2026
+
+  Restricting the analysis of a (plain or BGZF compressed)
+    FASTQ/FASTA file to one shard of the file.
+  A shard is a byte range of the input file. A record belongs
+    to the shard in which the newline preceding it lies, so
+    the shards of a file partition its records exactly.
+  For BGZF files, the range is moved to the next block
+    boundaries, and the shard is decompressed from there.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+#define _FILE_OFFSET_BITS 64
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <zlib.h>
+#include "shard.h"
+
+/* int shardError()
+ * Prints an error message.
+ */
+static int shardError(char* msg, int err) {
+  char* msg2;
+  if (err == ERRSHARD) msg2 = MERRSHARD;
+  else if (err == ERRSHBYTE) msg2 = MERRSHBYTE;
+  else if (err == ERRSHGZ) msg2 = MERRSHGZ;
+  else if (err == ERRSHOPEN) msg2 = MERRSHOPEN;
+  else if (err == ERRSHREC) msg2 = MERRSHREC;
+  else if (err == ERRSHMATE) msg2 = MERRSHMATE;
+  else msg2 = "Unknown error";
+
+  fprintf(stderr, "Error! %s%s\n", msg, msg2);
+  return -1;
+}
+
+/* void initShard()
+ * Initializes a shard to the whole file.
+ */
+void initShard(Shard* sh) {
+  sh->idx = sh->tot = 0;
+  sh->rSt = sh->st = sh->pos = sh->mateSt = 0;
+  sh->rEnd = sh->end = -1;
+}
+
+/* void parseShard()
+ * Parses a shard given as <int>/<int> (e.g. 2/8).
+ */
+void parseShard(char* arg, Shard* sh) {
+  char* endptr;
+  sh->idx = (int) strtol(arg, &endptr, 10);
+  if (*endptr != '/')
+    exit(shardError(arg, ERRSHARD));
+  sh->tot = (int) strtol(endptr + 1, &endptr, 10);
+  if (*endptr != '\0' || sh->idx < 1 || sh->idx > sh->tot)
+    exit(shardError(arg, ERRSHARD));
+}
+
+/* void parseShardBytes()
+ * Parses an explicit byte range given as <int>,<int>.
+ */
+void parseShardBytes(char* arg, Shard* sh) {
+  char* endptr;
+  sh->rSt = strtoll(arg, &endptr, 10);
+  if (*endptr != ',')
+    exit(shardError(arg, ERRSHBYTE));
+  sh->rEnd = strtoll(endptr + 1, &endptr, 10);
+  if (*endptr != '\0' || sh->rSt < 0 || sh->rEnd < sh->rSt)
+    exit(shardError(arg, ERRSHBYTE));
+}
+
+/* int isShard()
+ * Returns 1 if a shard or byte range was specified.
+ */
+int isShard(Shard* sh) {
+  return sh->tot || sh->rEnd >= 0;
+}
+
+/* long long fileSize()
+ * Returns the size of the given file.
+ */
+static long long fileSize(char* inFile) {
+  struct stat st;
+  if (stat(inFile, &st))
+    exit(shardError(inFile, ERRSHOPEN));
+  return (long long) st.st_size;
+}
+
+/* long long tellFile()
+ * Returns the current (uncompressed) stream position.
+ */
+static long long tellFile(File in, int gz) {
+  return gz ? (long long) gztell(in.gzf)
+    : (long long) ftello(in.f);
+}
+
+/* void seekFile()
+ * Moves to the given (uncompressed) stream position.
+ */
+static void seekFile(File in, int gz, long long pos, char* inFile) {
+  if ( (gz && gzseek(in.gzf, (z_off_t) pos, SEEK_SET) == -1) ||
+      (! gz && fseeko(in.f, (off_t) pos, SEEK_SET)) )
+    exit(shardError(inFile, ERRSHOPEN));
+}
+
+/* int nextLine()
+ * Reads a full line (saving up to SHARD_LINE chars of it).
+ *   Returns the first char of the line, or EOF.
+ */
+static int nextLine(File in, int gz, char* buf, long long* off) {
+  *off = tellFile(in, gz);
+  if ( (gz && gzgets(in.gzf, buf, SHARD_LINE) == NULL) ||
+      (! gz && fgets(buf, SHARD_LINE, in.f) == NULL) )
+    return EOF;
+  int first = (unsigned char) buf[0];
+
+  // skip the remainder of a long line
+  char skip[SHARD_LINE];
+  char* chunk = buf;
+  while (chunk[strlen(chunk) - 1] != '\n') {
+    chunk = skip;
+    if ( (gz && gzgets(in.gzf, chunk, SHARD_LINE) == NULL) ||
+        (! gz && fgets(chunk, SHARD_LINE, in.f) == NULL) )
+      break;
+  }
+  return first;
+}
+
+/* int checkBgzf()
+ * Checks for a BGZF block header. Returns the block size,
+ *   or 0 if not a header.
+ */
+static int checkBgzf(unsigned char* h) {
+  if (h[0] != 0x1f || h[1] != 0x8b || h[2] != 8 || !(h[3] & 4)
+      || h[10] != 6 || h[11] != 0 || h[12] != 'B' || h[13] != 'C'
+      || h[14] != 2 || h[15] != 0)
+    return 0;
+  return (h[16] | (h[17] << 8)) + 1;
+}
+
+/* long long syncBgzf()
+ * Finds the first BGZF block that begins at or after
+ *   the given offset.
+ */
+static long long syncBgzf(int fd, long long off, long long size,
+    char* inFile) {
+  unsigned char h[BGZF_HEAD];
+  if (! off) {
+    if (pread(fd, h, BGZF_HEAD, 0) != BGZF_HEAD || ! checkBgzf(h))
+      exit(shardError(inFile, ERRSHGZ));
+    return 0;
+  }
+
+  unsigned char* win = (unsigned char*) malloc(BGZF_WIN + BGZF_HEAD);
+  if (win == NULL)
+    exit(shardError(inFile, ERRSHOPEN));
+  for (long long st = off; st < size; st += BGZF_WIN) {
+    ssize_t n = pread(fd, win, BGZF_WIN + BGZF_HEAD, st);
+    if (n <= 0)
+      break;
+    for (int i = 0; i < BGZF_WIN && i + BGZF_HEAD <= n; i++) {
+      int bsize = checkBgzf(win + i);
+      if (! bsize)
+        continue;
+      // confirm with next header (to avoid false positives)
+      long long next = st + i + bsize;
+      if (next == size || (next < size &&
+          pread(fd, h, BGZF_HEAD, next) == BGZF_HEAD &&
+          checkBgzf(h))) {
+        free(win);
+        return st + i;
+      }
+    }
+  }
+  free(win);
+  return size;
+}
+
+/* long long sumIsize()
+ * Sums the uncompressed sizes of the BGZF blocks in [st, end).
+ */
+static long long sumIsize(int fd, long long st, long long end,
+    char* inFile) {
+  long long sum = 0;
+  unsigned char h[BGZF_HEAD];
+  while (st < end) {
+    int bsize;
+    if (pread(fd, h, BGZF_HEAD, st) != BGZF_HEAD ||
+        ! (bsize = checkBgzf(h)) ||
+        pread(fd, h, 4, st + bsize - 4) != 4)
+      exit(shardError(inFile, ERRSHGZ));
+    sum += h[0] | (h[1] << 8) | (h[2] << 16) |
+      ((long long) h[3] << 24);
+    st += bsize;
+  }
+  return sum;
+}
+
+/* void openAt()
+ * Opens a file for reading, beginning at the given
+ *   raw offset (a block boundary for BGZF files).
+ */
+static void openAt(char* inFile, File* in, int gz, long long off) {
+  if (gz) {
+    int fd = open(inFile, O_RDONLY);
+    if (fd == -1 || lseek(fd, (off_t) off, SEEK_SET) == -1 ||
+        (in->gzf = gzdopen(fd, "r")) == NULL)
+      exit(shardError(inFile, ERRSHOPEN));
+  } else {
+    in->f = fopen(inFile, "r");
+    if (in->f == NULL || fseeko(in->f, (off_t) off, SEEK_SET))
+      exit(shardError(inFile, ERRSHOPEN));
+  }
+}
+
+/* long long syncRecord()
+ * Moves to the first record at or after the current position.
+ *   If 'partial', the current line is considered incomplete.
+ *   A FASTQ header is a line beginning with '@' that is followed
+ *   two lines later by one beginning with '+' (a quality line
+ *   that begins with '@' is followed two lines later by the
+ *   next sequence).
+ *   Returns the record's stream position (or EOF position).
+ */
+static long long syncRecord(File in, int gz, int fastq, int partial,
+    char* inFile) {
+  char buf[SHARD_LINE];
+  long long off[3];
+  int first[3];
+  int n = 0;  // number of lines read
+  if (partial && nextLine(in, gz, buf, off) == EOF)
+    return tellFile(in, gz);
+  for (;;) {
+    int i = n % 3;
+    first[i] = nextLine(in, gz, buf, off + i);
+    if (first[i] == EOF)
+      return off[i];
+    n++;
+    if (! fastq) {
+      if (first[i] == '>') {
+        seekFile(in, gz, off[i], inFile);
+        return off[i];
+      }
+    } else if (n > 2 && first[i] == '+' && first[(i+1) % 3] == '@') {
+      seekFile(in, gz, off[(i+1) % 3], inFile);
+      return off[(i+1) % 3];
+    }
+    if (n > 64)
+      exit(shardError(inFile, ERRSHREC));
+  }
+}
+
+/* void openShard()
+ * Opens the input file and moves to the first record of
+ *   the shard. Sets the limit for the records' positions.
+ */
+void openShard(char* inFile, File* in, int gz, int fastq, Shard* sh) {
+  // determine byte range
+  long long size = fileSize(inFile);
+  long long end;
+  if (sh->tot) {
+    sh->st = (long long) ((long double) size * (sh->idx - 1) / sh->tot);
+    end = (long long) ((long double) size * sh->idx / sh->tot);
+  } else {
+    sh->st = sh->rSt < size ? sh->rSt : size;
+    end = sh->rEnd < size ? sh->rEnd : size;
+  }
+
+  if (gz) {
+    // move range to BGZF block boundaries
+    int fd = open(inFile, O_RDONLY);
+    if (fd == -1)
+      exit(shardError(inFile, ERRSHOPEN));
+    syncBgzf(fd, 0, size, inFile);  // confirm BGZF
+    sh->st = syncBgzf(fd, sh->st, size, inFile);
+    end = syncBgzf(fd, end, size, inFile);
+    sh->end = sumIsize(fd, sh->st, end, inFile);
+    close(fd);
+  } else
+    sh->end = end;
+
+  openAt(inFile, in, gz, sh->st);
+  sh->pos = syncRecord(*in, gz, fastq, sh->st > 0, inFile);
+}
+
+/* int matchHead()
+ * Checks if two headers are the same read (up to the first
+ *   space, as required by stitch).
+ */
+static int matchHead(char* head1, char* head2) {
+  int i;
+  for (i = 1; head1[i] == head2[i]; i++)
+    if (head1[i] == ' ' || head1[i] == '\n' || head1[i] == '\0')
+      return 1;
+  return (head1[i] == ' ' || head1[i] == '\n') &&
+    (head2[i] == ' ' || head2[i] == '\n');
+}
+
+/* void openMate()
+ * Opens the 2nd input file of a pair, moving to the read that
+ *   matches the first read of the shard of the 1st input file
+ *   (already opened). The search begins at the proportional
+ *   position in the 2nd file, expanding the window as needed.
+ */
+void openMate(char* inFile, File* in, int gz, char* mateFile,
+    File mate, Shard* sh) {
+  // load first header of the shard
+  char head[SHARD_LINE], buf[SHARD_LINE];
+  long long off;
+  if (nextLine(mate, gz, head, &off) == EOF ||
+      (sh->end >= 0 && off > sh->end)) {
+    // empty shard
+    openAt(inFile, in, gz, 0);
+    sh->mateSt = 0;
+    return;
+  }
+  seekFile(mate, gz, off, mateFile);
+
+  long long size = fileSize(inFile);
+  long long mateSize = fileSize(mateFile);
+  long long guess = mateSize ? (long long) ((long double) sh->st
+    * size / mateSize) : 0;
+  for (long long win = SHARD_WIN; ; win *= 4) {
+    long long lo = guess > win ? guess - win : 0;
+    long long hi = guess + win;
+
+    long long st = lo;
+    if (gz) {
+      int fd = open(inFile, O_RDONLY);
+      if (fd == -1)
+        exit(shardError(inFile, ERRSHOPEN));
+      st = syncBgzf(fd, lo, size, inFile);
+      close(fd);
+    }
+    openAt(inFile, in, gz, st);
+    syncRecord(*in, gz, 1, st > 0, inFile);
+
+    // scan headers for a match
+    for (;;) {
+      if (nextLine(*in, gz, buf, &off) == EOF)
+        break;
+      if (matchHead(head, buf)) {
+        seekFile(*in, gz, off, inFile);
+        sh->mateSt = st;
+        return;
+      }
+      int i;
+      for (i = 0; i < 3; i++)
+        if (nextLine(*in, gz, buf, &off) == EOF)
+          break;
+      if (i < 3 || (gz ? (long long) gzoffset(in->gzf)
+          : (long long) ftello(in->f)) > hi)
+        break;
+    }
+
+    if ( (gz && gzclose(in->gzf) != Z_OK) || (! gz && fclose(in->f)) )
+      exit(shardError(inFile, ERRSHOPEN));
+    if (! lo && hi >= size)
+      exit(shardError(head, ERRSHMATE));
+  }
+}
+
+/* int inShard()
+ * Returns 1 if the next record belongs to the shard.
+ */
+int inShard(File in, int gz, Shard* sh) {
+  return sh->end < 0 || tellFile(in, gz) <= sh->end;
+}
+
+/* int isBgzf()
+ * Returns 1 if the given file is BGZF compressed.
+ */
+int isBgzf(char* inFile) {
+  unsigned char h[BGZF_HEAD];
+  int fd = open(inFile, O_RDONLY);
+  if (fd == -1)
+    exit(shardError(inFile, ERRSHOPEN));
+  int ans = pread(fd, h, BGZF_HEAD, 0) == BGZF_HEAD && checkBgzf(h);
+  close(fd);
+  return ans;
+}
+
+/* long long bgzfVoff()
+ * Converts a stream position (relative to the block at which the
+ *   file was opened) to a BGZF virtual offset. The current block
+ *   (blk) and its stream position (blkPos) are saved between
+ *   calls, so the blocks are walked only once.
+ */
+long long bgzfVoff(char* inFile, long long* blk, long long* blkPos,
+    long long pos) {
+  unsigned char h[BGZF_HEAD];
+  int fd = open(inFile, O_RDONLY);
+  if (fd == -1)
+    exit(shardError(inFile, ERRSHOPEN));
+  for (;;) {
+    int bsize;
+    if (pread(fd, h, BGZF_HEAD, *blk) != BGZF_HEAD)
+      break;  // end of file
+    if (! (bsize = checkBgzf(h)) ||
+        pread(fd, h, 4, *blk + bsize - 4) != 4)
+      exit(shardError(inFile, ERRSHGZ));
+    long long isize = h[0] | (h[1] << 8) | (h[2] << 16) |
+      ((long long) h[3] << 24);
+    if (*blkPos + isize > pos)
+      break;
+    *blk += bsize;
+    *blkPos += isize;
+  }
+  close(fd);
+  return (*blk << 16) | (pos - *blkPos);
+}
+
+/* long long reopenShard()
+ * Reopens an input file at a saved position: a BGZF virtual
+ *   offset (voff >= 0), or else the stream position (pos).
+ *   The limit of the shard (if any) is moved to the new stream.
+ *   Returns the stream position at which the file was opened.
+ */
+long long reopenShard(char* inFile, File* in, int gz, long long voff,
+    long long pos, Shard* sh) {
+  long long base = 0;
+  if (gz && voff >= 0) {
+    openAt(inFile, in, gz, voff >> 16);
+    base = pos - (voff & 0xffff);
+    seekFile(*in, gz, voff & 0xffff, inFile);
+  } else {
+    // plain files and gzip files are reopened from the start
+    openAt(inFile, in, gz, 0);
+    seekFile(*in, gz, pos, inFile);
+  }
+  if (sh != NULL && sh->end >= 0)
+    sh->end -= base;
+  return base;
+}
@@ -0,0 +1,59 @@
+/*
+  October 2026
+
+  Header file for shard.c.
+*/
+
+#define BGZF_HEAD   18     // length of BGZF block header
+#define BGZF_WIN    65536  // window for locating a BGZF block boundary
+#define SHARD_WIN   1048576  // initial window for matching 2nd input file
+#define SHARD_LINE  1024   // maximum length of a line to be examined
+
+// command-line parameters (shared by stitch, removePrimer, qualTrim)
+#define SHARDOPT    "-sh"
+#define SHARDBYTE   "-sb"
+
+// error messages
+#define ERRSHARD    0
+#define MERRSHARD   ": invalid shard (should be <int>/<int>, e.g. 2/8)"
+#define ERRSHBYTE   1
+#define MERRSHBYTE  ": invalid byte range (should be <int>,<int>)"
+#define ERRSHGZ     2
+#define MERRSHGZ    ": cannot shard gzip file that is not BGZF compressed"
+#define ERRSHOPEN   3
+#define MERRSHOPEN  ": cannot open file for reading"
+#define ERRSHREC    4
+#define MERRSHREC   ": cannot find a record boundary"
+#define ERRSHMATE   5
+#define MERRSHMATE  ": cannot find matching read in 2nd input file"
+
+typedef union file {
+  FILE* f;
+  gzFile gzf;
+} File;
+
+typedef struct shard {
+  int idx;         // shard number (1-based; 0 = no sharding)
+  int tot;         // total number of shards
+  long long rSt;   // explicit byte range (rEnd < 0 = not given)
+  long long rEnd;
+  long long st;    // raw file offset at which reading begins
+  long long pos;   // stream position of first record in shard
+  long long end;   // records must begin at stream positions <= end
+                   //   (< 0 = no limit)
+  long long mateSt;  // raw file offset at which 2nd file was opened
+} Shard;
+
+void initShard(Shard* sh);
+void parseShard(char* arg, Shard* sh);
+void parseShardBytes(char* arg, Shard* sh);
+int isShard(Shard* sh);
+void openShard(char* inFile, File* in, int gz, int fastq, Shard* sh);
+void openMate(char* inFile, File* in, int gz, char* mateFile,
+  File mate, Shard* sh);
+int inShard(File in, int gz, Shard* sh);
+int isBgzf(char* inFile);
+long long bgzfVoff(char* inFile, long long* blk, long long* blkPos,
+  long long pos);
+long long reopenShard(char* inFile, File* in, int gz, long long voff,
+  long long pos, Shard* sh);
@@ -0,0 +1,562 @@
+/*
+  October 2026
+
+  Kernels of stitch, removePrimer, and qualTrim, compiled in
+    several variants (scalar, SSE4.2, AVX2, and AVX-512BW),
+    one of which is selected at start-up: the best that the
+    CPU supports (by cpuid), or the one named by AMPSIMD.
+    The variants give identical results.
+  The kernels count, over whole blocks of bytes:
+    - the mismatches of a primer to a read (removePrimer),
+      where a base of the primer matches the same byte or,
+      if ambiguous, any base of its IUPAC code (as given by
+      its mask: A=1, C=2, G=4, T=8; N=15 matches any byte)
+    - the mismatches and Ns of two reads (stitch)
+    - the sum of quality scores (qualTrim)
+  and reverse-complement a sequence (stitch, removePrimer),
+    by a table of the complements of the IUPAC codes indexed
+    by the low 5 bits of a letter (keeping its case).
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "simd.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SIMDX86
+#include <immintrin.h>
+#endif
+
+#define NMASK       15     // mask of N (matches any byte)
+
+// complements of the IUPAC codes, by the low 5 bits of the
+//   letter (0 if not a code): A-T, C-G, R-Y, K-M, B-V, D-H,
+//   S, W, N, and U-A
+#define CMPLO       0, 'T', 'V', 'G', 'H', 0, 0, 'C', 'D', 0, 0, 'M', 0, \
+                    'K', 'N', 0
+#define CMPHI       0, 0, 'Y', 'S', 'A', 'A', 'B', 'W', 0, 'R', 0, 0, 0, \
+                    0, 0, 0
+#define CMPBITS     0x1F   // bits of a letter indexed
+#define CASEBITS    0xE0   // bits of a letter kept (incl. case)
+#define ALPHBITS    0xC0   // bits that are 0x40 for a letter
+#define ALPHA       0x40
+
+/* int simdError()
+ * Prints an error message.
+ */
+static int simdError(char* msg, int err) {
+  char* msg2;
+  if (err == ERRSIMDVAR) msg2 = MERRSIMDVAR;
+  else if (err == ERRSIMDCPU) msg2 = MERRSIMDCPU;
+  else if (err == ERRSIMDMEM) msg2 = MERRSIMDMEM;
+  else msg2 = "Unknown error";
+
+  fprintf(stderr, "Error! %s%s\n", msg, msg2);
+  return -1;
+}
+
+/* char iupac()
+ * Returns the IUPAC mask of a base (0 if not a code).
+ */
+static char iupac(char in) {
+  static const char* code = "-ACMGRSVTWYHKDBN";
+  for (int i = 1; i < 16; i++)
+    if (code[i] == in)
+      return i;
+  return 0;
+}
+
+/* char* iupacMask()
+ * Returns the IUPAC masks of a sequence (heap copy).
+ */
+char* iupacMask(char* seq) {
+  int len = strlen(seq);
+  char* ans = (char*) malloc(len + 1);
+  if (ans == NULL)
+    exit(simdError("", ERRSIMDMEM));
+  for (int i = 0; i < len; i++)
+    ans[i] = iupac(seq[i]);
+  ans[len] = '\0';
+  return ans;
+}
+
+/* int baseMask()
+ * Returns the mask of a base of a read (0 if not A/C/G/T).
+ */
+static inline int baseMask(char in) {
+  return in == 'A' ? 1 : in == 'C' ? 2 : in == 'G' ? 4 :
+    in == 'T' ? 8 : 0;
+}
+
+// scalar kernels (also used for the bytes past the last
+//   whole block of the SSE4.2 and AVX2 kernels)
+
+/* int primMisFrom()
+ * Counts the mismatches of a primer to a sequence, from
+ *   position 'i', to those already counted ('mis'), up to
+ *   'max' + 1.
+ */
+static int primMisFrom(char* prim, char* mask, char* seq, int i,
+    int len, int mis, int max) {
+  for ( ; i < len; i++)
+    if (prim[i] != seq[i] && mask[i] != NMASK &&
+        ! (mask[i] & baseMask(seq[i])) && ++mis > max)
+      break;
+  return mis;
+}
+
+static int primMisScalar(char* prim, char* mask, char* seq, int len,
+    int max) {
+  return primMisFrom(prim, mask, seq, 0, len, 0, max);
+}
+
+/* void seqMisFrom()
+ * Adds the mismatches and Ns of two sequences, from
+ *   position 'i'.
+ */
+static void seqMisFrom(char* seq1, char* seq2, int i, int len,
+    int* mis, int* n) {
+  for ( ; i < len; i++)
+    if (seq1[i] == 'N' || seq2[i] == 'N')
+      (*n)++;
+    else if (seq1[i] != seq2[i])
+      (*mis)++;
+}
+
+static void seqMisScalar(char* seq1, char* seq2, int len, int* mis,
+    int* n) {
+  *mis = *n = 0;
+  seqMisFrom(seq1, seq2, 0, len, mis, n);
+}
+
+/* int qualSumFrom()
+ * Returns the sum of quality scores, from position 'i'.
+ */
+static int qualSumFrom(char* qual, int i, int len) {
+  int sum = 0;
+  for ( ; i < len; i++)
+    sum += qual[i];
+  return sum;
+}
+
+static int qualSumScalar(char* qual, int len) {
+  return qualSumFrom(qual, 0, len);
+}
+
+/* int revCompFrom()
+ * Reverses (and complements) a sequence, from position
+ *   'i'. Returns the number of bytes that are not codes.
+ */
+static int revCompFrom(char* out, char* in, int i, int len, int comp) {
+  static const char cmp[32] = { CMPLO, CMPHI };
+  int bad = 0;
+  for ( ; i < len; i++) {
+    char c = in[i];
+    if (comp) {
+      char x = cmp[c & CMPBITS];
+      if ((c & ALPHBITS) != ALPHA || ! x)
+        bad++;
+      c = (c & CASEBITS) | (x & CMPBITS);
+    }
+    out[len - 1 - i] = c;
+  }
+  return bad;
+}
+
+static int revCompScalar(char* out, char* in, int len, int comp) {
+  return revCompFrom(out, in, 0, len, comp);
+}
+
+Simd simd = { "scalar", primMisScalar, seqMisScalar, qualSumScalar,
+  revCompScalar };
+
+#ifdef SIMDX86
+
+// lookup of the masks of A/C/G/T by low nibble
+//   ('A' = 0x41, 'C' = 0x43, 'T' = 0x54, 'G' = 0x47)
+#define BASECHR     0, 'A', 0, 'C', 'T', 0, 0, 'G', 0, 0, 0, 0, 0, 0, 0, 0
+#define BASEBIT     0, 1, 0, 2, 8, 0, 0, 4, 0, 0, 0, 0, 0, 0, 0, 0
+
+// quality scores are summed as unsigned bytes, then
+//   corrected for those that are negative as chars
+#define SIGNED_CHAR ((char) 0x80 < 0)
+
+// SSE4.2 kernels (16 bytes), by block: each adds to
+//   the counts of the previous blocks
+
+__attribute__((target("sse4.2,popcnt")))
+static inline int primMisSse16(char* prim, char* mask, char* seq) {
+  const __m128i chr = _mm_setr_epi8(BASECHR);
+  const __m128i bit = _mm_setr_epi8(BASEBIT);
+  __m128i p = _mm_loadu_si128((__m128i*) prim);
+  __m128i m = _mm_loadu_si128((__m128i*) mask);
+  __m128i s = _mm_loadu_si128((__m128i*) seq);
+  __m128i idx = _mm_and_si128(s, _mm_set1_epi8(0x0F));
+  __m128i sm = _mm_and_si128(_mm_cmpeq_epi8(s,
+    _mm_shuffle_epi8(chr, idx)), _mm_shuffle_epi8(bit, idx));
+  __m128i ok = _mm_or_si128(_mm_cmpeq_epi8(p, s),
+    _mm_cmpeq_epi8(m, _mm_set1_epi8(NMASK)));
+  __m128i bad = _mm_andnot_si128(ok,
+    _mm_cmpeq_epi8(_mm_and_si128(m, sm), _mm_setzero_si128()));
+  return __builtin_popcount(_mm_movemask_epi8(bad));
+}
+
+__attribute__((target("sse4.2,popcnt")))
+static inline void seqMisSse16(char* seq1, char* seq2, int* mis,
+    int* n) {
+  const __m128i nb = _mm_set1_epi8('N');
+  __m128i a = _mm_loadu_si128((__m128i*) seq1);
+  __m128i b = _mm_loadu_si128((__m128i*) seq2);
+  __m128i isN = _mm_or_si128(_mm_cmpeq_epi8(a, nb),
+    _mm_cmpeq_epi8(b, nb));
+  int ok = _mm_movemask_epi8(_mm_or_si128(isN, _mm_cmpeq_epi8(a, b)));
+  *n += __builtin_popcount(_mm_movemask_epi8(isN));
+  *mis += __builtin_popcount(~ok & 0xFFFF);
+}
+
+__attribute__((target("sse4.2,popcnt")))
+static inline int qualSumSse16(char* qual) {
+  __m128i q = _mm_loadu_si128((__m128i*) qual);
+  __m128i sad = _mm_sad_epu8(q, _mm_setzero_si128());
+  int sum = _mm_cvtsi128_si32(sad) +
+    _mm_cvtsi128_si32(_mm_unpackhi_epi64(sad, sad));
+  return SIGNED_CHAR ? sum - 256 *
+    __builtin_popcount(_mm_movemask_epi8(q)) : sum;
+}
+
+__attribute__((target("sse4.2,popcnt")))
+static int primMisSse(char* prim, char* mask, char* seq, int len,
+    int max) {
+  int mis = 0, i;
+  for (i = 0; i + 16 <= len; i += 16)
+    if ((mis += primMisSse16(prim + i, mask + i, seq + i)) > max)
+      return max + 1;
+  return primMisFrom(prim, mask, seq, i, len, mis, max);
+}
+
+__attribute__((target("sse4.2,popcnt")))
+static void seqMisSse(char* seq1, char* seq2, int len, int* mis,
+    int* n) {
+  int i;
+  *mis = *n = 0;
+  for (i = 0; i + 16 <= len; i += 16)
+    seqMisSse16(seq1 + i, seq2 + i, mis, n);
+  seqMisFrom(seq1, seq2, i, len, mis, n);
+}
+
+__attribute__((target("sse4.2,popcnt")))
+static int qualSumSse(char* qual, int len) {
+  int sum = 0, i;
+  for (i = 0; i + 16 <= len; i += 16)
+    sum += qualSumSse16(qual + i);
+  return sum + qualSumFrom(qual, i, len);
+}
+
+// indexes of the bytes of a block of 16, reversed
+#define REVIDX      15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0
+
+/* int revCompSse16()
+ * Reverses (and complements) a block of 16 bytes into 'out'
+ *   (the end of which is 16 bytes before that of the previous
+ *   block). Returns the number of bytes that are not codes.
+ */
+__attribute__((target("sse4.2,popcnt")))
+static inline int revCompSse16(char* out, char* in, int comp) {
+  __m128i s = _mm_loadu_si128((__m128i*) in);
+  int bad = 0;
+  if (comp) {
+    __m128i idx = _mm_and_si128(s, _mm_set1_epi8(0x0F));
+    __m128i x = _mm_blendv_epi8(_mm_shuffle_epi8(_mm_setr_epi8(CMPLO), idx),
+      _mm_shuffle_epi8(_mm_setr_epi8(CMPHI), idx), _mm_slli_epi16(s, 3));
+    __m128i ok = _mm_andnot_si128(_mm_cmpeq_epi8(x,
+      _mm_setzero_si128()), _mm_cmpeq_epi8(_mm_and_si128(s,
+      _mm_set1_epi8(ALPHBITS)), _mm_set1_epi8(ALPHA)));
+    bad = __builtin_popcount(~_mm_movemask_epi8(ok) & 0xFFFF);
+    s = _mm_or_si128(_mm_and_si128(s, _mm_set1_epi8(CASEBITS)),
+      _mm_and_si128(x, _mm_set1_epi8(CMPBITS)));
+  }
+  _mm_storeu_si128((__m128i*) out,
+    _mm_shuffle_epi8(s, _mm_setr_epi8(REVIDX)));
+  return bad;
+}
+
+__attribute__((target("sse4.2,popcnt")))
+static int revCompSse(char* out, char* in, int len, int comp) {
+  int bad = 0, i;
+  for (i = 0; i + 16 <= len; i += 16)
+    bad += revCompSse16(out + len - 16 - i, in + i, comp);
+  return bad + revCompFrom(out, in, i, len, comp);
+}
+
+// AVX2 kernels (32 bytes; then a block of 16 by SSE4.2)
+
+__attribute__((target("avx2,popcnt")))
+static int primMisAvx2(char* prim, char* mask, char* seq, int len,
+    int max) {
+  const __m256i chr = _mm256_broadcastsi128_si256(_mm_setr_epi8(BASECHR));
+  const __m256i bit = _mm256_broadcastsi128_si256(_mm_setr_epi8(BASEBIT));
+  const __m256i low = _mm256_set1_epi8(0x0F);
+  const __m256i nm = _mm256_set1_epi8(NMASK);
+  const __m256i zero = _mm256_setzero_si256();
+  int mis = 0, i;
+  for (i = 0; i + 32 <= len; i += 32) {
+    __m256i p = _mm256_loadu_si256((__m256i*) (prim + i));
+    __m256i m = _mm256_loadu_si256((__m256i*) (mask + i));
+    __m256i s = _mm256_loadu_si256((__m256i*) (seq + i));
+    __m256i idx = _mm256_and_si256(s, low);
+    __m256i sm = _mm256_and_si256(_mm256_cmpeq_epi8(s,
+      _mm256_shuffle_epi8(chr, idx)), _mm256_shuffle_epi8(bit, idx));
+    __m256i ok = _mm256_or_si256(_mm256_cmpeq_epi8(p, s),
+      _mm256_cmpeq_epi8(m, nm));
+    __m256i bad = _mm256_andnot_si256(ok,
+      _mm256_cmpeq_epi8(_mm256_and_si256(m, sm), zero));
+    mis += __builtin_popcount((unsigned) _mm256_movemask_epi8(bad));
+    if (mis > max)
+      return max + 1;
+  }
+  if (i + 16 <= len) {
+    if ((mis += primMisSse16(prim + i, mask + i, seq + i)) > max)
+      return max + 1;
+    i += 16;
+  }
+  return primMisFrom(prim, mask, seq, i, len, mis, max);
+}
+
+__attribute__((target("avx2,popcnt")))
+static void seqMisAvx2(char* seq1, char* seq2, int len, int* mis,
+    int* n) {
+  const __m256i nb = _mm256_set1_epi8('N');
+  int i;
+  *mis = *n = 0;
+  for (i = 0; i + 32 <= len; i += 32) {
+    __m256i a = _mm256_loadu_si256((__m256i*) (seq1 + i));
+    __m256i b = _mm256_loadu_si256((__m256i*) (seq2 + i));
+    __m256i isN = _mm256_or_si256(_mm256_cmpeq_epi8(a, nb),
+      _mm256_cmpeq_epi8(b, nb));
+    unsigned ok = _mm256_movemask_epi8(_mm256_or_si256(isN,
+      _mm256_cmpeq_epi8(a, b)));
+    *n += __builtin_popcount((unsigned) _mm256_movemask_epi8(isN));
+    *mis += __builtin_popcount(~ok);
+  }
+  if (i + 16 <= len) {
+    seqMisSse16(seq1 + i, seq2 + i, mis, n);
+    i += 16;
+  }
+  seqMisFrom(seq1, seq2, i, len, mis, n);
+}
+
+__attribute__((target("avx2,popcnt")))
+static int qualSumAvx2(char* qual, int len) {
+  const __m256i zero = _mm256_setzero_si256();
+  __m256i acc = zero;
+  int neg = 0, i;
+  for (i = 0; i + 32 <= len; i += 32) {
+    __m256i q = _mm256_loadu_si256((__m256i*) (qual + i));
+    acc = _mm256_add_epi64(acc, _mm256_sad_epu8(q, zero));
+    neg += __builtin_popcount((unsigned) _mm256_movemask_epi8(q));
+  }
+  __m128i s = _mm_add_epi64(_mm256_castsi256_si128(acc),
+    _mm256_extracti128_si256(acc, 1));
+  int sum = _mm_cvtsi128_si32(s) +
+    _mm_cvtsi128_si32(_mm_unpackhi_epi64(s, s));
+  if (SIGNED_CHAR)
+    sum -= 256 * neg;
+  if (i + 16 <= len) {
+    sum += qualSumSse16(qual + i);
+    i += 16;
+  }
+  return sum + qualSumFrom(qual, i, len);
+}
+
+/* int revCompAvx232()
+ * Reverses (and complements) a block of 32 bytes, as
+ *   revCompSse16().
+ */
+__attribute__((target("avx2,popcnt")))
+static inline int revCompAvx232(char* out, char* in, int comp) {
+  const __m256i lo = _mm256_broadcastsi128_si256(_mm_setr_epi8(CMPLO));
+  const __m256i hi = _mm256_broadcastsi128_si256(_mm_setr_epi8(CMPHI));
+  const __m256i rev = _mm256_broadcastsi128_si256(_mm_setr_epi8(REVIDX));
+  __m256i s = _mm256_loadu_si256((__m256i*) in);
+  int bad = 0;
+  if (comp) {
+    __m256i idx = _mm256_and_si256(s, _mm256_set1_epi8(0x0F));
+    __m256i x = _mm256_blendv_epi8(_mm256_shuffle_epi8(lo, idx),
+      _mm256_shuffle_epi8(hi, idx), _mm256_slli_epi16(s, 3));
+    __m256i ok = _mm256_andnot_si256(_mm256_cmpeq_epi8(x,
+      _mm256_setzero_si256()), _mm256_cmpeq_epi8(_mm256_and_si256(s,
+      _mm256_set1_epi8(ALPHBITS)), _mm256_set1_epi8(ALPHA)));
+    bad = __builtin_popcount(~(unsigned) _mm256_movemask_epi8(ok));
+    s = _mm256_or_si256(_mm256_and_si256(s, _mm256_set1_epi8(CASEBITS)),
+      _mm256_and_si256(x, _mm256_set1_epi8(CMPBITS)));
+  }
+  // reverse each lane, then swap the lanes
+  _mm256_storeu_si256((__m256i*) out,
+    _mm256_permute4x64_epi64(_mm256_shuffle_epi8(s, rev), 0x4E));
+  return bad;
+}
+
+__attribute__((target("avx2,popcnt")))
+static int revCompAvx2(char* out, char* in, int len, int comp) {
+  int bad = 0, i;
+  for (i = 0; i + 32 <= len; i += 32)
+    bad += revCompAvx232(out + len - 32 - i, in + i, comp);
+  if (i + 16 <= len) {
+    bad += revCompSse16(out + len - 16 - i, in + i, comp);
+    i += 16;
+  }
+  return bad + revCompFrom(out, in, i, len, comp);
+}
+
+// AVX-512BW kernels (64 bytes; the last block by masked loads)
+
+__attribute__((target("avx512bw,popcnt")))
+static int primMisAvx512(char* prim, char* mask, char* seq, int len,
+    int max) {
+  const __m512i chr = _mm512_broadcast_i32x4(_mm_setr_epi8(BASECHR));
+  const __m512i bit = _mm512_broadcast_i32x4(_mm_setr_epi8(BASEBIT));
+  const __m512i low = _mm512_set1_epi8(0x0F);
+  const __m512i nm = _mm512_set1_epi8(NMASK);
+  int mis = 0;
+  for (int i = 0; i < len; i += 64) {
+    __mmask64 k = (len - i >= 64 ? ~0ULL : (1ULL << (len - i)) - 1);
+    __m512i p = _mm512_maskz_loadu_epi8(k, prim + i);
+    __m512i m = _mm512_maskz_loadu_epi8(k, mask + i);
+    __m512i s = _mm512_maskz_loadu_epi8(k, seq + i);
+    __m512i idx = _mm512_and_si512(s, low);
+    __m512i sm = _mm512_maskz_mov_epi8(_mm512_cmpeq_epi8_mask(s,
+      _mm512_shuffle_epi8(chr, idx)), _mm512_shuffle_epi8(bit, idx));
+    __mmask64 ok = _mm512_cmpeq_epi8_mask(p, s) |
+      _mm512_cmpeq_epi8_mask(m, nm) | _mm512_test_epi8_mask(m, sm);
+    mis += __builtin_popcountll(~ok);
+    if (mis > max)
+      return max + 1;
+  }
+  return mis;
+}
+
+__attribute__((target("avx512bw,popcnt")))
+static void seqMisAvx512(char* seq1, char* seq2, int len, int* mis,
+    int* n) {
+  const __m512i nb = _mm512_set1_epi8('N');
+  *mis = *n = 0;
+  for (int i = 0; i < len; i += 64) {
+    __mmask64 k = (len - i >= 64 ? ~0ULL : (1ULL << (len - i)) - 1);
+    __m512i a = _mm512_maskz_loadu_epi8(k, seq1 + i);
+    __m512i b = _mm512_maskz_loadu_epi8(k, seq2 + i);
+    __mmask64 isN = _mm512_cmpeq_epi8_mask(a, nb) |
+      _mm512_cmpeq_epi8_mask(b, nb);
+    __mmask64 ok = isN | _mm512_cmpeq_epi8_mask(a, b);
+    *n += __builtin_popcountll(isN);
+    *mis += __builtin_popcountll(~ok);
+  }
+}
+
+__attribute__((target("avx512bw,popcnt")))
+static int qualSumAvx512(char* qual, int len) {
+  const __m512i zero = _mm512_setzero_si512();
+  __m512i acc = zero;
+  int neg = 0;
+  for (int i = 0; i < len; i += 64) {
+    __mmask64 k = (len - i >= 64 ? ~0ULL : (1ULL << (len - i)) - 1);
+    __m512i q = _mm512_maskz_loadu_epi8(k, qual + i);
+    acc = _mm512_add_epi64(acc, _mm512_sad_epu8(q, zero));
+    neg += __builtin_popcountll(_mm512_movepi8_mask(q));
+  }
+  int sum = (int) _mm512_reduce_add_epi64(acc);
+  return SIGNED_CHAR ? sum - 256 * neg : sum;
+}
+
+__attribute__((target("avx512bw,popcnt")))
+static int revCompAvx512(char* out, char* in, int len, int comp) {
+  const __m512i lo = _mm512_broadcast_i32x4(_mm_setr_epi8(CMPLO));
+  const __m512i hi = _mm512_broadcast_i32x4(_mm_setr_epi8(CMPHI));
+  const __m512i rev = _mm512_broadcast_i32x4(_mm_setr_epi8(REVIDX));
+  int bad = 0, i;
+  for (i = 0; i + 64 <= len; i += 64) {
+    __m512i s = _mm512_loadu_si512((__m512i*) (in + i));
+    if (comp) {
+      __m512i idx = _mm512_and_si512(s, _mm512_set1_epi8(0x0F));
+      __m512i x = _mm512_mask_blend_epi8(_mm512_test_epi8_mask(s,
+        _mm512_set1_epi8(0x10)), _mm512_shuffle_epi8(lo, idx),
+        _mm512_shuffle_epi8(hi, idx));
+      __mmask64 ok = _mm512_test_epi8_mask(x, x) &
+        _mm512_cmpeq_epi8_mask(_mm512_and_si512(s,
+        _mm512_set1_epi8(ALPHBITS)), _mm512_set1_epi8(ALPHA));
+      bad += __builtin_popcountll(~ok);
+      s = _mm512_ternarylogic_epi32(s, x, _mm512_set1_epi8(CASEBITS),
+        0xE4);
+    }
+    // reverse each lane, then the order of the lanes
+    s = _mm512_shuffle_epi8(s, rev);
+    _mm512_storeu_si512((__m512i*) (out + len - 64 - i),
+      _mm512_shuffle_i64x2(s, s, 0x1B));
+  }
+  if (i + 32 <= len) {
+    bad += revCompAvx232(out + len - 32 - i, in + i, comp);
+    i += 32;
+  }
+  if (i + 16 <= len) {
+    bad += revCompSse16(out + len - 16 - i, in + i, comp);
+    i += 16;
+  }
+  return bad + revCompFrom(out, in, i, len, comp);
+}
+
+#endif
+
+/* int simdSupported()
+ * Returns 1 if the CPU supports a variant.
+ */
+static int simdSupported(int v) {
+#ifdef SIMDX86
+  __builtin_cpu_init();
+  if (v == SIMDSSE42)
+    return __builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt");
+  if (v == SIMDAVX2)
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+  if (v == SIMDAVX512)
+    return __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("popcnt");
+#endif
+  return v == SIMDSCALAR;
+}
+
+/* void initSimd()
+ * Selects the variant of the kernels: the one named by
+ *   AMPSIMD, else the best supported.
+ */
+void initSimd(void) {
+  static char* names[] = SIMDNAMES;
+  char* env = getenv(SIMDENV);
+  int v;
+  if (env != NULL && env[0] != '\0') {
+    for (v = 0; v < SIMDVARS && strcmp(env, names[v]); v++) ;
+    if (v == SIMDVARS)
+      exit(simdError(env, ERRSIMDVAR));
+    if (! simdSupported(v))
+      exit(simdError(env, ERRSIMDCPU));
+  } else
+    for (v = SIMDVARS - 1; ! simdSupported(v); v--) ;
+
+  simd.name = names[v];
+#ifdef SIMDX86
+  if (v == SIMDSSE42) {
+    simd.primMis = primMisSse;
+    simd.seqMis = seqMisSse;
+    simd.qualSum = qualSumSse;
+    simd.revComp = revCompSse;
+  } else if (v == SIMDAVX2) {
+    simd.primMis = primMisAvx2;
+    simd.seqMis = seqMisAvx2;
+    simd.qualSum = qualSumAvx2;
+    simd.revComp = revCompAvx2;
+  } else if (v == SIMDAVX512) {
+    simd.primMis = primMisAvx512;
+    simd.seqMis = seqMisAvx512;
+    simd.qualSum = qualSumAvx512;
+    simd.revComp = revCompAvx512;
+  }
+#endif
+}
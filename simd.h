@@ -0,0 +1,43 @@
+/*
+  October 2026
+
+  Header file for simd.c.
+*/
+
+#define SIMDENV     "AMPSIMD"  // environment variable to force a variant
+
+// variants, in order of preference
+#define SIMDSCALAR  0
+#define SIMDSSE42   1
+#define SIMDAVX2    2
+#define SIMDAVX512  3
+#define SIMDVARS    4
+#define SIMDNAMES   { "scalar", "sse4.2", "avx2", "avx512bw" }
+
+// error messages
+#define ERRSIMDVAR  0
+#define MERRSIMDVAR ": unknown variant of SIMD kernels (" SIMDENV ")"
+#define ERRSIMDCPU  1
+#define MERRSIMDCPU ": variant of SIMD kernels not supported by this CPU"
+#define ERRSIMDMEM  2
+#define MERRSIMDMEM "cannot allocate memory"
+
+typedef struct simd {
+  char* name;        // variant selected
+  // mismatches of a primer (with its IUPAC mask) to a sequence,
+  //   up to 'max' + 1
+  int (*primMis)(char* prim, char* mask, char* seq, int len, int max);
+  // mismatches and Ns of two sequences
+  void (*seqMis)(char* seq1, char* seq2, int len, int* mis, int* n);
+  // sum of quality scores (as chars)
+  int (*qualSum)(char* qual, int len);
+  // reverse (and complement, if 'comp') of a sequence into 'out'
+  //   (not NUL-terminated); returns the number of bytes that are
+  //   not IUPAC codes (upper or lower case)
+  int (*revComp)(char* out, char* in, int len, int comp);
+} Simd;
+
+extern Simd simd;
+
+void initSimd(void);
+char* iupacMask(char* seq);
@@ -5,7 +5,8 @@
 
 # Simulate amplicon reads.
 # External software requirements:
-#   - ipcress (from exonerate 2.4.0) -- assumed to be in $PATH
+#   - ipcress (from exonerate 2.4.0) -- assumed to be in $PATH,
+#       only if selected below (in place of inSilicoPCR)
 
 # check command-line arguments
 if [ $# -lt 3 ]; then
@@ -43,11 +44,21 @@ min=70       # minimum amplicon length
 max=180      # maximum amplicon length
 perl ${HOME_DIR}/formatPrimers.pl $prim $ipc $min $max
 
-# run ipcress
-echo "Running ipcress"
+# find primer products (in-silico PCR)
 mis=7  # maximum number of allowed mismatches
 tr1=temp.ipcout
-ipcress -i $ipc -s $gen -m $mis -p 0 > $tr1
+ipcress=0   # 1 to use ipcress instead of inSilicoPCR
+if [ $ipcress -eq 1 ]; then
+  echo "Running ipcress"
+  ipcress -i $ipc -s $gen -m $mis -p 0 > $tr1
+else
+  echo "Running inSilicoPCR"
+  seed=3     # mismatches in the 3'-terminal 12 bases (no more can
+             #   meet the min. primer matching score of 0.85 below)
+  proc=$(nproc 2> /dev/null || echo 1)
+  ${HOME_DIR}/../inSilicoPCR -i $ipc -g $gen -o $tr1 -m $mis \
+    -e $seed -t $proc
+fi
 
 # filter ipcress output
 echo "Filtering ipcress output"
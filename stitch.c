@@ -9,8 +9,21 @@
 #include <stdlib.h>
 #include <string.h>
 #include <zlib.h>
+#include "shard.h"
+#include "checkpoint.h"
+#include "metrics.h"
+#include "profile.h"
+#include "simd.h"
 #include "stitch.h"
 
+#ifdef PROFILE
+ProfStat prof[] = { {"read", NULL, NULL},
+  {"findPos", "offsets", "exact"},
+  {"compare", "bases", "early exits"},
+  {"output", NULL, NULL} };
+int profLen = 4;
+#endif
+
 /* void usage()
  * Prints usage information.
  */
@@ -42,6 +55,27 @@ void usage(void) {
   fprintf(stderr, "                     multiple overlapping possibilities (by default,\n");
   fprintf(stderr, "                     the longest stitched read is produced)\n");
   fprintf(stderr, "  %s              Option to print counts of stitching results to stdout\n", VERBOSE);
+  fprintf(stderr, "  %s              Option to add the ordinal of each read pair in the input\n", ORDOPT);
+  fprintf(stderr, "                     files to the header of its stitched read (\"%s<int>\";\n", ORDTAG);
+  fprintf(stderr, "                     see removePrimer -wo)\n");
+  fprintf(stderr, "  %s  <file>       Instead of stitching, copy the read pairs whose ordinals\n", EXTFILE);
+  fprintf(stderr, "                     are listed in the given file (in increasing order) to\n");
+  fprintf(stderr, "                     %s and %s, in one pass of the input files (%s not needed)\n", UNFILE1, UNFILE2, OUTFILE);
+  fprintf(stderr, "  %s <int/int>    Process only the given shard of the input, e.g. 2/8 for\n", SHARDOPT);
+  fprintf(stderr, "                     the 2nd of 8 equal byte ranges of the first input file\n");
+  fprintf(stderr, "                     (input files must be plain or BGZF compressed; the\n");
+  fprintf(stderr, "                     outputs of all shards can be merged with mergeShards.pl)\n");
+  fprintf(stderr, "  %s <int,int>    Process only reads beginning in the given byte range\n", SHARDBYTE);
+  fprintf(stderr, "                     of the first input file (alternative to %s)\n", SHARDOPT);
+  fprintf(stderr, "  %s <file>       Checkpoint file, written periodically during the run\n", CKPTFILE);
+  fprintf(stderr, "                     (removed when the run completes)\n");
+  fprintf(stderr, "  %s <int>        Reads between checkpoints (def. %d)\n", CKPTINT, DEFCKPT);
+  fprintf(stderr, "  %s              Option to resume from the checkpoint file (%s), with\n", RESUME, CKPTFILE);
+  fprintf(stderr, "                     the same parameters as the interrupted run\n");
+  fprintf(stderr, "  %s <int>        Seconds between progress reports (reads/sec, bytes/sec,\n", METINT);
+  fprintf(stderr, "                     and counts) printed to stderr (def. %d, if %s given)\n", DEFMETINT, METFILE);
+  fprintf(stderr, "  %s <file>       Prometheus textfile to which progress metrics are\n", METFILE);
+  fprintf(stderr, "                     written with each report\n");
   exit(-1);
 }
 
@@ -63,6 +97,8 @@ int error(char* msg, int err) {
   else if (err == ERRPARAM) msg2 = MERRPARAM;
   else if (err == ERROVER) msg2 = MERROVER;
   else if (err == ERRMISM) msg2 = MERRMISM;
+  else if (err == ERRORDSH) msg2 = MERRORDSH;
+  else if (err == ERRORD) msg2 = MERRORD;
   else msg2 = DEFERR;
 
   fprintf(stderr, "Error! %s%s\n", msg, msg2);
@@ -101,20 +137,6 @@ int getInt(char* in) {
   return ans;
 }
 
-/* char rc(char)
- * Returns the complement of the given base.
- */
-char rc(char in) {
-  char out;
-  if (in == 'A') out = 'T';
-  else if (in == 'T') out = 'A';
-  else if (in == 'C') out = 'G';
-  else if (in == 'G') out = 'C';
-  else if (in == 'N') out = 'N';
-  else exit(error("", ERRUNK));
-  return out;
-}
-
 /* char* getLine()
  * Reads the next line from a file.
  */
@@ -128,19 +150,16 @@ char* getLine(char* line, int size, File in, int gz) {
 /* void copyStr()
  * Copy a sequence/quality score.
  * Reverse (REV) or rev-comp (RC) if needed (3rd param).
+ *   Returns the length.
  */
-void copyStr(char* out, char* in, int rev) {
-  int i = 0;
+int copyStr(char* out, char* in, int rev) {
+  int len = strcspn(in, "\n");
   if (rev == FWD)
-    for (; in[i] != '\n' && in[i] != '\0'; i++)
-      out[i] = in[i];
-  else {
-    int j = 0;
-    for (; in[j] != '\n' && in[j] != '\0'; j++) ;
-    for (j--; j > -1; j--)
-      out[i++] = (rev == REV ? in[j] : rc(in[j]));
-  }
-  out[i] = '\0';
+    memcpy(out, in, len);
+  else if (simd.revComp(out, in, len, rev == RC))
+    exit(error("", ERRUNK));
+  out[len] = '\0';
+  return len;
 }
 
 /* int getSeq()
@@ -148,36 +167,43 @@ void copyStr(char* out, char* in, int rev) {
  */
 int getSeq(File in, char* line, char* seq, char* qual,
     int nSeq, int nQual, int gz) {
+  int len = 0;
   for (int i = 0; i < 3; i++) {
     if (getLine(line, MAX_SIZE, in, gz) == NULL)
       exit(error("", ERRSEQ));
     if (i == 0)
-      copyStr(seq, line, nSeq);
-    else if (i == 2)
-      copyStr(qual, line, nQual);
+      len = copyStr(seq, line, nSeq);
+    else if (i == 2 && copyStr(qual, line, nQual) != len)
+      exit(error("", ERRQUAL));
   }
-  int len = strlen(seq);
-  if (len != strlen(qual))
-    exit(error("", ERRQUAL));
   return len;
 }
 
 /* float compare()
  * Compare two sequences. Return the percent mismatch.
+ *   The limits are checked after each block of bases:
+ *   since mismatches only increase (and the length only
+ *   decreases), the result is that of checking each base.
  */
 float compare(char* seq1, char* seq2, int length,
     float mismatch, int overlap) {
   int mis = 0;       // number of mismatches
+  int n = 0;         // number of Ns
   int len = length;  // length of overlap, not counting Ns
-  float allow = len * mismatch;
-  for (int i = 0; i < length; i++) {
+  PROF_CALL(PR_COMPARE);
+  for (int i = 0; i < length; i += CMPBLOCK) {
+    int blk = (length - i < CMPBLOCK ? length - i : CMPBLOCK);
+    int bMis, bN;
+    PROF_ITER(PR_COMPARE, blk);
     // do not count Ns
-    if (seq1[i] == 'N' || seq2[i] == 'N') {
-      if (--len < overlap || mis > len * mismatch)
-        return NOTMATCH;
-      allow = len * mismatch;
-    } else if (seq1[i] != seq2[i] && ++mis > allow)
+    simd.seqMis(seq1 + i, seq2 + i, blk, &bMis, &bN);
+    mis += bMis;
+    n += bN;
+    len = length - n;
+    if ((n && len < overlap) || mis > len * mismatch) {
+      PROF_EXIT(PR_COMPARE);
       return NOTMATCH;
+    }
   }
   return (float) mis / len;
 }
@@ -190,30 +216,37 @@ int findPos (char* seq1, char* seq2, char* qual1,
     int dovetail, float mismatch, int maxLen,
     float* best) {
   int pos = len1 - overlap + 1;  // position of match
+  PROF_CALL(PR_FINDPOS);
   for (int i = len1 - overlap; i > -1; i--) {
     if (len1 - i > len2 && !dovetail)
       break;
+    PROF_ITER(PR_FINDPOS, 1);
     float res = compare(seq1 + i, seq2,
       len1-i < len2 ? len1-i : len2, mismatch, overlap);
     if (res < *best || (res == *best && !maxLen)) {
       *best = res;
       pos = i;
     }
-    if (res == 0.0f && maxLen)
+    if (res == 0.0f && maxLen) {
+      PROF_EXIT(PR_FINDPOS);
       return pos;  // shortcut for exact match
+    }
   }
 
   // check for dovetailing
   if (dovetail) {
     for (int i = 1; i < len2 - overlap + 1; i++) {
+      PROF_ITER(PR_FINDPOS, 1);
       float res = compare(seq1, seq2 + i,
         len2-i < len1 ? len2-i : len1, mismatch, overlap);
       if (res < *best || (res == *best && !maxLen)) {
         *best = res;
         pos = -i;
       }
-      if (res == 0.0f && maxLen)
+      if (res == 0.0f && maxLen) {
+        PROF_EXIT(PR_FINDPOS);
         return pos;  // shortcut for exact match
+      }
     }
   }
 
@@ -244,12 +277,13 @@ void createSeq(char* seq1, char* seq2, char* qual1, char* qual2,
 }
 
 /* void printRes()
- * Print stitched read.
+ * Print stitched read (with its ordinal, if given).
+ *   'buf' holds the rev-comp of a dovetailed overhang.
  */
 void printRes(File out, File log, int logOpt, File dove,
-    int doveOpt, char* header, char* seq1, char* seq2,
+    int doveOpt, char* header, int ord, char* seq1, char* seq2,
     char* qual1, char* qual2, int len1, int len2,
-    int pos, float best, int gz) {
+    int pos, float best, char* buf, int gz) {
   // log result
   if (logOpt) {
     fprintf(log.f, "%s\t%d\t%d\t", header,
@@ -263,41 +297,45 @@ void printRes(File out, File log, int logOpt, File dove,
   if (doveOpt && (len1 > len2 + pos || pos < 0)) {
     fprintf(dove.f, "%s\t%s\t", header, len1 > len2 + pos ?
       seq1 + len2 + pos : "-");
-    if (pos < 0)
-      for (int i = -1; i - pos > -1; i--)
-        fprintf(dove.f, "%c", rc(seq2[i - pos]));
-    else
+    if (pos < 0) {
+      simd.revComp(buf, seq2, -pos, 1);
+      fwrite(buf, 1, -pos, dove.f);
+    } else
       fprintf(dove.f, "-");
     fprintf(dove.f, "\n");
   }
 
   // print stitched sequence
   createSeq(seq1, seq2, qual1, qual2, len1, len2, pos);
-  gz ? gzprintf(out.gzf, "@%s\n%s\n+\n%s\n", header, seq1, qual1)
-    : fprintf(out.f, "@%s\n%s\n+\n%s\n", header, seq1, qual1);
+  if (ord)
+    gz ? gzprintf(out.gzf, "@%s %s%d\n%s\n+\n%s\n", header, ORDTAG, ord,
+        seq1, qual1)
+      : fprintf(out.f, "@%s %s%d\n%s\n+\n%s\n", header, ORDTAG, ord,
+        seq1, qual1);
+  else
+    gz ? gzprintf(out.gzf, "@%s\n%s\n+\n%s\n", header, seq1, qual1)
+      : fprintf(out.f, "@%s\n%s\n+\n%s\n", header, seq1, qual1);
 }
 
 /* void printFail()
  * Print stitch failure reads.
+ *   'buf' holds the rev sequence, put back.
  */
 void printFail(File un1, File un2, int unOpt,
     File log, int logOpt, char* header, char* head1,
     char* head2, char* seq1, char* seq2, char* qual1,
-    char* qual2, int len, int gz) {
+    char* qual2, char* buf, int gz) {
   if (logOpt)
     fprintf(log.f, "%s\tn/a\n", header);
   if (unOpt) {
     gz ? gzprintf(un1.gzf, "@%s\n%s\n+\n%s\n", head1, seq1, qual1)
       : fprintf(un1.f, "@%s\n%s\n+\n%s\n", head1, seq1, qual1);
     // put rev sequence back
-    gz ? gzprintf(un2.gzf, "@%s\n", head2)
-      : fprintf(un2.f, "@%s\n", head2);
-    for (int i = len - 1; i > -1; i--)
-      gz ? gzputc(un2.gzf, rc(seq2[i])) : putc(rc(seq2[i]), un2.f);
-    gz ? gzprintf(un2.gzf, "\n+\n") : fprintf(un2.f, "\n+\n");
-    for (int i = len - 1; i > -1; i--)
-      gz ? gzputc(un2.gzf, qual2[i]) : putc(qual2[i], un2.f);
-    gz ? gzputc(un2.gzf, '\n') : putc('\n', un2.f);
+    copyStr(buf, seq2, RC);
+    gz ? gzprintf(un2.gzf, "@%s\n%s\n+\n", head2, buf)
+      : fprintf(un2.f, "@%s\n%s\n+\n", head2, buf);
+    copyStr(buf, qual2, REV);
+    gz ? gzprintf(un2.gzf, "%s\n", buf) : fprintf(un2.f, "%s\n", buf);
   }
 }
 
@@ -307,8 +345,8 @@ void printFail(File un1, File un2, int unOpt,
 int readFile(File in1, File in2, File out,
     File un1, File un2, int unOpt, File log,
     int logOpt, int overlap, int dovetail, File dove,
-    int doveOpt, float mismatch, int maxLen, int* stitch,
-    int* fail, int gz) {
+    int doveOpt, float mismatch, int maxLen, int ordOpt, int* stitch,
+    int* fail, int gz, Shard* sh, Ckpt* ck, Metrics* m) {
 
   char* line = (char*) memalloc(MAX_SIZE);
   char* head1 = (char*) memalloc(MAX_SIZE);
@@ -319,9 +357,21 @@ int readFile(File in1, File in2, File out,
   char* qual2 = (char*) memalloc(MAX_SIZE);
   char* header = (char*) memalloc(MAX_SIZE); // consensus header
 
-  int count = 0;
-  while (getLine(line, MAX_SIZE, in1, gz) != NULL) {
+  int count = 0, dovetailed = 0;
+  ckptCount(ck, &count);
+  ckptCount(ck, stitch);
+  ckptCount(ck, fail);
+  ckptCount(ck, &dovetailed);
+  ckptRestore(ck);
+  metricsCount(m, "stitched", stitch);
+  metricsCount(m, "failed", fail);
+  metricsCount(m, "dovetailed", &dovetailed);
+  startMetrics(m, count);
+  PROF_START(t);
+  while (inShard(in1, gz, sh) &&
+      getLine(line, MAX_SIZE, in1, gz) != NULL) {
     count++;
+    PROF_CALL(PR_READ);
 
     // save headers
     int i;
@@ -355,21 +405,35 @@ int readFile(File in1, File in2, File out,
     // save sequences and quality scores for the reads
     int len1 = getSeq(in1, line, seq1, qual1, FWD, FWD, gz);
     int len2 = getSeq(in2, line, seq2, qual2, RC, REV, gz);
+    PROF_LAP(PR_READ, t);
 
     // stitch reads, print result
     float best = 1.0f;
     int pos = findPos(seq1, seq2, qual1, qual2, len1, len2,
       overlap, dovetail, mismatch, maxLen, &best);
+    PROF_LAP(PR_FINDPOS, t);
+    PROF_CALL(PR_OUTPUT);
     if (pos == len1 - overlap + 1) {
       printFail(un1, un2, unOpt, log, logOpt, header, head1,
-        head2, seq1, seq2, qual1, qual2, len2, gz);
+        head2, seq1, seq2, qual1, qual2, line, gz);
       (*fail)++;
     } else {
-      printRes(out, log, logOpt, dove, doveOpt, header, seq1,
-        seq2, qual1, qual2, len1, len2, pos, best, gz);
+      printRes(out, log, logOpt, dove, doveOpt, header,
+        ordOpt ? count : 0, seq1, seq2, qual1, qual2, len1, len2,
+        pos, best, line, gz);
       (*stitch)++;
+      if (len1 > len2 + pos || pos < 0)
+        dovetailed++;
     }
+
+    if (ck->file != NULL && count >= ck->next)
+      saveCkpt(ck);
+    if (m->on && --m->check <= 0)
+      updateMetrics(m, count, 0);
+    PROF_LAP(PR_OUTPUT, t);
   }
+  if (m->on)
+    updateMetrics(m, count, 1);
 
   // free memory
   free(line);
@@ -383,6 +447,46 @@ int readFile(File in1, File in2, File out,
   return count;
 }
 
+/* int extractReads()
+ * Copies the read pairs whose ordinals (1-based, as added
+ *   by ORDOPT) are listed in the given file to the outputs.
+ *   The ordinals must be increasing, so the inputs are read
+ *   once, and only up to the last pair listed.
+ */
+int extractReads(File in1, File in2, gzFile ord, File un1,
+    File un2, int* count, int gz) {
+  char* line = (char*) memalloc(MAX_SIZE);
+  char* oline = (char*) memalloc(MAX_SIZE);
+  int copied = 0;
+  while (gzgets(ord, oline, MAX_SIZE) != NULL) {
+    if (oline[0] == '\n' || oline[0] == '\r')
+      continue;
+    char* end;
+    int n = (int) strtol(oline, &end, 10);
+    if (end == oline || n <= *count)
+      exit(error("", ERRORD));
+
+    // skip to pair n, then copy it
+    while (*count < n) {
+      (*count)++;
+      for (int i = 0; i < 4; i++) {
+        if (getLine(line, MAX_SIZE, in1, gz) == NULL)
+          exit(error("", ERRSEQ));
+        if (*count == n)
+          gz ? gzputs(un1.gzf, line) : fputs(line, un1.f);
+        if (getLine(line, MAX_SIZE, in2, gz) == NULL)
+          exit(error("", ERRSEQ));
+        if (*count == n)
+          gz ? gzputs(un2.gzf, line) : fputs(line, un2.f);
+      }
+    }
+    copied++;
+  }
+  free(line);
+  free(oline);
+  return copied;
+}
+
 /* void openWrite()
  * Open a file for writing.
  */
@@ -423,6 +527,35 @@ void openRead(char* inFile, File* in, int gz) {
   }
 }
 
+/* void extractFiles()
+ * Opens the files for, and runs, extractReads().
+ */
+void extractFiles(char* extFile, char* inFile1, char* inFile2,
+    char* unFile1, char* unFile2, int gz, int verbose) {
+  File in1, in2, un1, un2;
+  gzFile ord = gzopen(extFile, "r");
+  if (ord == NULL)
+    exit(error(extFile, ERROPEN));
+  openRead(inFile1, &in1, gz);
+  openRead(inFile2, &in2, gz);
+  openWrite(unFile1, &un1, gz);
+  openWrite(unFile2, &un2, gz);
+
+  int count = 0;
+  int copied = extractReads(in1, in2, ord, un1, un2, &count, gz);
+  if (verbose) {
+    printf("Reads analyzed: %d\n", count);
+    printf("  Extracted: %d\n", copied);
+  }
+
+  if (gzclose(ord) != Z_OK ||
+      ( gz && ( gzclose(in1.gzf) != Z_OK || gzclose(in2.gzf) != Z_OK
+      || gzclose(un1.gzf) != Z_OK || gzclose(un2.gzf) != Z_OK ) ) ||
+      ( ! gz && ( fclose(in1.f) || fclose(in2.f) || fclose(un1.f)
+      || fclose(un2.f) ) ) )
+    exit(error("", ERRCLOSE));
+}
+
 /* void openFiles()
  * Opens the files to run the program.
  */
@@ -431,22 +564,36 @@ void openFiles(char* outFile, File* out,
     File* in2, char* unFile1, File* un1,
     char* unFile2, File* un2, char* logFile,
     File* log, char* doveFile, File* dove,
-    int dovetail, int gz) {
+    int dovetail, int gz, Shard* sh, Ckpt* ck, Metrics* m) {
   // open required files
-  openRead(inFile1, in1, gz);
-  openRead(inFile2, in2, gz);
-  openWrite(outFile, out, gz);
+  if (isShard(sh)) {
+    openShard(inFile1, in1, gz, 1, sh);
+    openMate(inFile2, in2, gz, inFile1, *in1, sh);
+  } else {
+    openRead(inFile1, in1, gz);
+    openRead(inFile2, in2, gz);
+  }
+  // (reopened at checkpoint positions if resuming)
+  ckptRead(ck, inFile1, in1, gz, sh->st, sh);
+  ckptRead(ck, inFile2, in2, gz, sh->mateSt, NULL);
+  if (! ckptWrite(ck, outFile, out, gz))
+    openWrite(outFile, out, gz);
+  metricsIn(m, in1, gz);
+  metricsIn(m, in2, gz);
+  metricsOut(m, out, gz);
 
   // open optional files
   if (unFile1 != NULL && unFile2 != NULL) {
-    openWrite(unFile1, un1, gz);
-    openWrite(unFile2, un2, gz);
+    if (! ckptWrite(ck, unFile1, un1, gz))
+      openWrite(unFile1, un1, gz);
+    if (! ckptWrite(ck, unFile2, un2, gz))
+      openWrite(unFile2, un2, gz);
   }
-  if (logFile != NULL) {
+  if (logFile != NULL && ! ckptWrite(ck, logFile, log, 0)) {
     openWrite(logFile, log, 0);
     fprintf(log->f, "Read\tOverlapLen\tStitchedLen\tMismatch\n");
   }
-  if (dovetail && doveFile != NULL) {
+  if (dovetail && doveFile != NULL && ! ckptWrite(ck, doveFile, dove, 0)) {
     openWrite(doveFile, dove, 0);
     fprintf(dove->f, "Read\tDovetailFwd\tDovetailRev\n");
   }
@@ -459,10 +606,16 @@ void getParams(int argc, char** argv) {
 
   char* outFile = NULL, *inFile1 = NULL, *inFile2 = NULL,
     *unFile1 = NULL, *unFile2 = NULL, *logFile = NULL,
-    *doveFile = NULL;
-  int overlap = DEFOVER, dovetail = 0, maxLen = 1;
+    *doveFile = NULL, *extFile = NULL;
+  int overlap = DEFOVER, dovetail = 0, maxLen = 1, ordOpt = 0;
   int verbose = 0;
   float mismatch = DEFMISM;
+  Shard sh;
+  initShard(&sh);
+  Ckpt ck;
+  initCkpt(&ck);
+  Metrics m;
+  initMetrics(&m, "stitch");
 
   // parse argv
   for (int i = 1; i < argc; i++) {
@@ -474,6 +627,10 @@ void getParams(int argc, char** argv) {
       dovetail = 1;
     else if (!strcmp(argv[i], VERBOSE))
       verbose = 1;
+    else if (!strcmp(argv[i], ORDOPT))
+      ordOpt = 1;
+    else if (!strcmp(argv[i], RESUME))
+      ck.resume = 1;
     else if (i < argc - 1) {
       if (!strcmp(argv[i], OUTFILE))
         outFile = argv[++i];
@@ -489,23 +646,41 @@ void getParams(int argc, char** argv) {
         logFile = argv[++i];
       else if (!strcmp(argv[i], DOVEFILE))
         doveFile = argv[++i];
+      else if (!strcmp(argv[i], EXTFILE))
+        extFile = argv[++i];
       else if (!strcmp(argv[i], OVERLAP))
         overlap = getInt(argv[++i]);
       else if (!strcmp(argv[i], MISMATCH))
         mismatch = getFloat(argv[++i]);
-      else
+      else if (!strcmp(argv[i], SHARDOPT))
+        parseShard(argv[++i], &sh);
+      else if (!strcmp(argv[i], SHARDBYTE))
+        parseShardBytes(argv[++i], &sh);
+      else if (!strcmp(argv[i], CKPTFILE))
+        ck.file = argv[++i];
+      else if (!strcmp(argv[i], CKPTINT))
+        setCkptInt(&ck, argv[++i]);
+      else if (!strcmp(argv[i], METINT))
+        setMetInt(&m, argv[++i]);
+      else if (!strcmp(argv[i], METFILE)) {
+        m.file = argv[++i];
+        m.on = 1;
+      } else
         exit(error(argv[i], ERRPARAM));
     } else
       usage();
   }
 
   // check for parameter errors
-  if (outFile == NULL || inFile1 == NULL || inFile2 == NULL)
+  if (inFile1 == NULL || inFile2 == NULL || (outFile == NULL &&
+      (extFile == NULL || unFile1 == NULL || unFile2 == NULL)))
     usage();
   if (overlap <= 0)
     exit(error("", ERROVER));
   if (mismatch < 0.0f || mismatch >= 1.0f)
     exit(error("", ERRMISM));
+  if (ordOpt && isShard(&sh))
+    exit(error("", ERRORDSH));
 
   // determine if inputs are gzip compressed
   int gz = 0;
@@ -513,18 +688,29 @@ void getParams(int argc, char** argv) {
       !strcmp(inFile2 + strlen(inFile2) - strlen(GZEXT), GZEXT) )
     gz = 1;
 
+  // extract reads by ordinal (no stitching)
+  if (extFile != NULL) {
+    if (unFile1 == NULL || unFile2 == NULL)
+      usage();
+    extractFiles(extFile, inFile1, inFile2, unFile1, unFile2, gz,
+      verbose);
+    return;
+  }
+
   // open files
+  PROF_INIT();
+  loadCkpt(&ck);
   File out, in1, in2, un1, un2, log, dove;
   openFiles(outFile, &out, inFile1, &in1, inFile2, &in2,
     unFile1, &un1, unFile2, &un2, logFile, &log,
-    doveFile, &dove, dovetail, gz);
+    doveFile, &dove, dovetail, gz, &sh, &ck, &m);
 
   // read file
   int stitch = 0, fail = 0;  // counting variables
   int count = readFile(in1, in2, out, un1, un2,
     unFile1 != NULL && unFile2 != NULL, log, logFile != NULL,
     overlap, dovetail, dove, dovetail && doveFile != NULL,
-    mismatch, maxLen, &stitch, &fail, gz);
+    mismatch, maxLen, ordOpt, &stitch, &fail, gz, &sh, &ck, &m);
 
   if (verbose) {
     printf("Reads analyzed: %d\n", count);
@@ -543,12 +729,15 @@ void getParams(int argc, char** argv) {
       (logFile != NULL && fclose(log.f)) ||
       (dovetail && doveFile != NULL && fclose(dove.f)) )
     exit(error("", ERRCLOSE));
+  endCkpt(&ck);
+  PROF_REPORT("stitch");
 }
 
 /* int main()
  * Main.
  */
 int main(int argc, char* argv[]) {
+  initSimd();
   getParams(argc, argv);
   return 0;
 }
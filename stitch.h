@@ -7,6 +7,7 @@
 
 #define MAX_SIZE    1024   // maximum length for input line
 #define NOTMATCH    1.5f   // stitch failure
+#define CMPBLOCK    64     // bases compared between checks of the limits
 #define GZEXT       ".gz"  // file extension for gzip compression
 
 // command-line parameters
@@ -23,6 +24,10 @@
 #define DOVEFILE    "-dl"
 #define MAXOPT      "-n"
 #define VERBOSE     "-ve"
+#define ORDOPT      "-or"   // option to add read ordinals to headers
+#define EXTFILE     "-x"    // extract reads listed by ordinal
+
+#define ORDTAG      "OR:i:" // read ordinal (e.g. "OR:i:1234")
 
 // default parameter values
 #define DEFOVER     20
@@ -33,6 +38,12 @@
 #define RC          1
 #define REV         2
 
+// kernels/stages profiled with "make PROFILE=1"
+#define PR_READ     0
+#define PR_FINDPOS  1
+#define PR_COMPARE  2
+#define PR_OUTPUT   3
+
 // error messages
 #define ERROPEN     0
 #define MERROPEN    ": cannot open file for reading"
@@ -60,9 +71,8 @@
 #define MERROVER    "Overlap must be greater than 0"
 #define ERRMISM     12
 #define MERRMISM    "Mismatch must be in [0,1)"
+#define ERRORDSH    13
+#define MERRORDSH   "Cannot add ordinals to reads of a shard"
+#define ERRORD      14
+#define MERRORD     "Ordinals must be positive and increasing"
 #define DEFERR      "Unknown error"
-
-typedef union file {
-  FILE* f;
-  gzFile gzf;
-} File;